@@ -0,0 +1,89 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <geometric_shapes/shapes.h>
+#include <random_numbers/random_numbers.h>
+#include <cmath>
+#include <vector>
+
+namespace moveit_benchmarks
+{
+/// Number of distinct random states cycled through by the benchmarks
+constexpr std::size_t NUM_STATES = 100;
+
+/** \brief Create \e count random states of \e group, using a fixed seed so that all runs benchmark the same states.
+    All other variables are set to their default values and the transforms of the states are up to date. */
+inline std::vector<moveit::core::RobotState> createRandomStates(const moveit::core::RobotModelConstPtr& model,
+                                                                const std::string& group, std::size_t count)
+{
+  random_numbers::RandomNumberGenerator rng(42);
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(group);
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+
+  std::vector<moveit::core::RobotState> states(count, state);
+  for (moveit::core::RobotState& s : states)
+  {
+    s.setToRandomPositions(jmg, rng);
+    s.update();
+  }
+  return states;
+}
+
+/** \brief Create a scene for the panda, cluttered with \e num_objects boxes placed on rings around the robot.
+    If no \e allocator is given, the default collision detector is used. */
+inline planning_scene::PlanningScenePtr
+createClutteredScene(const collision_detection::CollisionDetectorAllocatorPtr& allocator, int num_objects)
+{
+  planning_scene::PlanningScenePtr scene =
+      std::make_shared<planning_scene::PlanningScene>(moveit::core::loadTestingRobotModel("panda"));
+  if (allocator)
+    scene->setActiveCollisionDetector(allocator, true);
+
+  shapes::ShapeConstPtr box = std::make_shared<const shapes::Box>(0.1, 0.1, 0.1);
+  for (int i = 0; i < num_objects; ++i)
+  {
+    double angle = 2.0 * M_PI * i / num_objects;
+    double radius = 0.4 + 0.2 * (i % 3);
+    Eigen::Isometry3d pose(Eigen::Translation3d(radius * cos(angle), radius * sin(angle), 0.2 + 0.3 * (i % 4)));
+    scene->getWorldNonConst()->addToObject("box" + std::to_string(i), box, pose);
+  }
+  return scene;
+}
+}  // namespace moveit_benchmarks
@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "benchmark_utils.h"
+#include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
+#ifdef MOVEIT_BENCHMARKS_WITH_BULLET
+#include <moveit/collision_detection_bullet/collision_detector_allocator_bullet.h>
+#endif
+#include <benchmark/benchmark.h>
+
+using moveit_benchmarks::NUM_STATES;
+
+static void selfCollision(benchmark::State& st, const collision_detection::CollisionDetectorAllocatorPtr& allocator)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(allocator, 0);
+  std::vector<moveit::core::RobotState> states =
+      moveit_benchmarks::createRandomStates(scene->getRobotModel(), "panda_arm", NUM_STATES);
+  collision_detection::CollisionRequest req;
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    collision_detection::CollisionResult res;
+    scene->checkSelfCollision(req, res, states[i++ % NUM_STATES]);
+    benchmark::DoNotOptimize(res.collision);
+  }
+}
+
+static void worldCollision(benchmark::State& st, const collision_detection::CollisionDetectorAllocatorPtr& allocator)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(allocator, st.range(0));
+  std::vector<moveit::core::RobotState> states =
+      moveit_benchmarks::createRandomStates(scene->getRobotModel(), "panda_arm", NUM_STATES);
+  collision_detection::CollisionRequest req;
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    collision_detection::CollisionResult res;
+    scene->getCollisionEnv()->checkRobotCollision(req, res, states[i++ % NUM_STATES],
+                                                  scene->getAllowedCollisionMatrix());
+    benchmark::DoNotOptimize(res.collision);
+  }
+}
+
+static void distanceToCollision(benchmark::State& st,
+                                const collision_detection::CollisionDetectorAllocatorPtr& allocator)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(allocator, st.range(0));
+  std::vector<moveit::core::RobotState> states =
+      moveit_benchmarks::createRandomStates(scene->getRobotModel(), "panda_arm", NUM_STATES);
+
+  std::size_t i = 0;
+  for (auto _ : st)
+    benchmark::DoNotOptimize(scene->distanceToCollision(states[i++ % NUM_STATES]));
+}
+
+// Creating a padded environment while another one with the same padding exists, e.g. for a second planning scene
+static void createPaddedEnv(benchmark::State& st, const collision_detection::CollisionDetectorAllocatorPtr& allocator)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  collision_detection::CollisionEnvPtr existing = allocator->allocateEnv(model);
+  existing->setPadding(0.01);
+
+  for (auto _ : st)
+  {
+    collision_detection::CollisionEnvPtr env = allocator->allocateEnv(model);
+    env->setPadding(0.01);
+    benchmark::DoNotOptimize(env.get());
+  }
+}
+
+BENCHMARK_CAPTURE(selfCollision, FCL, collision_detection::CollisionDetectorAllocatorFCL::create());
+BENCHMARK_CAPTURE(createPaddedEnv, FCL, collision_detection::CollisionDetectorAllocatorFCL::create());
+BENCHMARK_CAPTURE(worldCollision, FCL, collision_detection::CollisionDetectorAllocatorFCL::create())
+    ->Arg(10)
+    ->Arg(100);
+BENCHMARK_CAPTURE(distanceToCollision, FCL, collision_detection::CollisionDetectorAllocatorFCL::create())
+    ->Arg(10)
+    ->Arg(100);
+
+#ifdef MOVEIT_BENCHMARKS_WITH_BULLET
+// Bullet does not support distance queries yet
+BENCHMARK_CAPTURE(selfCollision, Bullet, collision_detection::CollisionDetectorAllocatorBullet::create());
+BENCHMARK_CAPTURE(createPaddedEnv, Bullet, collision_detection::CollisionDetectorAllocatorBullet::create());
+BENCHMARK_CAPTURE(worldCollision, Bullet, collision_detection::CollisionDetectorAllocatorBullet::create())
+    ->Arg(10)
+    ->Arg(100);
+#endif
@@ -0,0 +1,136 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "benchmark_utils.h"
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <benchmark/benchmark.h>
+
+using moveit_benchmarks::NUM_STATES;
+
+// Evaluate a visibility constraint from the PR2's head camera onto a target, with the target either attached to the
+// gripper (moving relative to the sensor) or fixed relative to the sensor, for random arm configurations
+static void visibilityConstraintDecide(benchmark::State& st, const std::string& target_frame)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "arms", NUM_STATES);
+  moveit::core::Transforms tf(model->getModelFrame());
+
+  moveit_msgs::VisibilityConstraint vcm;
+  vcm.sensor_pose.header.frame_id = "narrow_stereo_optical_frame";
+  vcm.sensor_pose.pose.position.z = 0.05;
+  vcm.sensor_pose.pose.orientation.w = 1.0;
+  vcm.target_pose.header.frame_id = target_frame;
+  vcm.target_pose.pose.position.z = target_frame == vcm.sensor_pose.header.frame_id ? 1.0 : 0.03;
+  vcm.target_pose.pose.orientation.w = 1.0;
+  vcm.target_radius = 0.05;
+  vcm.cone_sides = 10;
+  vcm.sensor_view_direction = moveit_msgs::VisibilityConstraint::SENSOR_Z;
+  vcm.weight = 1.0;
+
+  kinematic_constraints::VisibilityConstraint vc(model);
+  if (!vc.configure(vcm, tf))
+  {
+    st.SkipWithError("Failed to configure the visibility constraint");
+    return;
+  }
+
+  std::size_t i = 0;
+  for (auto _ : st)
+    benchmark::DoNotOptimize(vc.decide(states[i++ % NUM_STATES]).satisfied);
+}
+BENCHMARK_CAPTURE(visibilityConstraintDecide, moving_target, "l_gripper_r_finger_tip_link");
+BENCHMARK_CAPTURE(visibilityConstraintDecide, fixed_target, "narrow_stereo_optical_frame");
+
+// A typical path constraint for the panda: a joint constraint and an orientation constraint on the tip
+static moveit_msgs::Constraints createPandaPathConstraints()
+{
+  moveit_msgs::Constraints constraints;
+  constraints.joint_constraints.resize(1);
+  constraints.joint_constraints[0].joint_name = "panda_joint1";
+  constraints.joint_constraints[0].tolerance_above = 1.0;
+  constraints.joint_constraints[0].tolerance_below = 1.0;
+  constraints.joint_constraints[0].weight = 1.0;
+
+  constraints.orientation_constraints.resize(1);
+  constraints.orientation_constraints[0].header.frame_id = "panda_link0";
+  constraints.orientation_constraints[0].link_name = "panda_link8";
+  constraints.orientation_constraints[0].orientation.x = 1.0;
+  constraints.orientation_constraints[0].absolute_x_axis_tolerance = 0.5;
+  constraints.orientation_constraints[0].absolute_y_axis_tolerance = 0.5;
+  constraints.orientation_constraints[0].absolute_z_axis_tolerance = M_PI;
+  constraints.orientation_constraints[0].weight = 1.0;
+  return constraints;
+}
+
+// Evaluate the constraint set for NUM_STATES states, one state at a time
+static void kinematicConstraintSetDecide(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "panda_arm", NUM_STATES);
+  kinematic_constraints::KinematicConstraintSet kcs(model);
+  kcs.add(createPandaPathConstraints(), moveit::core::Transforms(model->getModelFrame()));
+
+  // the states need to be updated for every evaluation, as they would be in the planner
+  moveit::core::RobotState state(model);
+  for (auto _ : st)
+    for (const moveit::core::RobotState& s : states)
+    {
+      state.setVariablePositions(s.getVariablePositions());
+      state.update();
+      benchmark::DoNotOptimize(kcs.decide(state).satisfied);
+    }
+}
+BENCHMARK(kinematicConstraintSetDecide);
+
+// Evaluate the constraint set for NUM_STATES states in one batch
+static void kinematicConstraintSetDecideBatch(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "panda_arm", NUM_STATES);
+  kinematic_constraints::KinematicConstraintSet kcs(model);
+  kcs.add(createPandaPathConstraints(), moveit::core::Transforms(model->getModelFrame()));
+
+  Eigen::MatrixXd positions(model->getVariableCount(), NUM_STATES);
+  for (std::size_t i = 0; i < NUM_STATES; ++i)
+    positions.col(i) = Eigen::Map<const Eigen::VectorXd>(states[i].getVariablePositions(), model->getVariableCount());
+
+  Eigen::Array<bool, Eigen::Dynamic, 1> satisfied;
+  Eigen::VectorXd distances;
+  for (auto _ : st)
+  {
+    kcs.decide(states[0], positions, satisfied, distances);
+    benchmark::DoNotOptimize(distances.data());
+  }
+}
+BENCHMARK(kinematicConstraintSetDecideBatch);
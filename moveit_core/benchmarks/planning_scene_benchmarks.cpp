@@ -0,0 +1,111 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "benchmark_utils.h"
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <benchmark/benchmark.h>
+
+static void planningSceneClone(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(nullptr, st.range(0));
+  for (auto _ : st)
+    benchmark::DoNotOptimize(planning_scene::PlanningScene::clone(scene));
+}
+BENCHMARK(planningSceneClone)->Arg(10)->Arg(100);
+
+static void planningSceneDiff(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(nullptr, st.range(0));
+  for (auto _ : st)
+    benchmark::DoNotOptimize(scene->diff());
+}
+BENCHMARK(planningSceneDiff)->Arg(10)->Arg(100);
+
+// Apply a diff message that moves a single object
+static void planningSceneDiffMsg(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(nullptr, st.range(0));
+  planning_scene::PlanningScenePtr child = scene->diff();
+  child->getWorldNonConst()->moveObject("box0", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 0.1)));
+  moveit_msgs::PlanningScene msg;
+  child->getPlanningSceneDiffMsg(msg);
+
+  for (auto _ : st)
+    benchmark::DoNotOptimize(scene->diff(msg));
+}
+BENCHMARK(planningSceneDiffMsg)->Arg(10)->Arg(100);
+
+static void planningSceneToMsg(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(nullptr, st.range(0));
+  for (auto _ : st)
+  {
+    moveit_msgs::PlanningScene msg;
+    scene->getPlanningSceneMsg(msg);
+    benchmark::DoNotOptimize(msg.world.collision_objects.data());
+  }
+}
+BENCHMARK(planningSceneToMsg)->Arg(10)->Arg(100);
+
+static void planningSceneFromMsg(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = moveit_benchmarks::createClutteredScene(nullptr, st.range(0));
+  moveit_msgs::PlanningScene msg;
+  scene->getPlanningSceneMsg(msg);
+  planning_scene::PlanningScene target(scene->getRobotModel());
+
+  for (auto _ : st)
+    benchmark::DoNotOptimize(target.setPlanningSceneMsg(msg));
+}
+BENCHMARK(planningSceneFromMsg)->Arg(10)->Arg(100);
+
+// Time-parameterize a path through st.range(0) random waypoints
+static void timeOptimalTrajectoryGeneration(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  robot_trajectory::RobotTrajectory path(model, "panda_arm");
+  for (const moveit::core::RobotState& state : moveit_benchmarks::createRandomStates(model, "panda_arm", st.range(0)))
+    path.addSuffixWayPoint(state, 0.0);
+  trajectory_processing::TimeOptimalTrajectoryGeneration totg;
+
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    robot_trajectory::RobotTrajectory trajectory(path, true);
+    st.ResumeTiming();
+    benchmark::DoNotOptimize(totg.computeTimeStamps(trajectory));
+  }
+}
+BENCHMARK(timeOptimalTrajectoryGeneration)->Arg(5)->Arg(20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,247 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "benchmark_utils.h"
+#include <moveit/robot_state/conversions.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <benchmark/benchmark.h>
+
+using moveit_benchmarks::NUM_STATES;
+
+// Forward kinematics of all links after changing all variables
+static void robotStateUpdate(benchmark::State& st, const std::string& robot, const std::string& group)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel(robot);
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, group, NUM_STATES);
+  moveit::core::RobotState state(model);
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    state.setVariablePositions(states[i++ % NUM_STATES].getVariablePositions());
+    state.update();
+    benchmark::DoNotOptimize(state.getGlobalLinkTransform(model->getLinkModels().back()));
+  }
+}
+BENCHMARK_CAPTURE(robotStateUpdate, panda, "panda", "panda_arm");
+BENCHMARK_CAPTURE(robotStateUpdate, pr2, "pr2", "right_arm");
+
+// Forward kinematics after moving both arms of the pr2, i.e. two disjoint subtrees below the torso
+static void robotStateUpdateBothArms(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  const moveit::core::JointModelGroup* right_arm = model->getJointModelGroup("right_arm");
+  const moveit::core::JointModelGroup* left_arm = model->getJointModelGroup("left_arm");
+  std::vector<moveit::core::RobotState> right_states =
+      moveit_benchmarks::createRandomStates(model, "right_arm", NUM_STATES);
+  std::vector<moveit::core::RobotState> left_states =
+      moveit_benchmarks::createRandomStates(model, "left_arm", NUM_STATES);
+  moveit::core::RobotState state(right_states[0]);
+
+  std::vector<double> right, left;
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    right_states[i % NUM_STATES].copyJointGroupPositions(right_arm, right);
+    left_states[i++ % NUM_STATES].copyJointGroupPositions(left_arm, left);
+    state.setJointGroupPositions(right_arm, right);
+    state.setJointGroupPositions(left_arm, left);
+    state.update();
+    benchmark::DoNotOptimize(state.getGlobalLinkTransform(model->getLinkModels().back()));
+  }
+}
+BENCHMARK(robotStateUpdateBothArms);
+
+// Forward kinematics of a pr2 carrying many attached bodies, after changing only the right arm.
+// Bodies that do not hang off the right arm keep their transforms.
+static void robotStateUpdateAttachedBodies(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("right_arm");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "right_arm", NUM_STATES);
+  moveit::core::RobotState state(states[0]);
+
+  std::vector<shapes::ShapeConstPtr> shapes(1, std::make_shared<const shapes::Box>(0.05, 0.05, 0.05));
+  moveit::core::FixedTransformsMap subframes;
+  subframes["top"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.025));
+  for (int i = 0; i < 50; ++i)
+  {
+    // a tray of parts on the base and a few objects held in the right gripper
+    const std::string link = i < 45 ? "base_link" : "r_gripper_palm_link";
+    EigenSTL::vector_Isometry3d poses(1, Eigen::Isometry3d(Eigen::Translation3d(0.05 * (i % 5), 0.05 * (i / 5), 0.5)));
+    state.attachBody("part" + std::to_string(i), shapes, poses, std::set<std::string>(), link,
+                     trajectory_msgs::JointTrajectory(), subframes);
+  }
+  state.update();
+
+  std::vector<double> positions;
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    states[i++ % NUM_STATES].copyJointGroupPositions(jmg, positions);
+    state.setJointGroupPositions(jmg, positions);
+    state.update();
+    benchmark::DoNotOptimize(state.getAttachedBody("part49")->getGlobalCollisionBodyTransforms()[0]);
+  }
+}
+BENCHMARK(robotStateUpdateAttachedBodies);
+
+static void robotStateJacobian(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("panda_arm");
+  const moveit::core::LinkModel* tip = model->getLinkModel("panda_link8");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "panda_arm", NUM_STATES);
+
+  Eigen::MatrixXd jacobian;
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    states[i++ % NUM_STATES].getJacobian(jmg, tip, Eigen::Vector3d::Zero(), jacobian);
+    benchmark::DoNotOptimize(jacobian.data());
+  }
+}
+BENCHMARK(robotStateJacobian);
+
+static void jointModelGroupDistance(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("panda_arm");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "panda_arm", NUM_STATES);
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    const moveit::core::RobotState& from = states[i % NUM_STATES];
+    const moveit::core::RobotState& to = states[++i % NUM_STATES];
+    benchmark::DoNotOptimize(from.distance(to, jmg));
+  }
+}
+BENCHMARK(jointModelGroupDistance);
+
+static void jointModelGroupInterpolate(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("panda_arm");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "panda_arm", NUM_STATES);
+  moveit::core::RobotState result(states[0]);
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    const moveit::core::RobotState& from = states[i % NUM_STATES];
+    const moveit::core::RobotState& to = states[++i % NUM_STATES];
+    from.interpolate(to, 0.3, result, jmg);
+    benchmark::DoNotOptimize(result.getVariablePositions());
+  }
+}
+BENCHMARK(jointModelGroupInterpolate);
+
+// Distance and interpolation on group states, as used by OMPL's ModelBasedStateSpace
+static std::vector<std::vector<double>> createRandomGroupStates(const moveit::core::RobotModelPtr& model,
+                                                               const std::string& group)
+{
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(group);
+  std::vector<std::vector<double>> group_states(NUM_STATES);
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, group, NUM_STATES);
+  for (std::size_t i = 0; i < NUM_STATES; ++i)
+    states[i].copyJointGroupPositions(jmg, group_states[i]);
+  return group_states;
+}
+
+static void groupStateDistance(benchmark::State& st, const std::string& robot, const std::string& group)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel(robot);
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(group);
+  std::vector<std::vector<double>> states = createRandomGroupStates(model, group);
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    const std::vector<double>& from = states[i % NUM_STATES];
+    const std::vector<double>& to = states[++i % NUM_STATES];
+    benchmark::DoNotOptimize(jmg->distance(from.data(), to.data()));
+  }
+}
+BENCHMARK_CAPTURE(groupStateDistance, panda, "panda", "panda_arm");
+BENCHMARK_CAPTURE(groupStateDistance, pr2, "pr2", "right_arm");  // with continuous joints
+
+static void groupStateInterpolate(benchmark::State& st, const std::string& robot, const std::string& group)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel(robot);
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(group);
+  std::vector<std::vector<double>> states = createRandomGroupStates(model, group);
+  std::vector<double> result(jmg->getVariableCount());
+
+  std::size_t i = 0;
+  for (auto _ : st)
+  {
+    const std::vector<double>& from = states[i % NUM_STATES];
+    const std::vector<double>& to = states[++i % NUM_STATES];
+    jmg->interpolate(from.data(), to.data(), 0.3, result.data());
+    benchmark::DoNotOptimize(result.data());
+  }
+}
+BENCHMARK_CAPTURE(groupStateInterpolate, panda, "panda", "panda_arm");
+BENCHMARK_CAPTURE(groupStateInterpolate, pr2, "pr2", "right_arm");
+
+static void robotStateToMsg(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "right_arm", 1);
+
+  for (auto _ : st)
+  {
+    moveit_msgs::RobotState msg;
+    moveit::core::robotStateToRobotStateMsg(states[0], msg);
+    benchmark::DoNotOptimize(msg.joint_state.position.data());
+  }
+}
+BENCHMARK(robotStateToMsg);
+
+static void robotStateFromMsg(benchmark::State& st)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  std::vector<moveit::core::RobotState> states = moveit_benchmarks::createRandomStates(model, "right_arm", 1);
+  moveit_msgs::RobotState msg;
+  moveit::core::robotStateToRobotStateMsg(states[0], msg);
+  moveit::core::RobotState state(model);
+
+  for (auto _ : st)
+  {
+    moveit::core::robotStateMsgToRobotState(msg, state);
+    benchmark::DoNotOptimize(state.getVariablePositions());
+  }
+}
+BENCHMARK(robotStateFromMsg);
@@ -38,10 +38,12 @@
 
 #include <boost/array.hpp>
 #include <boost/function.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <Eigen/Core>
 #include <moveit/robot_model/robot_model.h>
 
@@ -105,6 +107,87 @@ struct Contact
   Eigen::Vector3d nearest_points[2];
 };
 
+/** \brief Definition of a contact point whose bodies are referred to by interned name ids (see internName()) */
+struct IndexedContact
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /** \brief contact position */
+  Eigen::Vector3d pos;
+
+  /** \brief normal unit vector at contact */
+  Eigen::Vector3d normal;
+
+  /** \brief depth (penetration between bodies) */
+  double depth;
+
+  /** \brief The interned id of the first body involved in the contact */
+  std::uint32_t body_id_1;
+
+  /** \brief The type of the first body involved in the contact */
+  BodyType body_type_1;
+
+  /** \brief The interned id of the second body involved in the contact */
+  std::uint32_t body_id_2;
+
+  /** \brief The type of the second body involved in the contact */
+  BodyType body_type_2;
+};
+
+/** \brief Flat storage of contacts, keyed by interned body ids.
+ *
+ *  Storing a contact copies no strings, and clear() keeps the allocated capacity, so a container
+ *  that is reused across collision checks stops allocating once it has grown to the needed size. */
+class IndexedContactMap
+{
+public:
+  /** \brief Remove all contacts, keeping the allocated memory */
+  void clear()
+  {
+    contacts_.clear();
+    pair_counts_.clear();
+  }
+
+  /** \brief Store \e contact */
+  void add(const IndexedContact& contact);
+
+  /** \brief Get the number of contacts stored for the pair of bodies \e id1 and \e id2 (in any order) */
+  std::size_t getPairContactCount(std::uint32_t id1, std::uint32_t id2) const;
+
+  /** \brief Get the number of pairs of bodies with stored contacts */
+  std::size_t getPairCount() const
+  {
+    return pair_counts_.size();
+  }
+
+  /** \brief Get all stored contacts, in the order they were added */
+  const std::vector<IndexedContact>& getContacts() const
+  {
+    return contacts_;
+  }
+
+  /** \brief Check if no contacts are stored */
+  bool empty() const
+  {
+    return contacts_.empty();
+  }
+
+  /** \brief Convert to the representation used by CollisionResult::contacts.
+   *  Pairs are keyed by body names in lexicographical order, as done by the collision checkers. */
+  void getContactMap(std::map<std::pair<std::string, std::string>, std::vector<Contact> >& contacts) const;
+
+private:
+  static std::uint64_t getPairKey(std::uint32_t id1, std::uint32_t id2)
+  {
+    return id1 < id2 ? (std::uint64_t(id1) << 32) | id2 : (std::uint64_t(id2) << 32) | id1;
+  }
+
+  std::vector<IndexedContact> contacts_;
+
+  /** \brief Number of contacts per pair key */
+  std::unordered_map<std::uint64_t, std::size_t> pair_counts_;
+};
+
 /** \brief When collision costs are computed, this structure contains information about the partial cost incurred in a
  * particular volume */
 struct CostSource
@@ -158,6 +241,7 @@ struct CollisionResult
     distance = std::numeric_limits<double>::max();
     contact_count = 0;
     contacts.clear();
+    indexed_contacts.clear();
     cost_sources.clear();
   }
 
@@ -176,6 +260,10 @@ struct CollisionResult
   /** \brief A map returning the pairs of body ids in contact, plus their contact details */
   ContactMap contacts;
 
+  /** \brief The contacts, if CollisionRequest::indexed_contacts was set and the collision checker supports it.
+   *  Use IndexedContactMap::getContactMap() to convert them to a ContactMap. */
+  IndexedContactMap indexed_contacts;
+
   /** \brief These are the individual cost sources when costs are computed */
   std::set<CostSource> cost_sources;
 };
@@ -191,6 +279,7 @@ struct CollisionRequest
     , max_contacts_per_pair(1)
     , max_cost_sources(1)
     , min_cost_density(0.2)
+    , indexed_contacts(false)
     , verbose(false)
   {
   }
@@ -226,6 +315,11 @@ struct CollisionRequest
   /** \brief Function call that decides whether collision detection should stop. */
   boost::function<bool(const CollisionResult&)> is_done;
 
+  /** \brief If true, contacts are stored in CollisionResult::indexed_contacts instead of CollisionResult::contacts.
+   *  This avoids copying body names for every contact. It is supported by the FCL collision checker; other checkers
+   *  ignore it and fill CollisionResult::contacts. */
+  bool indexed_contacts;
+
   /** \brief Flag indicating whether information about detected collisions should be reported */
   bool verbose;
 };
@@ -37,9 +37,11 @@
 #pragma once
 
 #include <moveit/collision_detection/collision_common.h>
+#include <moveit/collision_detection/interned_names.h>
 #include <moveit/macros/class_forward.h>
 #include <moveit_msgs/AllowedCollisionMatrix.h>
 #include <boost/function.hpp>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -72,6 +74,7 @@ enum Type
 using DecideContactFn = boost::function<bool(collision_detection::Contact&)>;
 
 MOVEIT_CLASS_FORWARD(AllowedCollisionMatrix);  // Defines AllowedCollisionMatrixPtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(CompiledAllowedCollisionMatrix);
 
 /** @class AllowedCollisionMatrix
  *  @brief Definition of a structure for the allowed collision matrix. All elements in the collision world are referred
@@ -91,8 +94,11 @@ public:
   /** @brief Construct the structure from a message representation */
   AllowedCollisionMatrix(const moveit_msgs::AllowedCollisionMatrix& msg);
 
-  /** @brief Copy constructor */
-  AllowedCollisionMatrix(const AllowedCollisionMatrix& acm) = default;
+  /** @brief Copy constructor. The compiled form of \e acm is shared, it may be built concurrently by getCompiled(). */
+  AllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
+
+  /** @brief Copy assignment. The compiled form of \e acm is shared, it may be built concurrently by getCompiled(). */
+  AllowedCollisionMatrix& operator=(const AllowedCollisionMatrix& acm);
 
   /** @brief Get the type of the allowed collision between two elements. Return true if the entry is included in the
    * collision matrix.
@@ -266,14 +272,95 @@ public:
   bool getAllowedCollision(const std::string& name1, const std::string& name2,
                            AllowedCollision::Type& allowed_collision) const;
 
+  /** @brief Get a 64-bit hash of the entries and default entries of the matrix.
+   *  Conditional entries are hashed by their type only, the predicates are not compared.
+   *  The cost is linear in the number of entries. */
+  std::uint64_t getHash() const;
+
   /** @brief Print the allowed collision matrix */
   void print(std::ostream& out) const;
 
+  /** @brief Get a dense, read-only form of this matrix that is indexed by interned name ids (see internName()).
+   *  It is built on first use and rebuilt after the matrix is modified. Concurrent calls are safe, as long as
+   *  the matrix is not modified at the same time. */
+  CompiledAllowedCollisionMatrixConstPtr getCompiled() const;
+
 private:
+  friend class CompiledAllowedCollisionMatrix;
+
+  /** @brief Drop the compiled form after a modification */
+  void invalidateCompiled()
+  {
+    compiled_.reset();
+  }
+
   std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
   std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
 
   std::map<std::string, AllowedCollision::Type> default_entries_;
   std::map<std::string, DecideContactFn> default_allowed_contacts_;
+
+  /** @brief Lazily built by getCompiled(), accessed atomically */
+  mutable CompiledAllowedCollisionMatrixConstPtr compiled_;
+};
+
+/** @class CompiledAllowedCollisionMatrix
+ *  @brief Read-only, dense form of an AllowedCollisionMatrix for lookups in collision checking callbacks.
+ *   Elements are referred to by the ids returned by internName(). The resolved type of each pair of elements
+ *   known to the matrix, default entries included, is packed into a matrix with two bits per pair, so a lookup
+ *   is array indexing instead of several string-keyed map lookups. Predicates of conditional entries are not
+ *   stored; they are rare and can be retrieved from the AllowedCollisionMatrix by name. */
+class CompiledAllowedCollisionMatrix
+{
+public:
+  /** @brief Build the dense form of \e acm */
+  CompiledAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
+
+  /** @brief Get the type of the allowed collision between two elements, given by their interned ids.
+   *  This has the same semantics as AllowedCollisionMatrix::getAllowedCollision(): default entries take precedence
+   *  and false is returned if neither an entry nor a default entry applies. */
+  bool getAllowedCollision(std::uint32_t id1, std::uint32_t id2, AllowedCollision::Type& allowed_collision) const
+  {
+    const std::int32_t row1 = id1 < rows_.size() ? rows_[id1] : -1;
+    const std::int32_t row2 = id2 < rows_.size() ? rows_[id2] : -1;
+    std::uint8_t code = 0;
+    if (row1 >= 0 && row2 >= 0)
+      code = getCode(row1, row2);
+    else if (row1 >= 0)
+      code = defaults_[row1];
+    else if (row2 >= 0)
+      code = defaults_[row2];
+    if (code == 0)
+      return false;
+    allowed_collision = static_cast<AllowedCollision::Type>(code - 1);
+    return true;
+  }
+
+  /** @brief Get the number of elements known to the matrix */
+  std::size_t getSize() const
+  {
+    return size_;
+  }
+
+private:
+  /* Codes are 0 for "not found" and type + 1 otherwise */
+  std::uint8_t getCode(std::size_t row1, std::size_t row2) const
+  {
+    const std::size_t index = row1 * size_ + row2;
+    return (codes_[index / 32] >> (2 * (index % 32))) & 3u;
+  }
+
+  void setCode(std::size_t row1, std::size_t row2, std::uint8_t code);
+
+  /** @brief Row of each interned name id, -1 for names unknown to the matrix */
+  std::vector<std::int32_t> rows_;
+
+  std::size_t size_;
+
+  /** @brief Code of the default entry of each row */
+  std::vector<std::uint8_t> defaults_;
+
+  /** @brief Codes of all pairs of rows, two bits each */
+  std::vector<std::uint64_t> codes_;
 };
 }  // namespace collision_detection
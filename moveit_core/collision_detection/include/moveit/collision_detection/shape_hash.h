@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <Eigen/Geometry>
+
+namespace shapes
+{
+class Shape;
+}
+
+namespace collision_detection
+{
+/** \brief Mix the bits of \e value so that nearby inputs give unrelated outputs */
+inline std::uint64_t mixHash(std::uint64_t value)
+{
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+/** \brief Combine \e value into \e seed. The result depends on the order of combination. */
+inline void combineHash(std::uint64_t& seed, std::uint64_t value)
+{
+  seed = mixHash(seed + 0x9e3779b97f4a7c15ULL + value);
+}
+
+/** \brief Hash \e size bytes starting at \e data.
+ *
+ * Unlike std::hash, the result is the same in every process on the same platform,
+ * so it may be used to refer to content across process boundaries. */
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+/** \brief Hash the characters of \e str */
+inline std::uint64_t hashString(const std::string& str, std::uint64_t seed = 0)
+{
+  return hashBytes(str.data(), str.size(), seed);
+}
+
+/** \brief Hash a double, treating 0.0 and -0.0 as equal */
+std::uint64_t hashDouble(double value);
+
+/** \brief Hash the geometry of \e shape.
+ *
+ * Two shapes with the same type and the same geometry have the same hash, independent of their address.
+ * Meshes are hashed by vertices and triangles, so the cost is linear in their size. Octrees are only hashed
+ * by resolution and number of nodes, in constant time, so their content is not covered by the hash. */
+std::uint64_t computeShapeHash(const shapes::Shape& shape);
+
+/** \brief Check whether \e a and \e b have the same type and the same geometry.
+ *
+ * Use this to confirm a match of computeShapeHash() before treating two shapes as interchangeable. Meshes are
+ * compared by vertices and triangles. Octrees are only equal if they share the same octree instance. */
+bool equalShapes(const shapes::Shape& a, const shapes::Shape& b);
+
+/** \brief Hash the coefficients of \e pose */
+std::uint64_t computePoseHash(const Eigen::Isometry3d& pose);
+}  // namespace collision_detection
@@ -38,6 +38,7 @@
 
 #include <moveit/macros/class_forward.h>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -110,6 +111,18 @@ public:
      *  (e.g. screwdriver/tip, kettle/spout, mug/base).
      */
     moveit::core::FixedTransformsMap subframe_poses_;
+
+    /** \brief Geometry hashes of the corresponding entries in shapes_, maintained by World.
+     *
+     * These only depend on the geometry and are computed once when a shape is added. */
+    std::vector<std::uint64_t> shape_hashes_;
+
+    /** \brief Version of the content of shapes that are modified in place (octrees), as passed to
+     * World::rehashObject(). Part of the hash of the object. */
+    std::uint64_t version_ = 0;
+
+    /** \brief Hash of the id, shapes, shape poses, subframes and version of this object, maintained by World. */
+    std::uint64_t hash_ = 0;
   };
 
   /** \brief Get the list of Object ids */
@@ -179,6 +192,11 @@ public:
   bool moveShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape,
                          const Eigen::Isometry3d& pose);
 
+  /** \brief Set the poses of all shapes in an object at once.
+   * \e poses must contain one pose per shape, in the order of Object::shapes_.
+   * Observers are notified once. Returns true on success. */
+  bool moveShapesInObject(const std::string& object_id, const EigenSTL::vector_Isometry3d& poses);
+
   /** \brief Move all shapes in an object according to the given transform specified in world frame */
   bool moveObject(const std::string& object_id, const Eigen::Isometry3d& transform);
 
@@ -204,6 +222,25 @@ public:
    * the memory is freed. */
   void clearObjects();
 
+  /** \brief Set the version of an object whose shapes were modified in place and update its hash.
+   * Shapes are normally immutable, but an octree may be updated without replacing
+   * the shape. The content of octrees is not hashed, so the caller passes a version
+   * that changes with each modification (e.g. the update counter of the octree).
+   * Observers are not notified. Returns false if the object does not exist. */
+  bool rehashObject(const std::string& object_id, std::uint64_t version);
+
+  /** \brief Get a 64-bit hash of the content of the world.
+   *
+   * The hash covers the ids, shape geometry, shape poses, subframes and versions of all objects
+   * and does not depend on the order of modifications. Two worlds with the same content
+   * have the same hash. Octrees only contribute their resolution and size, their content is
+   * represented by the version set with rehashObject(). The hash is updated with each
+   * modification, so this call is constant time. */
+  std::uint64_t getHash() const
+  {
+    return hash_;
+  }
+
   enum ActionBits
   {
     UNINITIALIZED = 0,
@@ -276,11 +313,19 @@ private:
   /** send notification of change to all objects. */
   void notifyAll(Action action);
 
+  /** \brief Find the pose of the subframe \e name, given as "object id/subframe name".
+   * The object is looked up directly by the prefixes of \e name, not by visiting all objects.
+   * Returns nullptr if there is no such subframe. */
+  const Eigen::Isometry3d* findSubframePose(const std::string& name) const;
+
   /** \brief Make sure that the object named \e id is known only to this
    * instance of the World. If the object is known outside of it, a
    * clone is made so that it can be safely modified later on. */
   void ensureUnique(ObjectPtr& obj);
 
+  /** Recompute the hash of \e obj from its cached shape hashes and update hash_ accordingly */
+  void updateObjectHash(Object& obj);
+
   /* Add a shape with no checking */
   virtual void addToObjectInternal(const ObjectPtr& obj, const shapes::ShapeConstPtr& shape,
                                    const Eigen::Isometry3d& pose);
@@ -288,6 +333,9 @@ private:
   /** The objects maintained in the world */
   std::map<std::string, ObjectPtr> objects_;
 
+  /** Order independent combination of the hashes of all objects */
+  std::uint64_t hash_;
+
   /** Wrapper for a callback function to call when something changes in the world */
   class Observer
   {
@@ -33,6 +33,7 @@
  *********************************************************************/
 
 #include <moveit/collision_detection/collision_common.h>
+#include <moveit/collision_detection/interned_names.h>
 
 static const char LOGNAME[] = "collision_common";
 constexpr size_t LOG_THROTTLE_PERIOD = 5;
@@ -58,4 +59,49 @@ void CollisionResult::print() const
   }
 }
 
+void IndexedContactMap::add(const IndexedContact& contact)
+{
+  contacts_.push_back(contact);
+  ++pair_counts_[getPairKey(contact.body_id_1, contact.body_id_2)];
+}
+
+std::size_t IndexedContactMap::getPairContactCount(std::uint32_t id1, std::uint32_t id2) const
+{
+  auto it = pair_counts_.find(getPairKey(id1, id2));
+  return it == pair_counts_.end() ? 0 : it->second;
+}
+
+void IndexedContactMap::getContactMap(
+    std::map<std::pair<std::string, std::string>, std::vector<Contact> >& contacts) const
+{
+  contacts.clear();
+
+  // resolve all names at once instead of locking the interned names once per contact
+  std::vector<std::uint32_t> ids;
+  ids.reserve(2 * contacts_.size());
+  for (const IndexedContact& indexed : contacts_)
+  {
+    ids.push_back(indexed.body_id_1);
+    ids.push_back(indexed.body_id_2);
+  }
+  const std::vector<const std::string*> names = getInternedNames(ids);
+
+  Contact c;
+  for (std::size_t i = 0; i < contacts_.size(); ++i)
+  {
+    const IndexedContact& indexed = contacts_[i];
+    c.pos = indexed.pos;
+    c.normal = indexed.normal;
+    c.depth = indexed.depth;
+    c.body_name_1 = *names[2 * i];
+    c.body_type_1 = indexed.body_type_1;
+    c.body_name_2 = *names[2 * i + 1];
+    c.body_type_2 = indexed.body_type_2;
+    if (c.body_name_1 < c.body_name_2)
+      contacts[std::make_pair(c.body_name_1, c.body_name_2)].push_back(c);
+    else
+      contacts[std::make_pair(c.body_name_2, c.body_name_1)].push_back(c);
+  }
+}
+
 }  // namespace collision_detection
@@ -292,7 +292,8 @@ void CollisionEnv::checkCollision(const CollisionRequest& req, CollisionResult&
                                   const moveit::core::RobotState& state) const
 {
   checkSelfCollision(req, res, state);
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  const std::size_t pair_count = req.indexed_contacts ? res.indexed_contacts.getPairCount() : res.contacts.size();
+  if (!res.collision || (req.contacts && pair_count < req.max_contacts))
     checkRobotCollision(req, res, state);
 }
 
@@ -300,7 +301,8 @@ void CollisionEnv::checkCollision(const CollisionRequest& req, CollisionResult&
                                   const moveit::core::RobotState& state, const AllowedCollisionMatrix& acm) const
 {
   checkSelfCollision(req, res, state, acm);
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  const std::size_t pair_count = req.indexed_contacts ? res.indexed_contacts.getPairCount() : res.contacts.size();
+  if (!res.collision || (req.contacts && pair_count < req.max_contacts))
     checkRobotCollision(req, res, state, acm);
 }
 
@@ -35,8 +35,10 @@
 /* Author: Ioan Sucan, E. Gil Jones */
 
 #include <moveit/collision_detection/collision_matrix.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <boost/bind.hpp>
 #include <iomanip>
+#include <memory>
 
 namespace collision_detection
 {
@@ -51,6 +53,28 @@ AllowedCollisionMatrix::AllowedCollisionMatrix(const std::vector<std::string>& n
       setEntry(names[i], names[j], allowed);
 }
 
+AllowedCollisionMatrix::AllowedCollisionMatrix(const AllowedCollisionMatrix& acm)
+  : entries_(acm.entries_)
+  , allowed_contacts_(acm.allowed_contacts_)
+  , default_entries_(acm.default_entries_)
+  , default_allowed_contacts_(acm.default_allowed_contacts_)
+  , compiled_(std::atomic_load(&acm.compiled_))
+{
+}
+
+AllowedCollisionMatrix& AllowedCollisionMatrix::operator=(const AllowedCollisionMatrix& acm)
+{
+  if (this != &acm)
+  {
+    entries_ = acm.entries_;
+    allowed_contacts_ = acm.allowed_contacts_;
+    default_entries_ = acm.default_entries_;
+    default_allowed_contacts_ = acm.default_allowed_contacts_;
+    std::atomic_store(&compiled_, std::atomic_load(&acm.compiled_));
+  }
+  return *this;
+}
+
 AllowedCollisionMatrix::AllowedCollisionMatrix(const moveit_msgs::AllowedCollisionMatrix& msg)
 {
   if (msg.entry_names.size() != msg.entry_values.size() ||
@@ -114,6 +138,7 @@ bool AllowedCollisionMatrix::hasEntry(const std::string& name1, const std::strin
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, bool allowed)
 {
+  invalidateCompiled();
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   entries_[name1][name2] = entries_[name2][name1] = v;
 
@@ -136,12 +161,14 @@ void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::strin
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, const DecideContactFn& fn)
 {
+  invalidateCompiled();
   entries_[name1][name2] = entries_[name2][name1] = AllowedCollision::CONDITIONAL;
   allowed_contacts_[name1][name2] = allowed_contacts_[name2][name1] = fn;
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name)
 {
+  invalidateCompiled();
   entries_.erase(name);
   allowed_contacts_.erase(name);
   for (auto& entry : entries_)
@@ -152,6 +179,7 @@ void AllowedCollisionMatrix::removeEntry(const std::string& name)
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::string& name2)
 {
+  invalidateCompiled();
   auto jt = entries_.find(name1);
   if (jt != entries_.end())
   {
@@ -210,6 +238,7 @@ void AllowedCollisionMatrix::setEntry(const std::string& name, bool allowed)
 
 void AllowedCollisionMatrix::setEntry(bool allowed)
 {
+  invalidateCompiled();
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   for (auto& entry : entries_)
     for (auto& it2 : entry.second)
@@ -218,6 +247,7 @@ void AllowedCollisionMatrix::setEntry(bool allowed)
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, bool allowed)
 {
+  invalidateCompiled();
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   default_entries_[name] = v;
   default_allowed_contacts_.erase(name);
@@ -225,6 +255,7 @@ void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, bool allow
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const DecideContactFn& fn)
 {
+  invalidateCompiled();
   default_entries_[name] = AllowedCollision::CONDITIONAL;
   default_allowed_contacts_[name] = fn;
 }
@@ -307,6 +338,7 @@ bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const
 
 void AllowedCollisionMatrix::clear()
 {
+  invalidateCompiled();
   entries_.clear();
   allowed_contacts_.clear();
   default_entries_.clear();
@@ -323,6 +355,28 @@ void AllowedCollisionMatrix::getAllEntryNames(std::vector<std::string>& names) c
       names.push_back(entry.first);
 }
 
+std::uint64_t AllowedCollisionMatrix::getHash() const
+{
+  std::uint64_t h = 0;
+  for (const auto& entry : entries_)
+  {
+    combineHash(h, hashString(entry.first));
+    combineHash(h, entry.second.size());
+    for (const auto& value : entry.second)
+    {
+      combineHash(h, hashString(value.first));
+      combineHash(h, value.second);
+    }
+  }
+  combineHash(h, entries_.size());
+  for (const auto& entry : default_entries_)
+  {
+    combineHash(h, hashString(entry.first));
+    combineHash(h, entry.second);
+  }
+  return h;
+}
+
 void AllowedCollisionMatrix::getMessage(moveit_msgs::AllowedCollisionMatrix& msg) const
 {
   msg.entry_names.clear();
@@ -409,4 +463,89 @@ void AllowedCollisionMatrix::print(std::ostream& out) const
   }
 }
 
+CompiledAllowedCollisionMatrixConstPtr AllowedCollisionMatrix::getCompiled() const
+{
+  CompiledAllowedCollisionMatrixConstPtr compiled = std::atomic_load(&compiled_);
+  if (!compiled)
+  {
+    // concurrent callers may both build the matrix, which is harmless
+    compiled = std::make_shared<const CompiledAllowedCollisionMatrix>(*this);
+    std::atomic_store(&compiled_, compiled);
+  }
+  return compiled;
+}
+
+namespace
+{
+std::uint8_t combineDefaultCodes(std::uint8_t code1, std::uint8_t code2)
+{
+  if (code1 == 0 || code2 == 0)
+    return code1 | code2;
+  // same precedence as AllowedCollisionMatrix::getAllowedCollision()
+  if (code1 == AllowedCollision::NEVER + 1 || code2 == AllowedCollision::NEVER + 1)
+    return AllowedCollision::NEVER + 1;
+  if (code1 == AllowedCollision::CONDITIONAL + 1 || code2 == AllowedCollision::CONDITIONAL + 1)
+    return AllowedCollision::CONDITIONAL + 1;
+  return AllowedCollision::ALWAYS + 1;
+}
+}  // namespace
+
+CompiledAllowedCollisionMatrix::CompiledAllowedCollisionMatrix(const AllowedCollisionMatrix& acm) : size_(0)
+{
+  // assign a row to every name mentioned in the matrix
+  const auto add_name = [this](const std::string& name) {
+    const std::uint32_t id = internName(name);
+    if (id >= rows_.size())
+      rows_.resize(id + 1, -1);
+    if (rows_[id] < 0)
+      rows_[id] = static_cast<std::int32_t>(size_++);
+    return static_cast<std::size_t>(rows_[id]);
+  };
+  for (const auto& entry : acm.entries_)
+  {
+    add_name(entry.first);
+    for (const auto& value : entry.second)
+      add_name(value.first);
+  }
+  for (const auto& entry : acm.default_entries_)
+    add_name(entry.first);
+
+  defaults_.assign(size_, 0);
+  codes_.assign((size_ * size_ + 31) / 32, 0);
+
+  for (const auto& entry : acm.entries_)
+  {
+    const std::size_t row1 = rows_[internName(entry.first)];
+    for (const auto& value : entry.second)
+      setCode(row1, rows_[internName(value.first)], value.second + 1);
+  }
+
+  if (acm.default_entries_.empty())
+    return;
+
+  // default entries take precedence over entries of any pair they are part of
+  std::vector<std::size_t> default_rows;
+  for (const auto& entry : acm.default_entries_)
+  {
+    const std::size_t row = rows_[internName(entry.first)];
+    defaults_[row] = entry.second + 1;
+    default_rows.push_back(row);
+  }
+  for (std::size_t row1 : default_rows)
+    for (std::size_t row2 = 0; row2 < size_; ++row2)
+    {
+      const std::uint8_t code = combineDefaultCodes(defaults_[row1], defaults_[row2]);
+      setCode(row1, row2, code);
+      setCode(row2, row1, code);
+    }
+}
+
+void CompiledAllowedCollisionMatrix::setCode(std::size_t row1, std::size_t row2, std::uint8_t code)
+{
+  const std::size_t index = row1 * size_ + row2;
+  std::uint64_t& word = codes_[index / 32];
+  const std::size_t shift = 2 * (index % 32);
+  word = (word & ~(std::uint64_t(3) << shift)) | (std::uint64_t(code) << shift);
+}
+
 }  // end of namespace collision_detection
@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/collision_detection/interned_names.h>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace collision_detection
+{
+namespace
+{
+struct InternedNames
+{
+  std::mutex lock;
+  std::unordered_map<std::string, std::uint32_t> ids;
+  // a deque never moves its elements, so references to names stay valid
+  std::deque<std::string> names;
+};
+
+InternedNames& getNameTable()
+{
+  static InternedNames interned_names;
+  return interned_names;
+}
+}  // namespace
+
+std::uint32_t internName(const std::string& name)
+{
+  InternedNames& interned = getNameTable();
+  std::lock_guard<std::mutex> lock(interned.lock);
+  auto it = interned.ids.find(name);
+  if (it != interned.ids.end())
+    return it->second;
+  const auto id = static_cast<std::uint32_t>(interned.names.size());
+  interned.names.push_back(name);
+  interned.ids.emplace(name, id);
+  return id;
+}
+
+const std::string& getInternedName(std::uint32_t id)
+{
+  InternedNames& interned = getNameTable();
+  std::lock_guard<std::mutex> lock(interned.lock);
+  return interned.names.at(id);
+}
+
+std::vector<const std::string*> getInternedNames(const std::vector<std::uint32_t>& ids)
+{
+  std::vector<const std::string*> names;
+  names.reserve(ids.size());
+  InternedNames& interned = getNameTable();
+  std::lock_guard<std::mutex> lock(interned.lock);
+  for (std::uint32_t id : ids)
+    names.push_back(&interned.names.at(id));
+  return names;
+}
+
+std::size_t getInternedNameCount()
+{
+  InternedNames& interned = getNameTable();
+  std::lock_guard<std::mutex> lock(interned.lock);
+  return interned.names.size();
+}
+}  // namespace collision_detection
@@ -0,0 +1,193 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/collision_detection/shape_hash.h>
+#include <geometric_shapes/shapes.h>
+#include <octomap/octomap.h>
+#include <algorithm>
+#include <cstring>
+
+namespace collision_detection
+{
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t h = mixHash(seed ^ (size * 0x9e3779b97f4a7c15ULL));
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    h = (h ^ mixHash(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+  if (i < size)
+  {
+    std::uint64_t word = 0;
+    std::memcpy(&word, bytes + i, size - i);
+    h = (h ^ mixHash(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+  return mixHash(h);
+}
+
+std::uint64_t hashDouble(double value)
+{
+  if (value == 0.0)
+    value = 0.0;  // -0.0 compares equal to 0.0 but has a different bit pattern
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return mixHash(bits);
+}
+
+std::uint64_t computeShapeHash(const shapes::Shape& shape)
+{
+  std::uint64_t h = mixHash(static_cast<std::uint64_t>(shape.type) + 1);
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      combineHash(h, hashDouble(static_cast<const shapes::Sphere&>(shape).radius));
+      break;
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      combineHash(h, hashDouble(cylinder.radius));
+      combineHash(h, hashDouble(cylinder.length));
+      break;
+    }
+    case shapes::CONE:
+    {
+      const auto& cone = static_cast<const shapes::Cone&>(shape);
+      combineHash(h, hashDouble(cone.radius));
+      combineHash(h, hashDouble(cone.length));
+      break;
+    }
+    case shapes::BOX:
+    {
+      const auto& box = static_cast<const shapes::Box&>(shape);
+      for (double size : box.size)
+        combineHash(h, hashDouble(size));
+      break;
+    }
+    case shapes::PLANE:
+    {
+      const auto& plane = static_cast<const shapes::Plane&>(shape);
+      combineHash(h, hashDouble(plane.a));
+      combineHash(h, hashDouble(plane.b));
+      combineHash(h, hashDouble(plane.c));
+      combineHash(h, hashDouble(plane.d));
+      break;
+    }
+    case shapes::MESH:
+    {
+      const auto& mesh = static_cast<const shapes::Mesh&>(shape);
+      combineHash(h, hashBytes(mesh.vertices, 3 * mesh.vertex_count * sizeof(double), mesh.vertex_count));
+      combineHash(h, hashBytes(mesh.triangles, 3 * mesh.triangle_count * sizeof(unsigned int), mesh.triangle_count));
+      break;
+    }
+    case shapes::OCTREE:
+    {
+      const auto& octree = static_cast<const shapes::OcTree&>(shape).octree;
+      if (!octree)
+        break;
+      // walking all leaves is too expensive for octrees updated at sensor rate, see World::rehashObject()
+      combineHash(h, hashDouble(octree->getResolution()));
+      combineHash(h, octree->size());
+      break;
+    }
+    default:
+      break;
+  }
+  return h;
+}
+
+bool equalShapes(const shapes::Shape& a, const shapes::Shape& b)
+{
+  if (&a == &b)
+    return true;
+  if (a.type != b.type)
+    return false;
+  switch (a.type)
+  {
+    case shapes::SPHERE:
+      return static_cast<const shapes::Sphere&>(a).radius == static_cast<const shapes::Sphere&>(b).radius;
+    case shapes::CYLINDER:
+    {
+      const auto& ca = static_cast<const shapes::Cylinder&>(a);
+      const auto& cb = static_cast<const shapes::Cylinder&>(b);
+      return ca.radius == cb.radius && ca.length == cb.length;
+    }
+    case shapes::CONE:
+    {
+      const auto& ca = static_cast<const shapes::Cone&>(a);
+      const auto& cb = static_cast<const shapes::Cone&>(b);
+      return ca.radius == cb.radius && ca.length == cb.length;
+    }
+    case shapes::BOX:
+    {
+      const auto& ba = static_cast<const shapes::Box&>(a);
+      const auto& bb = static_cast<const shapes::Box&>(b);
+      return ba.size[0] == bb.size[0] && ba.size[1] == bb.size[1] && ba.size[2] == bb.size[2];
+    }
+    case shapes::PLANE:
+    {
+      const auto& pa = static_cast<const shapes::Plane&>(a);
+      const auto& pb = static_cast<const shapes::Plane&>(b);
+      return pa.a == pb.a && pa.b == pb.b && pa.c == pb.c && pa.d == pb.d;
+    }
+    case shapes::MESH:
+    {
+      const auto& ma = static_cast<const shapes::Mesh&>(a);
+      const auto& mb = static_cast<const shapes::Mesh&>(b);
+      if (ma.vertex_count != mb.vertex_count || ma.triangle_count != mb.triangle_count)
+        return false;
+      // compare values rather than bytes, so that 0.0 and -0.0 are equal as in computeShapeHash()
+      return std::equal(ma.vertices, ma.vertices + 3 * ma.vertex_count, mb.vertices) &&
+             std::equal(ma.triangles, ma.triangles + 3 * ma.triangle_count, mb.triangles);
+    }
+    case shapes::OCTREE:
+      return static_cast<const shapes::OcTree&>(a).octree == static_cast<const shapes::OcTree&>(b).octree;
+    default:
+      return false;
+  }
+}
+
+std::uint64_t computePoseHash(const Eigen::Isometry3d& pose)
+{
+  std::uint64_t h = 0;
+  const Eigen::Matrix4d& m = pose.matrix();
+  for (int col = 0; col < 4; ++col)
+    for (int row = 0; row < 3; ++row)
+      combineHash(h, hashDouble(m(row, col)));
+  return h;
+}
+}  // namespace collision_detection
@@ -35,17 +35,17 @@
 /* Author: Acorn Pooley, Ioan Sucan */
 
 #include <moveit/collision_detection/world.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <geometric_shapes/check_isometry.h>
-#include <boost/algorithm/string/predicate.hpp>
 #include <ros/console.h>
 
 namespace collision_detection
 {
-World::World()
+World::World() : hash_(0)
 {
 }
 
-World::World(const World& other)
+World::World(const World& other) : hash_(other.hash_)
 {
   objects_ = other.objects_;
 }
@@ -62,6 +62,35 @@ inline void World::addToObjectInternal(const ObjectPtr& obj, const shapes::Shape
   obj->shapes_.push_back(shape);
   ASSERT_ISOMETRY(pose)  // unsanitized input, could contain a non-isometry
   obj->shape_poses_.push_back(pose);
+  obj->shape_hashes_.push_back(computeShapeHash(*shape));
+}
+
+void World::updateObjectHash(Object& obj)
+{
+  if (obj.shape_hashes_.size() != obj.shapes_.size())
+  {
+    obj.shape_hashes_.clear();
+    for (const shapes::ShapeConstPtr& shape : obj.shapes_)
+      obj.shape_hashes_.push_back(computeShapeHash(*shape));
+  }
+
+  std::uint64_t h = hashString(obj.id_);
+  for (std::size_t i = 0; i < obj.shapes_.size(); ++i)
+  {
+    combineHash(h, obj.shape_hashes_[i]);
+    combineHash(h, computePoseHash(obj.shape_poses_[i]));
+  }
+  for (const auto& subframe : obj.subframe_poses_)
+  {
+    combineHash(h, hashString(subframe.first));
+    combineHash(h, computePoseHash(subframe.second));
+  }
+  combineHash(h, obj.version_);
+
+  // objects are combined by (wrapping) addition, so a single object can be replaced in constant time
+  hash_ -= obj.hash_;
+  obj.hash_ = h;
+  hash_ += obj.hash_;
 }
 
 void World::addToObject(const std::string& id, const std::vector<shapes::ShapeConstPtr>& shapes,
@@ -90,6 +119,7 @@ void World::addToObject(const std::string& id, const std::vector<shapes::ShapeCo
 
   for (std::size_t i = 0; i < shapes.size(); ++i)
     addToObjectInternal(obj, shapes[i], poses[i]);
+  updateObjectHash(*obj);
 
   notify(obj, Action(action));
 }
@@ -107,6 +137,7 @@ void World::addToObject(const std::string& id, const shapes::ShapeConstPtr& shap
 
   ensureUnique(obj);
   addToObjectInternal(obj, shape, pose);
+  updateObjectHash(*obj);
 
   notify(obj, Action(action));
 }
@@ -147,16 +178,7 @@ bool World::knowsTransform(const std::string& name) const
     // only accept object name as frame if it is associated to a unique shape
     return !it->second->shape_poses_.empty();
   else  // Then objects' subframes
-  {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
-    {
-      // if "object name/" matches start of object_id, we found the matching object
-      if (boost::starts_with(name, object.first) && name[object.first.length()] == '/')
-        return object.second->subframe_poses_.find(name.substr(object.first.length() + 1)) !=
-               object.second->subframe_poses_.end();
-    }
-  }
-  return false;
+    return findSubframePose(name) != nullptr;
 }
 
 const Eigen::Isometry3d& World::getTransform(const std::string& name) const
@@ -181,16 +203,9 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
   }
   else  // Search within subframes
   {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
-    {
-      // if "object name/" matches start of object_id, we found the matching object
-      if (boost::starts_with(name, object.first) && name[object.first.length()] == '/')
-      {
-        auto it = object.second->subframe_poses_.find(name.substr(object.first.length() + 1));
-        if (it != object.second->subframe_poses_.end())
-          return it->second;
-      }
-    }
+    const Eigen::Isometry3d* pose = findSubframePose(name);
+    if (pose)
+      return *pose;
   }
 
   // we need a persisting isometry for the API
@@ -199,6 +214,21 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
   return IDENTITY_TRANSFORM;
 }
 
+const Eigen::Isometry3d* World::findSubframePose(const std::string& name) const
+{
+  // object ids may contain '/' themselves, so try every prefix that ends before a '/', shortest first
+  for (std::size_t pos = name.find('/'); pos != std::string::npos; pos = name.find('/', pos + 1))
+  {
+    std::map<std::string, ObjectPtr>::const_iterator it = objects_.find(name.substr(0, pos));
+    if (it == objects_.end())
+      continue;
+    auto jt = it->second->subframe_poses_.find(name.substr(pos + 1));
+    if (jt != it->second->subframe_poses_.end())
+      return &jt->second;
+  }
+  return nullptr;
+}
+
 bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape,
                               const Eigen::Isometry3d& pose)
 {
@@ -212,6 +242,7 @@ bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeC
         ensureUnique(it->second);
         ASSERT_ISOMETRY(pose)  // unsanitized input, could contain a non-isometry
         it->second->shape_poses_[i] = pose;
+        updateObjectHash(*it->second);
 
         notify(it->second, MOVE_SHAPE);
         return true;
@@ -220,6 +251,22 @@ bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeC
   return false;
 }
 
+bool World::moveShapesInObject(const std::string& object_id, const EigenSTL::vector_Isometry3d& poses)
+{
+  auto it = objects_.find(object_id);
+  if (it == objects_.end() || it->second->shapes_.size() != poses.size())
+    return false;
+  ensureUnique(it->second);
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    ASSERT_ISOMETRY(poses[i])  // unsanitized input, could contain a non-isometry
+    it->second->shape_poses_[i] = poses[i];
+  }
+  updateObjectHash(*it->second);
+  notify(it->second, MOVE_SHAPE);
+  return true;
+}
+
 bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& transform)
 {
   auto it = objects_.find(object_id);
@@ -233,6 +280,7 @@ bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& tr
     ASSERT_ISOMETRY(transform)  // unsanitized input, could contain a non-isometry
     it->second->shape_poses_[i] = transform * it->second->shape_poses_[i];
   }
+  updateObjectHash(*it->second);
   notify(it->second, MOVE_SHAPE);
   return true;
 }
@@ -249,14 +297,18 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
         ensureUnique(it->second);
         it->second->shapes_.erase(it->second->shapes_.begin() + i);
         it->second->shape_poses_.erase(it->second->shape_poses_.begin() + i);
+        if (i < it->second->shape_hashes_.size())
+          it->second->shape_hashes_.erase(it->second->shape_hashes_.begin() + i);
 
         if (it->second->shapes_.empty())
         {
+          hash_ -= it->second->hash_;
           notify(it->second, DESTROY);
           objects_.erase(it);
         }
         else
         {
+          updateObjectHash(*it->second);
           notify(it->second, REMOVE_SHAPE);
         }
         return true;
@@ -270,6 +322,7 @@ bool World::removeObject(const std::string& object_id)
   auto it = objects_.find(object_id);
   if (it != objects_.end())
   {
+    hash_ -= it->second->hash_;
     notify(it->second, DESTROY);
     objects_.erase(it);
     return true;
@@ -281,6 +334,19 @@ void World::clearObjects()
 {
   notifyAll(DESTROY);
   objects_.clear();
+  hash_ = 0;
+}
+
+bool World::rehashObject(const std::string& object_id, std::uint64_t version)
+{
+  auto it = objects_.find(object_id);
+  if (it == objects_.end())
+    return false;
+  ensureUnique(it->second);
+  it->second->version_ = version;
+  it->second->shape_hashes_.clear();
+  updateObjectHash(*it->second);
+  return true;
 }
 
 bool World::setSubframesOfObject(const std::string& object_id, const moveit::core::FixedTransformsMap& subframe_poses)
@@ -294,7 +360,9 @@ bool World::setSubframesOfObject(const std::string& object_id, const moveit::cor
   {
     ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
   }
+  ensureUnique(obj_pair->second);
   obj_pair->second->subframe_poses_ = subframe_poses;
+  updateObjectHash(*obj_pair->second);
   return true;
 }
 
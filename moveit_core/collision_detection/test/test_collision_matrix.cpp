@@ -0,0 +1,150 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/collision_detection/collision_matrix.h>
+#include <thread>
+
+using namespace collision_detection;
+
+namespace
+{
+void expectSameLookup(const AllowedCollisionMatrix& acm, const std::vector<std::string>& names)
+{
+  CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  for (const std::string& name1 : names)
+    for (const std::string& name2 : names)
+    {
+      AllowedCollision::Type expected, actual;
+      const bool expected_found = acm.getAllowedCollision(name1, name2, expected);
+      const bool found = compiled->getAllowedCollision(internName(name1), internName(name2), actual);
+      ASSERT_EQ(expected_found, found) << name1 << " - " << name2;
+      if (found)
+      {
+        EXPECT_EQ(expected, actual) << name1 << " - " << name2;
+      }
+    }
+}
+}  // namespace
+
+TEST(AllowedCollisionMatrix, CompiledMatchesLookup)
+{
+  AllowedCollisionMatrix acm({ "a", "b", "c" }, false);
+  acm.setEntry("a", "b", true);
+  acm.setEntry("b", "d", DecideContactFn([](Contact& /*contact*/) { return true; }));
+  acm.setDefaultEntry("e", true);
+
+  // "unknown" is not mentioned in the matrix, so only default entries apply to it
+  const std::vector<std::string> names = { "a", "b", "c", "d", "e", "unknown" };
+  expectSameLookup(acm, names);
+
+  // defaults take precedence over entries, NEVER over everything else
+  acm.setDefaultEntry("a", false);
+  acm.setDefaultEntry("c", DecideContactFn([](Contact& /*contact*/) { return false; }));
+  expectSameLookup(acm, names);
+}
+
+TEST(AllowedCollisionMatrix, CompiledIsRebuiltAfterModification)
+{
+  AllowedCollisionMatrix acm({ "a", "b" }, false);
+  CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  EXPECT_EQ(compiled, acm.getCompiled());
+  EXPECT_EQ(compiled->getSize(), 2u);
+
+  acm.setEntry("a", "b", true);
+  CompiledAllowedCollisionMatrixConstPtr recompiled = acm.getCompiled();
+  EXPECT_NE(compiled, recompiled);
+
+  AllowedCollision::Type type;
+  ASSERT_TRUE(compiled->getAllowedCollision(internName("a"), internName("b"), type));
+  EXPECT_EQ(type, AllowedCollision::NEVER);
+  ASSERT_TRUE(recompiled->getAllowedCollision(internName("a"), internName("b"), type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+
+  acm.removeEntry("a", "b");
+  EXPECT_FALSE(acm.getCompiled()->getAllowedCollision(internName("a"), internName("b"), type));
+
+  // copies share the compiled form until either is modified
+  AllowedCollisionMatrix copy(acm);
+  EXPECT_EQ(acm.getCompiled(), copy.getCompiled());
+  AllowedCollisionMatrix assigned;
+  assigned = acm;
+  EXPECT_EQ(acm.getCompiled(), assigned.getCompiled());
+  assigned.setEntry("a", "b", true);
+  EXPECT_NE(acm.getCompiled(), assigned.getCompiled());
+}
+
+TEST(AllowedCollisionMatrix, CopyWhileCompiling)
+{
+  AllowedCollisionMatrix acm({ "a", "b", "c" }, false);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.emplace_back([&acm, i]() {
+      for (int j = 0; j < 100; ++j)
+      {
+        if (i % 2)
+          acm.getCompiled();
+        else
+        {
+          AllowedCollisionMatrix copy(acm);
+          EXPECT_EQ(copy.getSize(), 3u);
+        }
+      }
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+  EXPECT_EQ(AllowedCollisionMatrix(acm).getCompiled(), acm.getCompiled());
+}
+
+TEST(AllowedCollisionMatrix, InternedNames)
+{
+  const std::uint32_t id = internName("interned_names_test");
+  EXPECT_EQ(id, internName("interned_names_test"));
+  EXPECT_NE(id, internName("interned_names_test_other"));
+  EXPECT_EQ(getInternedName(id), "interned_names_test");
+  EXPECT_LT(id, getInternedNameCount());
+
+  const std::uint32_t other = internName("interned_names_test_other");
+  const std::vector<const std::string*> names = getInternedNames({ other, id, other });
+  ASSERT_EQ(names.size(), 3u);
+  EXPECT_EQ(*names[0], "interned_names_test_other");
+  EXPECT_EQ(*names[1], "interned_names_test");
+  EXPECT_EQ(names[2], names[0]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
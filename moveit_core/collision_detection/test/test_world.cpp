@@ -36,8 +36,11 @@
 
 #include <gtest/gtest.h>
 #include <moveit/collision_detection/world.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <geometric_shapes/shapes.h>
 #include <boost/bind.hpp>
+#include <algorithm>
+#include <memory>
 
 TEST(World, AddRemoveShape)
 {
@@ -365,6 +368,118 @@ TEST(World, TrackChanges)
   EXPECT_EQ(4, ta3.cnt_);
 }
 
+TEST(World, Hash)
+{
+  collision_detection::World world1, world2;
+  EXPECT_EQ(world1.getHash(), world2.getHash());
+
+  shapes::ShapePtr ball(new shapes::Sphere(1.0));
+  shapes::ShapePtr box(new shapes::Box(1, 2, 3));
+  const Eigen::Isometry3d ball_pose(Eigen::Translation3d(0, 0, 1));
+  const Eigen::Isometry3d box_pose(Eigen::Translation3d(1, 0, 0));
+
+  // the same content added in a different order, with equal but distinct shapes, gives the same hash
+  world1.addToObject("ball", ball, ball_pose);
+  world1.addToObject("box", box, box_pose);
+  world2.addToObject("box", shapes::ShapePtr(box->clone()), box_pose);
+  EXPECT_NE(world1.getHash(), world2.getHash());
+  world2.addToObject("ball", shapes::ShapePtr(new shapes::Sphere(1.0)), ball_pose);
+  EXPECT_EQ(world1.getHash(), world2.getHash());
+
+  // a copy shares the hash, but changes to the copy do not affect the original
+  collision_detection::World world3(world1);
+  EXPECT_EQ(world1.getHash(), world3.getHash());
+  EXPECT_TRUE(world3.moveShapeInObject("ball", ball, Eigen::Isometry3d(Eigen::Translation3d(0, 0, 2))));
+  EXPECT_NE(world1.getHash(), world3.getHash());
+  EXPECT_EQ(world1.getHash(), world2.getHash());
+
+  // moving back restores the hash
+  EXPECT_TRUE(world3.moveShapeInObject("ball", ball, ball_pose));
+  EXPECT_EQ(world1.getHash(), world3.getHash());
+
+  // geometry and subframes are part of the hash
+  const std::uint64_t before_subframes = world3.getHash();
+  moveit::core::FixedTransformsMap subframes;
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.5));
+  EXPECT_TRUE(world3.setSubframesOfObject("ball", subframes));
+  EXPECT_NE(before_subframes, world3.getHash());
+  EXPECT_EQ(world1.getHash(), world2.getHash());
+
+  world3.clearObjects();
+  EXPECT_EQ(collision_detection::World().getHash(), world3.getHash());
+  world3.addToObject("ball", shapes::ShapePtr(new shapes::Sphere(1.1)), ball_pose);
+  world3.addToObject("box", box, box_pose);
+  EXPECT_NE(world1.getHash(), world3.getHash());
+
+  // removing an object restores the hash of the remaining content
+  world1.removeObject("ball");
+  collision_detection::World world4;
+  world4.addToObject("box", box, box_pose);
+  EXPECT_EQ(world1.getHash(), world4.getHash());
+  world1.removeShapeFromObject("box", box);
+  EXPECT_EQ(collision_detection::World().getHash(), world1.getHash());
+}
+
+TEST(World, EqualShapes)
+{
+  using collision_detection::equalShapes;
+  EXPECT_TRUE(equalShapes(shapes::Box(1, 2, 3), shapes::Box(1, 2, 3)));
+  EXPECT_FALSE(equalShapes(shapes::Box(1, 2, 3), shapes::Box(1, 2, 3.001)));
+  EXPECT_FALSE(equalShapes(shapes::Sphere(1), shapes::Cylinder(1, 1)));
+  EXPECT_TRUE(equalShapes(shapes::Cylinder(1, 2), shapes::Cylinder(1, 2)));
+  EXPECT_FALSE(equalShapes(shapes::Cylinder(1, 2), shapes::Cylinder(2, 1)));
+
+  // scaling or padding changes the geometry
+  shapes::Sphere sphere(1);
+  sphere.scaleAndPadd(1.0, 0.1);
+  EXPECT_FALSE(equalShapes(sphere, shapes::Sphere(1)));
+
+  // meshes of the same size are compared by content
+  shapes::Mesh mesh(3, 1);
+  const double vertices[] = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+  std::copy(vertices, vertices + 9, mesh.vertices);
+  mesh.triangles[0] = 0;
+  mesh.triangles[1] = 1;
+  mesh.triangles[2] = 2;
+  std::unique_ptr<shapes::Mesh> other(mesh.clone());
+  EXPECT_TRUE(equalShapes(mesh, *other));
+  EXPECT_EQ(collision_detection::computeShapeHash(mesh), collision_detection::computeShapeHash(*other));
+  other->vertices[4] = 2;
+  EXPECT_FALSE(equalShapes(mesh, *other));
+  other->vertices[4] = 0;
+  std::swap(other->triangles[1], other->triangles[2]);
+  EXPECT_FALSE(equalShapes(mesh, *other));
+}
+
+TEST(World, Subframes)
+{
+  collision_detection::World world;
+  shapes::ShapePtr box(new shapes::Box(1, 2, 3));
+  const Eigen::Isometry3d pose(Eigen::Translation3d(1, 0, 0));
+  moveit::core::FixedTransformsMap subframes;
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.5));
+
+  // "tool" is a prefix of "tool/holder", and both have a subframe "tip"
+  world.addToObject("tool", box, pose);
+  world.addToObject("tool/holder", box, pose);
+  EXPECT_TRUE(world.setSubframesOfObject("tool", subframes));
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.7));
+  EXPECT_TRUE(world.setSubframesOfObject("tool/holder", subframes));
+
+  bool found = false;
+  EXPECT_TRUE(world.knowsTransform("tool/tip"));
+  EXPECT_TRUE(world.getTransform("tool/tip", found).isApprox(Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.5))));
+  EXPECT_TRUE(found);
+  EXPECT_TRUE(world.knowsTransform("tool/holder/tip"));
+  EXPECT_TRUE(world.getTransform("tool/holder/tip").isApprox(Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.7))));
+  EXPECT_TRUE(world.knowsTransform("tool/holder"));
+
+  EXPECT_FALSE(world.knowsTransform("tool/base"));
+  EXPECT_FALSE(world.knowsTransform("holder/tip"));
+  world.getTransform("tool/holder/base", found);
+  EXPECT_FALSE(found);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -67,6 +67,7 @@ struct CollisionGeometryData
     : type(BodyTypes::ROBOT_LINK), shape_index(index)
   {
     ptr.link = link;
+    name_id = internName(getID());
   }
 
   /** \brief Constructor for a new collision geometry object which is attached to the robot. */
@@ -74,12 +75,14 @@ struct CollisionGeometryData
     : type(BodyTypes::ROBOT_ATTACHED), shape_index(index)
   {
     ptr.ab = ab;
+    name_id = internName(getID());
   }
 
   /** \brief Constructor for a new world collision geometry. */
   CollisionGeometryData(const World::Object* obj, int index) : type(BodyTypes::WORLD_OBJECT), shape_index(index)
   {
     ptr.obj = obj;
+    name_id = internName(getID());
   }
 
   /** \brief Returns the name which is saved in the member pointed to in \e ptr. */
@@ -135,6 +138,10 @@ struct CollisionGeometryData
     const World::Object* obj;
     const void* raw;
   } ptr;
+
+  /** \brief The interned id of the name returned by getID(), used for lookups in the compiled allowed collision
+   * matrix. */
+  std::uint32_t name_id;
 };
 
 /** \brief Data structure which is passed to the collision callback function of the collision manager. */
@@ -145,7 +152,12 @@ struct CollisionData
   }
 
   CollisionData(const CollisionRequest* req, CollisionResult* res, const AllowedCollisionMatrix* acm)
-    : req_(req), active_components_only_(nullptr), res_(res), acm_(acm), done_(false)
+    : req_(req)
+    , active_components_only_(nullptr)
+    , res_(res)
+    , acm_(acm)
+    , compiled_acm_(acm ? acm->getCompiled() : nullptr)
+    , done_(false)
   {
   }
 
@@ -171,6 +183,9 @@ struct CollisionData
   /** \brief The user-specified collision matrix (may be NULL). */
   const AllowedCollisionMatrix* acm_;
 
+  /** \brief The compiled form of \e acm_, used for lookups by interned name id (NULL if \e acm_ is NULL). */
+  CompiledAllowedCollisionMatrixConstPtr compiled_acm_;
+
   /** \brief Flag indicating whether collision checking is complete. */
   bool done_;
 };
@@ -178,7 +193,8 @@ struct CollisionData
 /** \brief Data structure which is passed to the distance callback function of the collision manager. */
 struct DistanceData
 {
-  DistanceData(const DistanceRequest* req, DistanceResult* res) : req(req), res(res), done(false)
+  DistanceData(const DistanceRequest* req, DistanceResult* res)
+    : req(req), res(res), compiled_acm(req->acm ? req->acm->getCompiled() : nullptr), done(false)
   {
   }
   ~DistanceData()
@@ -191,6 +207,9 @@ struct DistanceData
   /** \brief Distance query results information. */
   DistanceResult* res;
 
+  /** \brief The compiled form of the request's collision matrix (NULL if the request has none). */
+  CompiledAllowedCollisionMatrixConstPtr compiled_acm;
+
   /** \brief Indicates if distance query is finished. */
   bool done;
 };
@@ -299,7 +318,10 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
  *  A world object always consists only of a single shape, therefore we don't need the \e shape_index. */
 FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape, const World::Object* obj);
 
-/** \brief Create new scaled and / or padded FCLGeometry object out of robot link model. */
+/** \brief Create new scaled and / or padded FCLGeometry object out of robot link model.
+ *
+ *  The result is shared through a process-wide cache keyed by the shape's content, \e scale and \e padding, so all
+ *  environments of a robot reuse the same geometry (and mesh BVHs) as long as one of them holds it. */
 FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape, double scale, double padding,
                                             const moveit::core::LinkModel* link, int shape_index);
 
@@ -349,6 +371,20 @@ inline void fcl2contact(const fcl::Contactd& fc, Contact& c)
   c.body_type_2 = cgd2->type;
 }
 
+/** \brief Transforms an FCL contact into a MoveIt contact that refers to bodies by interned name id. */
+inline void fcl2contact(const fcl::Contactd& fc, IndexedContact& c)
+{
+  c.pos = Eigen::Vector3d(fc.pos[0], fc.pos[1], fc.pos[2]);
+  c.normal = Eigen::Vector3d(fc.normal[0], fc.normal[1], fc.normal[2]);
+  c.depth = fc.penetration_depth;
+  const CollisionGeometryData* cgd1 = static_cast<const CollisionGeometryData*>(fc.o1->getUserData());
+  c.body_id_1 = cgd1->name_id;
+  c.body_type_1 = cgd1->type;
+  const CollisionGeometryData* cgd2 = static_cast<const CollisionGeometryData*>(fc.o2->getUserData());
+  c.body_id_2 = cgd2->name_id;
+  c.body_type_2 = cgd2->type;
+}
+
 /** \brief Transforms the FCL internal representation to the MoveIt \e CostSource data structure. */
 inline void fcl2costsource(const fcl::CostSourced& fcs, CostSource& cs)
 {
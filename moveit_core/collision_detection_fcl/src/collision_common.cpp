@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan, Jia Pan */
 
 #include <moveit/collision_detection_fcl/collision_common.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <geometric_shapes/shapes.h>
 #include <moveit/collision_detection_fcl/fcl_compat.h>
 
@@ -48,7 +49,12 @@
 #endif
 
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace collision_detection
 {
@@ -85,10 +91,10 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
   // use the collision matrix (if any) to avoid certain collision checks
   DecideContactFn dcf;
   bool always_allow_collision = false;
-  if (cdata->acm_)
+  if (cdata->compiled_acm_)
   {
     AllowedCollision::Type type;
-    bool found = cdata->acm_->getAllowedCollision(cd1->getID(), cd2->getID(), type);
+    bool found = cdata->compiled_acm_->getAllowedCollision(cd1->name_id, cd2->name_id, type);
     if (found)
     {
       // if we have an entry in the collision matrix, we read it
@@ -158,7 +164,9 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
     if (cdata->res_->contact_count < cdata->req_->max_contacts)
     {
       std::size_t have;
-      if (cd1->getID() < cd2->getID())
+      if (cdata->req_->indexed_contacts)
+        have = cdata->res_->indexed_contacts.getPairContactCount(cd1->name_id, cd2->name_id);
+      else if (cd1->getID() < cd2->getID())
       {
         std::pair<std::string, std::string> cp(cd1->getID(), cd2->getID());
         have = cdata->res_->contacts.find(cp) != cdata->res_->contacts.end() ? cdata->res_->contacts[cp].size() : 0;
@@ -192,6 +200,7 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
                        "These contacts will be evaluated to check if they are accepted or not",
                        num_contacts, cd1->getID().c_str(), cd2->getID().c_str());
       Contact c;
+      IndexedContact indexed;
       const std::pair<std::string, std::string>& pc = cd1->getID() < cd2->getID() ?
                                                           std::make_pair(cd1->getID(), cd2->getID()) :
                                                           std::make_pair(cd2->getID(), cd1->getID());
@@ -205,7 +214,13 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
           if (want_contact_count > 0)
           {
             --want_contact_count;
-            cdata->res_->contacts[pc].push_back(c);
+            if (cdata->req_->indexed_contacts)
+            {
+              fcl2contact(col_result.getContact(i), indexed);
+              cdata->res_->indexed_contacts.add(indexed);
+            }
+            else
+              cdata->res_->contacts[pc].push_back(c);
             cdata->res_->contact_count++;
             if (cdata->req_->verbose)
               ROS_INFO_NAMED("collision_detection.fcl",
@@ -274,17 +289,29 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
                          num_contacts_initial, cd1->getID().c_str(), cd1->getTypeString().c_str(), cd2->getID().c_str(),
                          cd2->getTypeString().c_str(), num_contacts);
 
-        const std::pair<std::string, std::string>& pc = cd1->getID() < cd2->getID() ?
-                                                            std::make_pair(cd1->getID(), cd2->getID()) :
-                                                            std::make_pair(cd2->getID(), cd1->getID());
         cdata->res_->collision = true;
-        for (int i = 0; i < num_contacts; ++i)
+        if (cdata->req_->indexed_contacts)
+        {
+          IndexedContact c;
+          for (int i = 0; i < num_contacts; ++i)
+          {
+            fcl2contact(col_result.getContact(i), c);
+            cdata->res_->indexed_contacts.add(c);
+          }
+        }
+        else
         {
-          Contact c;
-          fcl2contact(col_result.getContact(i), c);
-          cdata->res_->contacts[pc].push_back(c);
-          cdata->res_->contact_count++;
+          const std::pair<std::string, std::string>& pc = cd1->getID() < cd2->getID() ?
+                                                              std::make_pair(cd1->getID(), cd2->getID()) :
+                                                              std::make_pair(cd2->getID(), cd1->getID());
+          for (int i = 0; i < num_contacts; ++i)
+          {
+            Contact c;
+            fcl2contact(col_result.getContact(i), c);
+            cdata->res_->contacts[pc].push_back(c);
+          }
         }
+        cdata->res_->contact_count += num_contacts;
       }
 
       if (enable_cost)
@@ -440,11 +467,11 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
 
   // use the collision matrix (if any) to avoid certain distance checks
   bool always_allow_collision = false;
-  if (cdata->req->acm)
+  if (cdata->compiled_acm)
   {
     AllowedCollision::Type type;
 
-    bool found = cdata->req->acm->getAllowedCollision(cd1->getID(), cd2->getID(), type);
+    bool found = cdata->compiled_acm->getAllowedCollision(cd1->name_id, cd2->name_id, type);
     if (found)
     {
       // if we have an entry in the collision matrix, we read it
@@ -898,10 +925,93 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
   }
 }
 
+namespace
+{
+/** \brief Process-wide cache of the collision geometry of robot links, shared by all CollisionEnvFCL instances.
+ *
+ *  Unlike FCLShapeCache, entries are found by the content of the shape together with scale and padding, so padded or
+ *  scaled copies of a link shape are found as well. The hash of these only selects the entry, a hit is confirmed by
+ *  comparing the shapes. Entries are weak, so a geometry lives only as long as some environment uses it. */
+class LinkGeometryCache
+{
+public:
+  FCLGeometryConstPtr find(std::uint64_t key, const shapes::ShapeConstPtr& shape, double scale, double padding,
+                           const moveit::core::LinkModel* link, int shape_index) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end() || it->second.scale != scale || it->second.padding != padding)
+      return FCLGeometryConstPtr();
+    FCLGeometryConstPtr geometry = it->second.geometry.lock();
+    shapes::ShapeConstPtr cached_shape = it->second.shape.lock();
+    if (!geometry || !cached_shape || (cached_shape != shape && !equalShapes(*cached_shape, *shape)))
+      return FCLGeometryConstPtr();
+    // the thread-local caches may have retargeted an unused geometry to other data since it was inserted
+    if (geometry->collision_geometry_data_->type == BodyTypes::ROBOT_LINK &&
+        geometry->collision_geometry_data_->ptr.link == link &&
+        geometry->collision_geometry_data_->shape_index == shape_index)
+      return geometry;
+    return FCLGeometryConstPtr();
+  }
+
+  void insert(std::uint64_t key, const shapes::ShapeConstPtr& shape, double scale, double padding,
+              const FCLGeometryConstPtr& geometry)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // drop the entries of released geometries whenever the map doubled in size, so insertion stays amortized O(1)
+    if (map_.size() >= purge_size_)
+    {
+      for (auto it = map_.begin(); it != map_.end();)
+        it = it->second.geometry.expired() ? map_.erase(it) : std::next(it);
+      purge_size_ = std::max<std::size_t>(2 * map_.size(), 64);
+    }
+    Entry& entry = map_[key];
+    entry.shape = shape;
+    entry.scale = scale;
+    entry.padding = padding;
+    entry.geometry = geometry;
+  }
+
+private:
+  struct Entry
+  {
+    std::weak_ptr<const shapes::Shape> shape;
+    double scale;
+    double padding;
+    std::weak_ptr<const FCLGeometry> geometry;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::uint64_t, Entry> map_;
+  std::size_t purge_size_ = 64;
+};
+
+LinkGeometryCache& getLinkGeometryCache()
+{
+  static LinkGeometryCache cache;
+  return cache;
+}
+}  // namespace
+
 FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape, double scale, double padding,
                                             const moveit::core::LinkModel* link, int shape_index)
 {
-  return createCollisionGeometry<fcl::OBBRSSd, moveit::core::LinkModel>(shape, scale, padding, link, shape_index);
+  // the geometry of a link is the same in every environment using the same scale and padding
+  std::uint64_t key = computeShapeHash(*shape);
+  combineHash(key, hashDouble(scale));
+  combineHash(key, hashDouble(padding));
+  combineHash(key, reinterpret_cast<std::uintptr_t>(link));
+  combineHash(key, static_cast<std::uint64_t>(shape_index));
+
+  LinkGeometryCache& cache = getLinkGeometryCache();
+  FCLGeometryConstPtr geometry = cache.find(key, shape, scale, padding, link, shape_index);
+  if (!geometry)
+  {
+    geometry = createCollisionGeometry<fcl::OBBRSSd, moveit::core::LinkModel>(shape, scale, padding, link, shape_index);
+    if (geometry)
+      cache.insert(key, shape, scale, padding, geometry);
+  }
+  return geometry;
 }
 
 FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape, double scale, double padding,
@@ -190,6 +190,44 @@ TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_2)
   res.clear();
 }
 
+/** \brief Contacts stored by interned body id match the contacts stored by name. */
+TEST_F(CollisionDetectionEnvTest, IndexedContacts)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  req.max_contacts = 10;
+  req.contacts = true;
+
+  Eigen::Isometry3d pos1 = Eigen::Isometry3d::Identity();
+  pos1.translation().z() = 0.3;
+  c_env_->getWorld()->addToObject("box", shapes::ShapeConstPtr(new shapes::Box(.4, .4, .4)), pos1);
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  EXPECT_TRUE(res.indexed_contacts.empty());
+
+  collision_detection::CollisionResult indexed_res;
+  req.indexed_contacts = true;
+  c_env_->checkRobotCollision(req, indexed_res, *robot_state_, *acm_);
+  ASSERT_TRUE(indexed_res.collision);
+  EXPECT_TRUE(indexed_res.contacts.empty());
+  EXPECT_EQ(res.contact_count, indexed_res.contact_count);
+  EXPECT_EQ(indexed_res.indexed_contacts.getContacts().size(), indexed_res.contact_count);
+
+  collision_detection::CollisionResult::ContactMap converted;
+  indexed_res.indexed_contacts.getContactMap(converted);
+  ASSERT_EQ(res.contacts.size(), converted.size());
+  for (const auto& contacts : res.contacts)
+  {
+    ASSERT_EQ(converted.count(contacts.first), 1u);
+    EXPECT_EQ(contacts.second.size(), converted[contacts.first].size());
+  }
+
+  // clearing keeps the capacity for the next query
+  indexed_res.clear();
+  EXPECT_TRUE(indexed_res.indexed_contacts.empty());
+  EXPECT_EQ(indexed_res.indexed_contacts.getPairCount(), 0u);
+}
+
 /** \brief Tests the padding through expanding the link geometry in such a way that a collision occurs. */
 TEST_F(CollisionDetectionEnvTest, PaddingTest)
 {
@@ -222,6 +260,46 @@ TEST_F(CollisionDetectionEnvTest, PaddingTest)
   ASSERT_FALSE(res.collision);
 }
 
+/** \brief Tests that padded link geometry is shared between environments instead of being rebuilt. */
+TEST_F(CollisionDetectionEnvTest, SharedLinkGeometry)
+{
+  const moveit::core::LinkModel* link = robot_model_->getLinkModel("panda_link1");
+  ASSERT_FALSE(link->getShapes().empty());
+  const shapes::ShapeConstPtr& shape = link->getShapes()[0];
+
+  collision_detection::FCLGeometryConstPtr padded =
+      collision_detection::createCollisionGeometry(shape, 1.0, 0.02, link, 0);
+  ASSERT_TRUE(padded);
+  EXPECT_EQ(collision_detection::createCollisionGeometry(shape, 1.0, 0.02, link, 0), padded);
+
+  // the cache is keyed by content, so an equal copy of the shape finds the same geometry
+  shapes::ShapeConstPtr copy(shape->clone());
+  EXPECT_EQ(collision_detection::createCollisionGeometry(copy, 1.0, 0.02, link, 0), padded);
+
+  // but not for different geometry, padding, scale, shape index or link
+  EXPECT_NE(collision_detection::createCollisionGeometry(std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), 1.0,
+                                                         0.02, link, 0),
+            padded);
+  EXPECT_NE(collision_detection::createCollisionGeometry(shape, 1.0, 0.03, link, 0), padded);
+  EXPECT_NE(collision_detection::createCollisionGeometry(shape, 1.1, 0.02, link, 0), padded);
+  EXPECT_NE(collision_detection::createCollisionGeometry(shape, 1.0, 0.02, link, 1), padded);
+  collision_detection::FCLGeometryConstPtr other =
+      collision_detection::createCollisionGeometry(shape, 1.0, 0.02, robot_model_->getLinkModel("panda_link2"), 0);
+  ASSERT_TRUE(other);
+  EXPECT_NE(other, padded);
+  EXPECT_EQ(other->collision_geometry_data_->ptr.link, robot_model_->getLinkModel("panda_link2"));
+
+  // environments with the same padding still give the same results
+  collision_detection::CollisionEnvFCL env1(robot_model_, 0.02), env2(robot_model_, 0.02);
+  collision_detection::CollisionRequest req;
+  req.distance = true;
+  collision_detection::CollisionResult res1, res2;
+  env1.checkSelfCollision(req, res1, *robot_state_, *acm_);
+  env2.checkSelfCollision(req, res2, *robot_state_, *acm_);
+  EXPECT_EQ(res1.collision, res2.collision);
+  EXPECT_DOUBLE_EQ(res1.distance, res2.distance);
+}
+
 /** \brief Continuous self collision checks of the robot.
  *
  *  Functionality not supported yet. */
@@ -322,6 +322,19 @@ public:
     return joint_tolerance_below_;
   }
 
+  /**
+   * \brief Evaluate the constraint for many values of the constrained variable at once
+   *
+   * Gives the same results as decide() for each value, but works on contiguous arrays that the
+   * compiler can vectorize. Results are accumulated into the existing contents of the outputs.
+   *
+   * @param [in] values The values of the constrained variable, one per state
+   * @param [in,out] satisfied Per-state flags, cleared for states that violate the constraint
+   * @param [in,out] distances Per-state distances, the weighted distance of each state is added
+   */
+  void decide(const Eigen::Ref<const Eigen::ArrayXd>& values, Eigen::Array<bool, Eigen::Dynamic, 1>& satisfied,
+              Eigen::ArrayXd& distances) const;
+
 protected:
   const moveit::core::JointModel* joint_model_; /**< \brief The joint from the kinematic model for this constraint */
   bool joint_is_continuous_;                    /**< \brief Whether or not the joint is continuous */
@@ -836,8 +849,40 @@ protected:
    */
   bool decideContact(const collision_detection::Contact& contact) const;
 
+  /**
+   * \brief Create a trimesh of the visibility cone for the given sensor and target poses
+   *
+   * @param [in] sp The sensor pose in the model frame
+   * @param [in] tp The target pose in the model frame
+   * @param [in] frame_inv The inverse of the pose of the frame the vertices are expressed in
+   *
+   * @return The newly allocated mesh
+   */
+  shapes::Mesh* createVisibilityCone(const Eigen::Isometry3d& sp, const Eigen::Isometry3d& tp,
+                                     const Eigen::Isometry3d& frame_inv) const;
+
+  /**
+   * \brief Conservative test whether any robot link the cone must not touch is near the cone
+   *
+   * Compares the axis-aligned bounding box of the cone with the axis-aligned bounding boxes of the links.
+   * If this returns false, the cone is guaranteed to be free of disallowed contacts.
+   */
+  bool coneMayTouchRobot(const moveit::core::RobotState& state, const Eigen::Isometry3d& sp,
+                         const Eigen::Isometry3d& tp) const;
+
+  /**
+   * \brief Place the visibility cone in the collision world of \e collision_env_
+   *
+   * The cone mesh is expressed in the sensor frame. If the target did not move relative to the sensor since
+   * the last call, the cached mesh is only re-posed and its collision geometry is reused.
+   */
+  void updateConeObject(const Eigen::Isometry3d& sp, const Eigen::Isometry3d& tp) const;
+
   collision_detection::CollisionEnvPtr collision_env_; /**< \brief A copy of the collision robot maintained for
                                                               collision checking the cone against robot links */
+  /** \brief Lets decideContact() decide on contacts with the cone. Built once by the constructor, so its compiled form
+   * is reused by every call to decide() */
+  collision_detection::AllowedCollisionMatrix cone_acm_;
   bool mobile_sensor_frame_;      /**< \brief True if the sensor is a non-fixed frame relative to the transform frame */
   bool mobile_target_frame_;      /**< \brief True if the target is a non-fixed frame relative to the transform frame */
   std::string target_frame_id_;   /**< \brief The target frame id */
@@ -850,6 +895,13 @@ protected:
   double target_radius_;             /**< \brief Storage for the target radius */
   double max_view_angle_;            /**< \brief Storage for the max view angle */
   double max_range_angle_;           /**< \brief Storage for the max range angle */
+
+  /** \brief Triangle indices of the cone mesh, these only depend on cone_sides_ */
+  std::vector<unsigned int> cone_triangles_;
+  /** \brief The cone mesh currently in the world of collision_env_, expressed in the sensor frame */
+  mutable shapes::ShapeConstPtr cone_shape_;
+  /** \brief The target pose relative to the sensor that cone_shape_ was built for */
+  mutable Eigen::Isometry3d cone_target_in_sensor_;
 };
 
 MOVEIT_CLASS_FORWARD(KinematicConstraintSet);  // Defines KinematicConstraintSetPtr, ConstPtr, WeakPtr... etc
@@ -967,6 +1019,27 @@ public:
   ConstraintEvaluationResult decide(const moveit::core::RobotState& state,
                                     std::vector<ConstraintEvaluationResult>& results, bool verbose = false) const;
 
+  /**
+   * \brief Determines for many states at once whether all constraints are satisfied
+   *
+   * Each column of \e positions holds the variable positions of one state, in the order of
+   * RobotState::getVariablePositions(). For each state, the result is the same as that of decide(),
+   * up to the order in which the distances are summed.
+   *
+   * Joint constraints are evaluated for all states at once. For the other constraints, only the
+   * joints that move a constrained link or a mobile reference frame are copied into a scratch state,
+   * so only the link transforms below those joints are recomputed. Visibility constraints check the
+   * whole robot for collisions, so they need all joints.
+   *
+   * @param [in] reference_state Provides everything not contained in \e positions, e.g. attached bodies.
+   * Its transforms need to be up to date.
+   * @param [in] positions The variable positions, one state per column
+   * @param [out] satisfied Per-state flag whether all constraints are satisfied
+   * @param [out] distances Per-state sum of the distances of all constraints
+   */
+  void decide(const moveit::core::RobotState& reference_state, const Eigen::Ref<const Eigen::MatrixXd>& positions,
+              Eigen::Array<bool, Eigen::Dynamic, 1>& satisfied, Eigen::VectorXd& distances) const;
+
   /**
    * \brief Whether or not another KinematicConstraintSet is equal to
    * this one.
@@ -38,11 +38,13 @@
 #include <geometric_shapes/body_operations.h>
 #include <geometric_shapes/shape_operations.h>
 #include <moveit/robot_state/conversions.h>
+#include <moveit/robot_model/aabb.h>
 #include <moveit/collision_detection_fcl/collision_env_fcl.h>
 #include <geometric_shapes/check_isometry.h>
 #include <boost/math/constants/constants.hpp>
 #include <tf2_eigen/tf2_eigen.h>
 #include <boost/bind.hpp>
+#include <algorithm>
 #include <limits>
 #include <memory>
 
@@ -242,6 +244,29 @@ ConstraintEvaluationResult JointConstraint::decide(const moveit::core::RobotStat
   return ConstraintEvaluationResult(result, constraint_weight_ * fabs(dif));
 }
 
+void JointConstraint::decide(const Eigen::Ref<const Eigen::ArrayXd>& values,
+                             Eigen::Array<bool, Eigen::Dynamic, 1>& satisfied, Eigen::ArrayXd& distances) const
+{
+  if (!joint_model_)
+    return;
+
+  // the same computations as in the single state version, applied elementwise
+  Eigen::ArrayXd dif;
+  if (joint_is_continuous_)
+  {
+    // wrap to [-pi, pi) with an array expression instead of calling normalizeAngle() per element, so it vectorizes
+    const double pi = boost::math::constants::pi<double>();
+    dif = values - (2.0 * pi) * ((values + pi) / (2.0 * pi)).floor() - joint_position_;
+    dif = (dif > pi).select(2.0 * pi - dif, (dif < -pi).select(dif + 2.0 * pi, dif));
+  }
+  else
+    dif = values - joint_position_;
+
+  satisfied = satisfied && (dif <= (joint_tolerance_above_ + 2.0 * std::numeric_limits<double>::epsilon())) &&
+              (dif >= (-joint_tolerance_below_ - 2.0 * std::numeric_limits<double>::epsilon()));
+  distances += constraint_weight_ * dif.abs();
+}
+
 bool JointConstraint::enabled() const
 {
   return joint_model_;
@@ -658,6 +683,7 @@ VisibilityConstraint::VisibilityConstraint(const moveit::core::RobotModelConstPt
   : KinematicConstraint(model), collision_env_(new collision_detection::CollisionEnvFCL(model))
 {
   type_ = VISIBILITY_CONSTRAINT;
+  cone_acm_.setDefaultEntry("cone", boost::bind(&VisibilityConstraint::decideContact, this, _1));
 }
 
 void VisibilityConstraint::clear()
@@ -674,6 +700,10 @@ void VisibilityConstraint::clear()
   target_radius_ = -1.0;
   max_view_angle_ = 0.0;
   max_range_angle_ = 0.0;
+  cone_triangles_.clear();
+  cone_shape_.reset();
+  cone_target_in_sensor_ = Eigen::Isometry3d::Identity();
+  collision_env_->getWorld()->removeObject("cone");
 }
 
 bool VisibilityConstraint::configure(const moveit_msgs::VisibilityConstraint& vc, const moveit::core::Transforms& tf)
@@ -707,6 +737,23 @@ bool VisibilityConstraint::configure(const moveit_msgs::VisibilityConstraint& vc
     points_.push_back(Eigen::Vector3d(x, y, 0.0));
   }
 
+  // the triangles only depend on the number of sides: vertex 0 is the sensor origin, vertex 1 the center of the
+  // base of the cone, and the remaining vertices are the points on the base circle
+  cone_triangles_.resize(cone_sides_ * 6);
+  std::size_t p3 = cone_sides_ * 3;
+  for (unsigned int i = 0; i < cone_sides_; ++i)
+  {
+    unsigned int next = (i + 1) % cone_sides_;
+    // triangle forming a side of the cone, using the sensor origin
+    cone_triangles_[i * 3] = i + 2;
+    cone_triangles_[i * 3 + 1] = 0;
+    cone_triangles_[i * 3 + 2] = next + 2;
+    // triangle forming a part of the base of the cone, using the center of the base
+    cone_triangles_[p3 + i * 3] = i + 2;
+    cone_triangles_[p3 + i * 3 + 1] = 1;
+    cone_triangles_[p3 + i * 3 + 2] = next + 2;
+  }
+
   tf2::fromMsg(vc.target_pose.pose, target_pose_);
   ASSERT_ISOMETRY(target_pose_)  // unsanitized input, could contain a non-isometry
 
@@ -798,17 +845,12 @@ shapes::Mesh* VisibilityConstraint::getVisibilityCone(const moveit::core::RobotS
   const Eigen::Isometry3d& tp =
       mobile_target_frame_ ? state.getFrameTransform(target_frame_id_) * target_pose_ : target_pose_;
 
-  // transform the points on the disc to the desired target frame
-  const EigenSTL::vector_Vector3d* points = &points_;
-  std::unique_ptr<EigenSTL::vector_Vector3d> temp_points;
-  if (mobile_target_frame_)
-  {
-    temp_points.reset(new EigenSTL::vector_Vector3d(points_.size()));
-    for (std::size_t i = 0; i < points_.size(); ++i)
-      temp_points->at(i) = tp * points_[i];
-    points = temp_points.get();
-  }
+  return createVisibilityCone(sp, tp, Eigen::Isometry3d::Identity());
+}
 
+shapes::Mesh* VisibilityConstraint::createVisibilityCone(const Eigen::Isometry3d& sp, const Eigen::Isometry3d& tp,
+                                                         const Eigen::Isometry3d& frame_inv) const
+{
   // allocate memory for a mesh to represent the visibility cone
   shapes::Mesh* m = new shapes::Mesh();
   m->vertex_count = cone_sides_ + 2;
@@ -818,49 +860,71 @@ shapes::Mesh* VisibilityConstraint::getVisibilityCone(const moveit::core::RobotS
   // we do NOT allocate normals because we do not compute them
 
   // the sensor origin
-  m->vertices[0] = sp.translation().x();
-  m->vertices[1] = sp.translation().y();
-  m->vertices[2] = sp.translation().z();
+  Eigen::Map<Eigen::Vector3d>(m->vertices) = frame_inv * sp.translation();
 
   // the center of the base of the cone approximation
-  m->vertices[3] = tp.translation().x();
-  m->vertices[4] = tp.translation().y();
-  m->vertices[5] = tp.translation().z();
+  Eigen::Map<Eigen::Vector3d>(m->vertices + 3) = frame_inv * tp.translation();
+
+  // the points that approximate the base disc; these are already in the model frame if the target is fixed
+  const Eigen::Isometry3d points_to_frame = mobile_target_frame_ ? frame_inv * tp : frame_inv;
+  for (std::size_t i = 0; i < points_.size(); ++i)
+    Eigen::Map<Eigen::Vector3d>(m->vertices + i * 3 + 6) = points_to_frame * points_[i];
 
-  // the points that approximate the base disc
-  for (std::size_t i = 0; i < points->size(); ++i)
+  std::copy(cone_triangles_.begin(), cone_triangles_.end(), m->triangles);
+
+  return m;
+}
+
+bool VisibilityConstraint::coneMayTouchRobot(const moveit::core::RobotState& state, const Eigen::Isometry3d& sp,
+                                             const Eigen::Isometry3d& tp) const
+{
+  // the center of the base lies within the convex hull of the sensor origin and the base points
+  moveit::core::AABB cone_box;
+  cone_box.extend(sp.translation());
+  for (const Eigen::Vector3d& point : points_)
+    cone_box.extend(mobile_target_frame_ ? Eigen::Vector3d(tp * point) : point);
+
+  for (const moveit::core::LinkModel* link : robot_model_->getLinkModelsWithCollisionGeometry())
   {
-    m->vertices[i * 3 + 6] = points->at(i).x();
-    m->vertices[i * 3 + 7] = points->at(i).y();
-    m->vertices[i * 3 + 8] = points->at(i).z();
+    // contacts with these links are always allowed by decideContact()
+    if (moveit::core::Transforms::sameFrame(link->getName(), sensor_frame_id_) ||
+        moveit::core::Transforms::sameFrame(link->getName(), target_frame_id_))
+      continue;
+
+    // scaling is applied around the origin of each shape, which the link's box does not capture
+    if (collision_env_->getLinkScale(link->getName()) != 1.0)
+      return true;
+
+    Eigen::Isometry3d transform = state.getGlobalLinkTransform(link);  // intentional copy, we will translate
+    transform.translate(link->getCenteredBoundingBoxOffset());
+    const double padding = collision_env_->getLinkPadding(link->getName());
+    moveit::core::AABB link_box;
+    link_box.extendWithTransformedBox(transform,
+                                      link->getShapeExtentsAtOrigin() + Eigen::Vector3d::Constant(2.0 * padding));
+    if (link_box.intersects(cone_box))
+      return true;
   }
+  return false;
+}
+
+void VisibilityConstraint::updateConeObject(const Eigen::Isometry3d& sp, const Eigen::Isometry3d& tp) const
+{
+  // sp is a valid isometry, so its inverse is cheap
+  const Eigen::Isometry3d sp_inv = sp.inverse(Eigen::Isometry);
+  const Eigen::Isometry3d target_in_sensor = sp_inv * tp;
 
-  // add the triangles
-  std::size_t p3 = points->size() * 3;
-  for (std::size_t i = 1; i < points->size(); ++i)
+  const collision_detection::WorldPtr& world = collision_env_->getWorld();
+  if (cone_shape_ && target_in_sensor.isApprox(cone_target_in_sensor_, 1e-12))
   {
-    // triangle forming a side of the cone, using the sensor origin
-    std::size_t i3 = (i - 1) * 3;
-    m->triangles[i3] = i + 1;
-    m->triangles[i3 + 1] = 0;
-    m->triangles[i3 + 2] = i + 2;
-    // triangle forming a part of the base of the cone, using the center of the base
-    std::size_t i6 = p3 + i3;
-    m->triangles[i6] = i + 1;
-    m->triangles[i6 + 1] = 1;
-    m->triangles[i6 + 2] = i + 2;
+    // the shape of the cone did not change, only its pose; the collision geometry is reused
+    world->moveShapeInObject("cone", cone_shape_, sp);
+    return;
   }
 
-  // last triangles
-  m->triangles[p3 - 3] = points->size() + 1;
-  m->triangles[p3 - 2] = 0;
-  m->triangles[p3 - 1] = 2;
-  p3 *= 2;
-  m->triangles[p3 - 3] = points->size() + 1;
-  m->triangles[p3 - 2] = 1;
-  m->triangles[p3 - 1] = 2;
-
-  return m;
+  world->removeObject("cone");
+  cone_shape_.reset(createVisibilityCone(sp, tp, sp_inv));
+  cone_target_in_sensor_ = target_in_sensor;
+  world->addToObject("cone", cone_shape_, sp);
 }
 
 void VisibilityConstraint::getMarkers(const moveit::core::RobotState& state,
@@ -943,16 +1007,16 @@ ConstraintEvaluationResult VisibilityConstraint::decide(const moveit::core::Robo
   if (target_radius_ <= std::numeric_limits<double>::epsilon())
     return ConstraintEvaluationResult(true, 0.0);
 
+  // getFrameTransform() returns a valid isometry by contract
+  // sensor_pose_ is valid isometry (checked in configure())
+  const Eigen::Isometry3d& sp =
+      mobile_sensor_frame_ ? state.getFrameTransform(sensor_frame_id_) * sensor_pose_ : sensor_pose_;
+  // target_pose_ is valid isometry (checked in configure())
+  const Eigen::Isometry3d& tp =
+      mobile_target_frame_ ? state.getFrameTransform(target_frame_id_) * target_pose_ : target_pose_;
+
   if (max_view_angle_ > 0.0 || max_range_angle_ > 0.0)
   {
-    // getFrameTransform() returns a valid isometry by contract
-    // sensor_pose_ is valid isometry (checked in configure())
-    const Eigen::Isometry3d& sp =
-        mobile_sensor_frame_ ? state.getFrameTransform(sensor_frame_id_) * sensor_pose_ : sensor_pose_;
-    // target_pose_ is valid isometry (checked in configure())
-    const Eigen::Isometry3d& tp =
-        mobile_target_frame_ ? state.getFrameTransform(target_frame_id_) * target_pose_ : target_pose_;
-
     // necessary to do subtraction as SENSOR_Z is 0 and SENSOR_X is 2
     const Eigen::Vector3d& normal2 = sp.linear().col(2 - sensor_view_direction_);
 
@@ -1003,33 +1067,34 @@ ConstraintEvaluationResult VisibilityConstraint::decide(const moveit::core::Robo
     }
   }
 
-  shapes::Mesh* m = getVisibilityCone(state);
-  if (!m)
-    return ConstraintEvaluationResult(false, 0.0);
+  // cheap broad phase: if no link that may not touch the cone is near it, there can be no disallowed contact
+  if (!coneMayTouchRobot(state, sp, tp))
+  {
+    if (verbose)
+      ROS_INFO_NAMED("kinematic_constraints", "Visibility constraint satisfied. No robot link is near the cone.");
+    return ConstraintEvaluationResult(true, 0.0);
+  }
 
   // add the visibility cone as an object
-  collision_env_->getWorld()->addToObject("cone", shapes::ShapeConstPtr(m), Eigen::Isometry3d::Identity());
+  updateConeObject(sp, tp);
 
   // check for collisions between the robot and the cone
   collision_detection::CollisionRequest req;
   collision_detection::CollisionResult res;
-  collision_detection::AllowedCollisionMatrix acm;
-  acm.setDefaultEntry("cone", boost::bind(&VisibilityConstraint::decideContact, this, _1));
   req.contacts = true;
   req.verbose = verbose;
   req.max_contacts = 1;
-  collision_env_->checkRobotCollision(req, res, state, acm);
+  collision_env_->checkRobotCollision(req, res, state, cone_acm_);
 
   if (verbose)
   {
     std::stringstream ss;
-    m->print(ss);
-    ROS_INFO_NAMED("kinematic_constraints", "Visibility constraint %ssatisfied. Visibility cone approximation:\n %s",
+    cone_shape_->print(ss);
+    ROS_INFO_NAMED("kinematic_constraints",
+                   "Visibility constraint %ssatisfied. Visibility cone approximation (in the sensor frame):\n %s",
                    res.collision ? "not " : "", ss.str().c_str());
   }
 
-  collision_env_->getWorld()->removeObject("cone");
-
   return ConstraintEvaluationResult(!res.collision, res.collision ? res.contacts.begin()->second.front().depth : 0.0);
 }
 
@@ -1180,6 +1245,105 @@ ConstraintEvaluationResult KinematicConstraintSet::decide(const moveit::core::Ro
   return result;
 }
 
+void KinematicConstraintSet::decide(const moveit::core::RobotState& reference_state,
+                                    const Eigen::Ref<const Eigen::MatrixXd>& positions,
+                                    Eigen::Array<bool, Eigen::Dynamic, 1>& satisfied, Eigen::VectorXd& distances) const
+{
+  const Eigen::Index count = positions.cols();
+  satisfied.setConstant(count, true);
+  Eigen::ArrayXd distance_sum = Eigen::ArrayXd::Zero(count);
+
+  // mark the joints on the path from the root to a link
+  std::vector<bool> needed_joints(robot_model_->getJointModelCount(), false);
+  bool all_joints = false;
+  auto add_link = [&needed_joints](const moveit::core::LinkModel* link) {
+    for (; link; link = link->getParentLinkModel())
+      needed_joints[link->getParentJointModel()->getJointIndex()] = true;
+  };
+  auto add_frame = [&reference_state, &add_link](const std::string& frame_id) {
+    const moveit::core::LinkModel* link = nullptr;
+    bool found = false;
+    reference_state.getFrameInfo(frame_id, link, found);
+    if (link)
+      add_link(link);
+  };
+
+  // joint constraints only depend on a single variable and are evaluated for all states at once
+  std::vector<const KinematicConstraint*> state_constraints;
+  Eigen::ArrayXd values(count);
+  for (const KinematicConstraintPtr& kinematic_constraint : kinematic_constraints_)
+  {
+    // disabled constraints are always satisfied with a distance of 0
+    if (!kinematic_constraint->enabled())
+      continue;
+
+    switch (kinematic_constraint->getType())
+    {
+      case KinematicConstraint::JOINT_CONSTRAINT:
+      {
+        const JointConstraint& jc = static_cast<const JointConstraint&>(*kinematic_constraint);
+        values = positions.row(jc.getJointVariableIndex()).transpose().array();
+        jc.decide(values, satisfied, distance_sum);
+        continue;
+      }
+      case KinematicConstraint::POSITION_CONSTRAINT:
+      {
+        const PositionConstraint& pc = static_cast<const PositionConstraint&>(*kinematic_constraint);
+        add_link(pc.getLinkModel());
+        if (pc.mobileReferenceFrame())
+          add_frame(pc.getReferenceFrame());
+        break;
+      }
+      case KinematicConstraint::ORIENTATION_CONSTRAINT:
+      {
+        const OrientationConstraint& oc = static_cast<const OrientationConstraint&>(*kinematic_constraint);
+        add_link(oc.getLinkModel());
+        if (oc.mobileReferenceFrame())
+          add_frame(oc.getReferenceFrame());
+        break;
+      }
+      default:
+        // visibility constraints check the cone against all robot links
+        all_joints = true;
+    }
+    state_constraints.push_back(kinematic_constraint.get());
+  }
+
+  if (!state_constraints.empty())
+  {
+    std::vector<const moveit::core::JointModel*> joints;
+    for (const moveit::core::JointModel* joint : robot_model_->getJointModels())
+      if (joint->getVariableCount() > 0 && (all_joints || needed_joints[joint->getJointIndex()]))
+        joints.push_back(joint);
+
+    moveit::core::RobotState state(reference_state);
+    for (Eigen::Index i = 0; i < count; ++i)
+    {
+      const double* state_positions = positions.col(i).data();
+      for (const moveit::core::JointModel* joint : joints)
+      {
+        // only joints that actually changed mark their descendant link transforms dirty
+        const double* joint_positions = state_positions + joint->getFirstVariableIndex();
+        if (!std::equal(joint_positions, joint_positions + joint->getVariableCount(), state.getJointPositions(joint)))
+          state.setJointPositions(joint, joint_positions);
+      }
+      if (all_joints)
+        state.update();
+      else
+        state.updateLinkTransforms();
+
+      for (const KinematicConstraint* kinematic_constraint : state_constraints)
+      {
+        ConstraintEvaluationResult r = kinematic_constraint->decide(state);
+        satisfied(i) = satisfied(i) && r.satisfied;
+        distance_sum(i) += r.distance;
+      }
+    }
+  }
+
+  distances = distance_sum.matrix();
+}
+
 void KinematicConstraintSet::print(std::ostream& out) const
 {
   out << kinematic_constraints_.size() << " kinematic constraints" << std::endl;
@@ -40,6 +40,8 @@
 #include <fstream>
 #include <tf2_eigen/tf2_eigen.h>
 #include <moveit/utils/robot_model_test_utils.h>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <random_numbers/random_numbers.h>
 
 class LoadPlanningModelsPr2 : public testing::Test
 {
@@ -779,6 +781,73 @@ TEST_F(LoadPlanningModelsPr2, VisibilityConstraintsPR2)
   EXPECT_FALSE(vc.decide(robot_state, true).satisfied);
 }
 
+// Compare against checking the cone built in the model frame for every state, as done without caching
+TEST_F(LoadPlanningModelsPr2, VisibilityConstraintsCachedCone)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+  random_numbers::RandomNumberGenerator rng(42);
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("arms");
+
+  moveit_msgs::VisibilityConstraint vcm;
+  vcm.sensor_pose.header.frame_id = "narrow_stereo_optical_frame";
+  vcm.sensor_pose.pose.position.z = 0.05;
+  vcm.sensor_pose.pose.orientation.w = 1.0;
+  vcm.target_pose.pose.orientation.w = 1.0;
+  vcm.target_radius = .05;
+  vcm.cone_sides = 10;
+  vcm.sensor_view_direction = moveit_msgs::VisibilityConstraint::SENSOR_Z;
+  vcm.weight = 1.0;
+
+  // a target moving relative to the sensor, a target fixed relative to the sensor and a target fixed in the world
+  std::vector<std::pair<std::string, double>> targets = { { "l_gripper_r_finger_tip_link", 0.03 },
+                                                           { "narrow_stereo_optical_frame", 1.0 },
+                                                           { robot_model_->getModelFrame(), 0.5 } };
+  for (const std::pair<std::string, double>& target : targets)
+  {
+    vcm.target_pose.header.frame_id = target.first;
+    vcm.target_pose.pose.position.z = target.second;
+
+    kinematic_constraints::VisibilityConstraint vc(robot_model_);
+    ASSERT_TRUE(vc.configure(vcm, tf));
+
+    collision_detection::CollisionEnvFCL env(robot_model_);
+    collision_detection::AllowedCollisionMatrix acm;
+    acm.setDefaultEntry("cone", [&vcm](collision_detection::Contact& contact) {
+      const std::string& link = contact.body_type_1 == collision_detection::BodyTypes::ROBOT_LINK ?
+                                    contact.body_name_1 :
+                                    contact.body_name_2;
+      return contact.body_type_1 == collision_detection::BodyTypes::ROBOT_ATTACHED ||
+             contact.body_type_2 == collision_detection::BodyTypes::ROBOT_ATTACHED ||
+             link == vcm.sensor_pose.header.frame_id || link == vcm.target_pose.header.frame_id;
+    });
+
+    std::size_t violated = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+      robot_state.setToRandomPositions(jmg, rng);
+      robot_state.update();
+
+      env.getWorld()->addToObject("cone", shapes::ShapeConstPtr(vc.getVisibilityCone(robot_state)),
+                                  Eigen::Isometry3d::Identity());
+      collision_detection::CollisionRequest req;
+      collision_detection::CollisionResult res;
+      env.checkRobotCollision(req, res, robot_state, acm);
+      env.getWorld()->removeObject("cone");
+
+      EXPECT_EQ(vc.decide(robot_state).satisfied, !res.collision) << "target " << target.first << ", state " << i;
+      violated += res.collision;
+    }
+    // make sure the comparison covers both outcomes for the moving target
+    if (target.first == "l_gripper_r_finger_tip_link")
+    {
+      EXPECT_GT(violated, 0u);
+    }
+  }
+}
+
 TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSet)
 {
   moveit::core::RobotState robot_state(robot_model_);
@@ -924,6 +993,86 @@ TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetEquality)
   EXPECT_TRUE(kcs2.equal(kcs, .1));
 }
 
+TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetBatch)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+
+  moveit_msgs::Constraints constraints;
+  constraints.joint_constraints.resize(2);
+  constraints.joint_constraints[0].joint_name = "head_pan_joint";
+  constraints.joint_constraints[0].tolerance_above = 1.5;
+  constraints.joint_constraints[0].tolerance_below = 1.5;
+  constraints.joint_constraints[0].weight = 1.0;
+  // continuous joint
+  constraints.joint_constraints[1].joint_name = "r_forearm_roll_joint";
+  constraints.joint_constraints[1].position = 3.0;
+  constraints.joint_constraints[1].tolerance_above = 2.5;
+  constraints.joint_constraints[1].tolerance_below = 2.5;
+  constraints.joint_constraints[1].weight = 0.5;
+
+  // in a mobile frame
+  moveit_msgs::PositionConstraint pcm;
+  pcm.header.frame_id = "base_footprint";
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions.resize(1);
+  pcm.constraint_region.primitives[0].dimensions[0] = 0.6;
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.5;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 0.8;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  constraints.position_constraints.push_back(pcm);
+
+  moveit_msgs::OrientationConstraint ocm;
+  ocm.header.frame_id = "base_footprint";
+  ocm.link_name = "r_wrist_roll_link";
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = 2.0;
+  ocm.absolute_y_axis_tolerance = 2.0;
+  ocm.absolute_z_axis_tolerance = 2.0;
+  ocm.weight = 1.0;
+  constraints.orientation_constraints.push_back(ocm);
+
+  EXPECT_TRUE(kcs.add(constraints, tf));
+
+  random_numbers::RandomNumberGenerator rng(42);
+  const std::size_t count = 500;
+  Eigen::MatrixXd positions(robot_model_->getVariableCount(), count);
+  std::vector<kinematic_constraints::ConstraintEvaluationResult> expected;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    robot_state.setToRandomPositions(rng);
+    robot_state.update();
+    positions.col(i) =
+        Eigen::Map<const Eigen::VectorXd>(robot_state.getVariablePositions(), robot_model_->getVariableCount());
+    expected.push_back(kcs.decide(robot_state));
+  }
+
+  Eigen::Array<bool, Eigen::Dynamic, 1> satisfied;
+  Eigen::VectorXd distances;
+  kcs.decide(robot_state, positions, satisfied, distances);
+  ASSERT_EQ(satisfied.size(), static_cast<Eigen::Index>(count));
+  ASSERT_EQ(distances.size(), static_cast<Eigen::Index>(count));
+
+  std::size_t num_satisfied = 0;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    EXPECT_EQ(satisfied(i), expected[i].satisfied) << "state " << i;
+    EXPECT_NEAR(distances(i), expected[i].distance, 1e-9) << "state " << i;
+    num_satisfied += expected[i].satisfied;
+  }
+  // make sure both outcomes are covered
+  EXPECT_GT(num_satisfied, 0u);
+  EXPECT_LT(num_satisfied, count);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
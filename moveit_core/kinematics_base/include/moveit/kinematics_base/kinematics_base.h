@@ -319,6 +319,30 @@ public:
     return false;
   }
 
+  /**
+   * @brief Given a batch of desired poses of the end-effector, search for the joint angles required to reach each
+   * of them. This is meant for callers that solve many independent poses, e.g. filtering grasp candidates or
+   * computing reachability maps.
+   *
+   * Every pose is solved as if by a separate call to searchPositionIK(). The default implementation does exactly
+   * that. Solvers may override it to reuse their internal data structures across poses.
+   * @param ik_poses the desired poses of the (single) tip link
+   * @param ik_seed_states either one initial guess per pose, or a single initial guess that is used for all poses
+   * @param timeout The amount of time (in seconds) available to the solver for each individual pose
+   * @param solutions the solution vectors, one per pose. The entries of failed poses are cleared.
+   * @param error_codes the error codes, one per pose
+   * @param solution_callback (optional) A callback to validate each IK solution
+   * @param options container for other IK options. See definition of KinematicsQueryOptions for details.
+   * @return True if a valid solution was found for every pose, false otherwise
+   */
+  virtual bool
+  searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                        const std::vector<std::vector<double> >& ik_seed_states, double timeout,
+                        std::vector<std::vector<double> >& solutions,
+                        std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                        const IKCallbackFn& solution_callback = IKCallbackFn(),
+                        const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const;
+
   /**
    * @brief Given a set of joint angles and a set of links, compute their pose
    * @param link_names A set of links for which FK needs to be computed
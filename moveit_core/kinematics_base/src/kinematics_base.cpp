@@ -235,4 +235,43 @@ bool KinematicsBase::getPositionIK(const std::vector<geometry_msgs::Pose>& ik_po
   return true;
 }
 
+bool KinematicsBase::searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                           const std::vector<std::vector<double> >& ik_seed_states, double timeout,
+                                           std::vector<std::vector<double> >& solutions,
+                                           std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                                           const IKCallbackFn& solution_callback,
+                                           const KinematicsQueryOptions& options) const
+{
+  solutions.resize(ik_poses.size());
+  error_codes.resize(ik_poses.size());
+
+  if (ik_seed_states.empty() || (ik_seed_states.size() != 1 && ik_seed_states.size() != ik_poses.size()))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Expected either a single seed state or one per pose, but got %zu seeds for %zu poses",
+                    ik_seed_states.size(), ik_poses.size());
+    for (std::size_t i = 0; i < ik_poses.size(); ++i)
+    {
+      solutions[i].clear();
+      error_codes[i].val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    }
+    return false;
+  }
+
+  bool all_found = true;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    const std::vector<double>& seed = ik_seed_states.size() == 1 ? ik_seed_states[0] : ik_seed_states[i];
+    bool found = solution_callback ?
+                     searchPositionIK(ik_poses[i], seed, timeout, solutions[i], solution_callback, error_codes[i],
+                                      options) :
+                     searchPositionIK(ik_poses[i], seed, timeout, solutions[i], error_codes[i], options);
+    if (!found)
+    {
+      solutions[i].clear();
+      all_found = false;
+    }
+  }
+  return all_found;
+}
+
 }  // end of namespace kinematics
@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/profiler/tracer.h>
 #include <boost/bind.hpp>
 #include <algorithm>
 
@@ -49,6 +50,7 @@ bool callPlannerInterfaceSolve(const planning_interface::PlannerManager* planner
                                const planning_interface::MotionPlanRequest& req,
                                planning_interface::MotionPlanResponse& res)
 {
+  MOVEIT_TRACE_SCOPE("PlanningContext::solve");
   planning_interface::PlanningContextPtr context = planner->getPlanningContext(planning_scene, req, res.error_code_);
   if (context)
     return context->solve(res);
@@ -78,6 +80,16 @@ bool PlanningRequestAdapter::adaptAndPlan(const planning_interface::PlannerManag
 
 namespace
 {
+// Name the span of an adapter after its description, so the adapters of a chain can be told apart
+const char* getSpanName(const PlanningRequestAdapter* adapter)
+{
+  if (!moveit::tools::Tracer::isEnabled())
+    return "PlanningRequestAdapter::adaptAndPlan";
+  const std::string description = adapter->getDescription();
+  return moveit::tools::Tracer::instance().intern(description.empty() ? "PlanningRequestAdapter::adaptAndPlan" :
+                                                                        description);
+}
+
 // boost bind is not happy with overloading, so we add intermediate function objects
 
 bool callAdapter1(const PlanningRequestAdapter* adapter, const planning_interface::PlannerManagerPtr& planner,
@@ -85,6 +97,7 @@ bool callAdapter1(const PlanningRequestAdapter* adapter, const planning_interfac
                   const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
                   std::vector<std::size_t>& added_path_index)
 {
+  moveit::tools::Tracer::ScopedSpan span(getSpanName(adapter));
   try
   {
     return adapter->adaptAndPlan(planner, planning_scene, req, res, added_path_index);
@@ -103,6 +116,7 @@ bool callAdapter2(const PlanningRequestAdapter* adapter, const PlanningRequestAd
                   const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
                   std::vector<std::size_t>& added_path_index)
 {
+  moveit::tools::Tracer::ScopedSpan span(getSpanName(adapter));
   try
   {
     return adapter->adaptAndPlan(planner, planning_scene, req, res, added_path_index);
@@ -294,6 +294,18 @@ public:
     return world_;
   }
 
+  /** \brief Get a 64-bit hash of the collision-relevant content of the scene.
+   *
+   * The hash combines the hash of the world (maintained incrementally by collision_detection::World),
+   * the allowed collision matrix, the link padding and scale of the active collision environment and
+   * the attached bodies of the current state. Joint values of the current state are not included.
+   * Two scenes with the same content have the same hash, so caches can use it to check whether a
+   * scene changed without comparing messages.
+   *
+   * The octomap changes with every sensor update. Caches that validate their entries against the
+   * octomap anyway can pass \e include_octomap = false to leave it out of the hash. */
+  std::uint64_t getHash(bool include_octomap = true) const;
+
   /** \brief Get the active collision environment */
   const collision_detection::CollisionEnvConstPtr& getCollisionEnv() const
   {
@@ -741,6 +753,13 @@ public:
   void processOctomapMsg(const octomap_msgs::Octomap& map);
   void processOctomapPtr(const std::shared_ptr<const octomap::OcTree>& octree, const Eigen::Isometry3d& t);
 
+  /** \brief Set the octomap to \e octree at pose \e t. If the scene already refers to \e octree, the tree is
+   * assumed to be updated in place, and \e version (e.g. the update counter of the tree) identifies its content
+   * in the hash of the world, see collision_detection::World::rehashObject(). Returns false, without modifying
+   * the scene, if the scene already refers to \e octree at pose \e t with the same \e version. */
+  bool processOctomapPtr(const std::shared_ptr<const octomap::OcTree>& octree, const Eigen::Isometry3d& t,
+                         std::uint64_t version);
+
   /**
    * \brief Clear all collision objects in planning scene
    */
@@ -39,13 +39,16 @@
 #include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
 #include <geometric_shapes/shape_operations.h>
 #include <moveit/collision_detection/collision_tools.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/exceptions/exceptions.h>
 #include <moveit/robot_state/attached_body.h>
 #include <moveit/utils/message_checks.h>
+#include <moveit/profiler/tracer.h>
 #include <octomap_msgs/conversions.h>
 #include <tf2_eigen/tf2_eigen.h>
+#include <algorithm>
 #include <memory>
 #include <set>
 
@@ -481,6 +484,8 @@ void PlanningScene::checkCollision(const collision_detection::CollisionRequest&
                                    collision_detection::CollisionResult& res,
                                    const moveit::core::RobotState& robot_state) const
 {
+  MOVEIT_TRACE_SCOPE("PlanningScene::checkCollision");
+
   // check collision with the world using the padded version
   getCollisionEnv()->checkRobotCollision(req, res, robot_state, getAllowedCollisionMatrix());
 
@@ -505,6 +510,8 @@ void PlanningScene::checkCollision(const collision_detection::CollisionRequest&
                                    const moveit::core::RobotState& robot_state,
                                    const collision_detection::AllowedCollisionMatrix& acm) const
 {
+  MOVEIT_TRACE_SCOPE("PlanningScene::checkCollision");
+
   // check collision with the world using the padded version
   getCollisionEnv()->checkRobotCollision(req, res, robot_state, acm);
 
@@ -527,6 +534,8 @@ void PlanningScene::checkCollisionUnpadded(const collision_detection::CollisionR
                                            const moveit::core::RobotState& robot_state,
                                            const collision_detection::AllowedCollisionMatrix& acm) const
 {
+  MOVEIT_TRACE_SCOPE("PlanningScene::checkCollisionUnpadded");
+
   // check collision with the world using the unpadded version
   getCollisionEnvUnpadded()->checkRobotCollision(req, res, robot_state, acm);
 
@@ -629,6 +638,66 @@ collision_detection::AllowedCollisionMatrix& PlanningScene::getAllowedCollisionM
   return *acm_;
 }
 
+std::uint64_t PlanningScene::getHash(bool include_octomap) const
+{
+  using collision_detection::combineHash;
+  using collision_detection::computePoseHash;
+  using collision_detection::computeShapeHash;
+  using collision_detection::hashDouble;
+  using collision_detection::hashString;
+
+  std::uint64_t h = hashString(getRobotModel()->getName());
+  std::uint64_t world_hash = world_->getHash();
+  if (!include_octomap)
+  {
+    // the world hash is the sum of the object hashes
+    collision_detection::World::ObjectConstPtr map = world_->getObject(OCTOMAP_NS);
+    if (map)
+      world_hash -= map->hash_;
+  }
+  combineHash(h, world_hash);
+  combineHash(h, getAllowedCollisionMatrix().getHash());
+
+  const collision_detection::CollisionEnvConstPtr& env = getCollisionEnv();
+  for (const std::pair<const std::string, double>& padding : env->getLinkPadding())
+  {
+    combineHash(h, hashString(padding.first));
+    combineHash(h, hashDouble(padding.second));
+  }
+  for (const std::pair<const std::string, double>& scale : env->getLinkScale())
+  {
+    combineHash(h, hashString(scale.first));
+    combineHash(h, hashDouble(scale.second));
+  }
+
+  // attached bodies are hashed relative to their link, so they are independent of the joint values
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  getCurrentState().getAttachedBodies(attached_bodies);
+  std::sort(attached_bodies.begin(), attached_bodies.end(),
+            [](const moveit::core::AttachedBody* a, const moveit::core::AttachedBody* b) {
+              return a->getName() < b->getName();
+            });
+  for (const moveit::core::AttachedBody* body : attached_bodies)
+  {
+    combineHash(h, hashString(body->getName()));
+    combineHash(h, hashString(body->getAttachedLinkName()));
+    for (std::size_t i = 0; i < body->getShapes().size(); ++i)
+    {
+      combineHash(h, computeShapeHash(*body->getShapes()[i]));
+      combineHash(h, computePoseHash(body->getFixedTransforms()[i]));
+    }
+    combineHash(h, body->getTouchLinks().size());
+    for (const std::string& touch_link : body->getTouchLinks())
+      combineHash(h, hashString(touch_link));
+    for (const auto& subframe : body->getSubframeTransforms())
+    {
+      combineHash(h, hashString(subframe.first));
+      combineHash(h, computePoseHash(subframe.second));
+    }
+  }
+  return h;
+}
+
 const moveit::core::Transforms& PlanningScene::getTransforms()
 {
   // Trigger an update of the robot transforms
@@ -650,6 +719,46 @@ moveit::core::Transforms& PlanningScene::getTransformsNonConst()
   return *scene_transforms_;
 }
 
+namespace
+{
+/* Fill \e collision_obj with a MOVE operation carrying only the shape and subframe poses of \e obj.
+ * Poses are grouped by message field in the same way as getCollisionObjectMsg() does, which is also
+ * the shape order a receiver builds from an ADD message. Returns false if a shape has no message
+ * representation, in which case the receiver could not match poses to shapes. */
+bool getCollisionObjectMoveMsg(moveit_msgs::CollisionObject& collision_obj,
+                               const collision_detection::World::Object& obj)
+{
+  collision_obj.id = obj.id_;
+  collision_obj.operation = moveit_msgs::CollisionObject::MOVE;
+  for (std::size_t i = 0; i < obj.shapes_.size(); ++i)
+  {
+    switch (obj.shapes_[i]->type)
+    {
+      case shapes::SPHERE:
+      case shapes::BOX:
+      case shapes::CYLINDER:
+      case shapes::CONE:
+        collision_obj.primitive_poses.push_back(tf2::toMsg(obj.shape_poses_[i]));
+        break;
+      case shapes::MESH:
+        collision_obj.mesh_poses.push_back(tf2::toMsg(obj.shape_poses_[i]));
+        break;
+      case shapes::PLANE:
+        collision_obj.plane_poses.push_back(tf2::toMsg(obj.shape_poses_[i]));
+        break;
+      default:
+        return false;
+    }
+  }
+  for (const auto& frame_pair : obj.subframe_poses_)
+  {
+    collision_obj.subframe_names.push_back(frame_pair.first);
+    collision_obj.subframe_poses.push_back(tf2::toMsg(frame_pair.second));
+  }
+  return true;
+}
+}  // namespace
+
 void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::PlanningScene& scene_msg) const
 {
   scene_msg.name = name_;
@@ -709,8 +818,17 @@ void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::PlanningScene& scene_ms
       }
       else
       {
+        // objects that only moved are sent without their geometry, which the receiver already has
         scene_msg.world.collision_objects.emplace_back();
-        getCollisionObjectMsg(scene_msg.world.collision_objects.back(), it.first);
+        moveit_msgs::CollisionObject& co = scene_msg.world.collision_objects.back();
+        collision_detection::World::ObjectConstPtr obj = world_->getObject(it.first);
+        if (it.second == collision_detection::World::MOVE_SHAPE && obj && getCollisionObjectMoveMsg(co, *obj))
+          co.header.frame_id = getPlanningFrame();
+        else
+        {
+          co = moveit_msgs::CollisionObject();
+          getCollisionObjectMsg(co, it.first);
+        }
       }
     }
     if (do_omap)
@@ -1332,6 +1450,19 @@ void PlanningScene::processOctomapMsg(const octomap_msgs::OctomapWithPose& map)
 }
 
 void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTree>& octree, const Eigen::Isometry3d& t)
+{
+  // without a version, the tree is assumed to have changed
+  std::uint64_t version = 0;
+  {
+    collision_detection::CollisionEnv::ObjectConstPtr map = world_->getObject(OCTOMAP_NS);
+    if (map)
+      version = map->version_ + 1;
+  }
+  processOctomapPtr(octree, t, version);
+}
+
+bool PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTree>& octree, const Eigen::Isometry3d& t,
+                                      std::uint64_t version)
 {
   collision_detection::CollisionEnv::ObjectConstPtr map = world_->getObject(OCTOMAP_NS);
   if (map)
@@ -1345,6 +1476,13 @@ void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTre
         // if the pose changed, we update it
         if (map->shape_poses_[0].isApprox(t, std::numeric_limits<double>::epsilon() * 100.0))
         {
+          // nothing changed since the last update
+          if (map->version_ == version)
+            return false;
+
+          // the tree was updated in place
+          map.reset();
+          world_->rehashObject(OCTOMAP_NS, version);
           if (world_diff_)
             world_diff_->set(OCTOMAP_NS, collision_detection::World::DESTROY | collision_detection::World::CREATE |
                                              collision_detection::World::ADD_SHAPE);
@@ -1354,14 +1492,17 @@ void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTre
           shapes::ShapeConstPtr shape = map->shapes_[0];
           map.reset();  // reset this pointer first so that caching optimizations can be used in CollisionWorld
           world_->moveShapeInObject(OCTOMAP_NS, shape, t);
+          world_->rehashObject(OCTOMAP_NS, version);
         }
-        return;
+        return true;
       }
     }
   }
   // if the octree pointer changed, update the structure
   world_->removeObject(OCTOMAP_NS);
   world_->addToObject(OCTOMAP_NS, shapes::ShapeConstPtr(new shapes::OcTree(octree)), t);
+  world_->rehashObject(OCTOMAP_NS, version);
+  return true;
 }
 
 bool PlanningScene::processAttachedCollisionObjectMsg(const moveit_msgs::AttachedCollisionObject& object)
@@ -1734,8 +1875,33 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject
   }
 
   // replace the object if ADD is specified instead of APPEND
+  // Shapes of the replaced object are kept by content: senders re-send the full geometry of changed objects,
+  // and reusing the existing shape for identical geometry avoids rebuilding its collision geometry.
+  std::multimap<std::uint64_t, shapes::ShapeConstPtr> replaced_shapes;
   if (object.operation == moveit_msgs::CollisionObject::ADD && world_->hasObject(object.id))
+  {
+    collision_detection::World::ObjectConstPtr obj = world_->getObject(object.id);
+    for (std::size_t i = 0; i < obj->shapes_.size() && i < obj->shape_hashes_.size(); ++i)
+      replaced_shapes.emplace(obj->shape_hashes_[i], obj->shapes_[i]);
+    obj.reset();
     world_->removeObject(object.id);
+  }
+  const auto reuse_shape = [&replaced_shapes](shapes::Shape* s) {
+    shapes::ShapeConstPtr shape(s);
+    if (!replaced_shapes.empty())
+    {
+      // the hash only preselects candidates, the geometry decides
+      auto range = replaced_shapes.equal_range(collision_detection::computeShapeHash(*shape));
+      for (auto it = range.first; it != range.second; ++it)
+        if (collision_detection::equalShapes(*it->second, *shape))
+        {
+          shape = it->second;
+          replaced_shapes.erase(it);
+          break;
+        }
+    }
+    return shape;
+  };
 
   const Eigen::Isometry3d& object_frame_transform = getFrameTransform(object.header.frame_id);
 
@@ -1746,7 +1912,7 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject
     {
       Eigen::Isometry3d object_pose;
       PlanningScene::poseMsgToEigen(object.primitive_poses[i], object_pose);
-      world_->addToObject(object.id, shapes::ShapeConstPtr(s), object_frame_transform * object_pose);
+      world_->addToObject(object.id, reuse_shape(s), object_frame_transform * object_pose);
     }
   }
   for (std::size_t i = 0; i < object.meshes.size(); ++i)
@@ -1756,7 +1922,7 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject
     {
       Eigen::Isometry3d object_pose;
       PlanningScene::poseMsgToEigen(object.mesh_poses[i], object_pose);
-      world_->addToObject(object.id, shapes::ShapeConstPtr(s), object_frame_transform * object_pose);
+      world_->addToObject(object.id, reuse_shape(s), object_frame_transform * object_pose);
     }
   }
   for (std::size_t i = 0; i < object.planes.size(); ++i)
@@ -1766,7 +1932,7 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject
     {
       Eigen::Isometry3d object_pose;
       PlanningScene::poseMsgToEigen(object.plane_poses[i], object_pose);
-      world_->addToObject(object.id, shapes::ShapeConstPtr(s), object_frame_transform * object_pose);
+      world_->addToObject(object.id, reuse_shape(s), object_frame_transform * object_pose);
     }
   }
   if (!object.type.key.empty() || !object.type.db.empty())
@@ -1829,23 +1995,33 @@ bool PlanningScene::processCollisionObjectMove(const moveit_msgs::CollisionObjec
       new_poses.push_back(t * object_pose);
     }
 
-    collision_detection::World::ObjectConstPtr obj = world_->getObject(object.id);
-
-    if (obj->shapes_.size() == new_poses.size())
-    {
-      std::vector<shapes::ShapeConstPtr> shapes = obj->shapes_;
-      obj.reset();
-      world_->removeObject(object.id);
-      world_->addToObject(object.id, shapes, new_poses);
-    }
-    else
+    // keep the shapes, so collision geometry does not need to be rebuilt
+    if (!world_->moveShapesInObject(object.id, new_poses))
     {
       ROS_ERROR_NAMED(LOGNAME,
                       "Number of supplied poses (%zu) for object '%s' does not match number of shapes (%zu). "
                       "Not moving.",
-                      new_poses.size(), object.id.c_str(), obj->shapes_.size());
+                      new_poses.size(), object.id.c_str(), world_->getObject(object.id)->shapes_.size());
       return false;
     }
+
+    if (!object.subframe_poses.empty())
+    {
+      if (object.subframe_names.size() != object.subframe_poses.size())
+      {
+        ROS_ERROR_NAMED(LOGNAME, "Number of subframe names does not match number of subframe poses for object '%s'.",
+                        object.id.c_str());
+        return false;
+      }
+      moveit::core::FixedTransformsMap subframes;
+      Eigen::Isometry3d frame_pose;
+      for (std::size_t i = 0; i < object.subframe_poses.size(); ++i)
+      {
+        tf2::fromMsg(object.subframe_poses[i], frame_pose);
+        subframes[object.subframe_names[i]] = t * frame_pose;
+      }
+      world_->setSubframesOfObject(object.id, subframes);
+    }
     return true;
   }
 
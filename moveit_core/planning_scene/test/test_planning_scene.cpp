@@ -39,6 +39,7 @@
 #include <moveit/utils/message_checks.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <urdf_parser/urdf_parser.h>
+#include <octomap/octomap.h>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -119,6 +120,56 @@ TEST(PlanningScene, LoadRestoreDiff)
   EXPECT_EQ(ps->getCollisionEnvUnpadded()->getWorld()->size(), 2u);
 }
 
+TEST(PlanningScene, MoveDiffWithoutGeometry)
+{
+  urdf::ModelInterfaceSharedPtr urdf_model = moveit::core::loadModelInterface("pr2");
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  auto sender = std::make_shared<planning_scene::PlanningScene>(urdf_model, srdf_model);
+  auto receiver = std::make_shared<planning_scene::PlanningScene>(urdf_model, srdf_model);
+
+  shapes::ShapeConstPtr box(new shapes::Box(0.1, 0.2, 0.3));
+  sender->getWorldNonConst()->addToObject("box", box, Eigen::Isometry3d::Identity());
+  moveit::core::FixedTransformsMap subframes;
+  subframes["corner"] = Eigen::Isometry3d(Eigen::Translation3d(0.05, 0.1, 0.15));
+  sender->getWorldNonConst()->setSubframesOfObject("box", subframes);
+
+  moveit_msgs::PlanningScene msg;
+  sender->getPlanningSceneMsg(msg);
+  receiver->setPlanningSceneMsg(msg);
+  const shapes::ShapeConstPtr received_box = receiver->getWorld()->getObject("box")->shapes_[0];
+  EXPECT_EQ(sender->getWorld()->getHash(), receiver->getWorld()->getHash());
+
+  /* a pure move is sent as MOVE operation without geometry */
+  planning_scene::PlanningScenePtr diff = sender->diff();
+  diff->getWorldNonConst()->moveObject("box", Eigen::Isometry3d(Eigen::Translation3d(1, 0, 0)));
+  diff->getPlanningSceneDiffMsg(msg);
+  ASSERT_EQ(msg.world.collision_objects.size(), 1u);
+  EXPECT_EQ(msg.world.collision_objects[0].operation, moveit_msgs::CollisionObject::MOVE);
+  EXPECT_TRUE(msg.world.collision_objects[0].primitives.empty());
+  EXPECT_EQ(msg.world.collision_objects[0].primitive_poses.size(), 1u);
+
+  /* the receiver keeps its shape and ends up with the same content */
+  EXPECT_TRUE(receiver->usePlanningSceneMsg(msg));
+  EXPECT_EQ(received_box, receiver->getWorld()->getObject("box")->shapes_[0]);
+  EXPECT_EQ(diff->getWorld()->getHash(), receiver->getWorld()->getHash());
+  EXPECT_TRUE(receiver->knowsFrameTransform("box/corner"));
+
+  /* re-adding identical geometry reuses the existing shape */
+  diff->getCollisionObjectMsg(msg.world.collision_objects[0], "box");
+  msg.world.collision_objects[0].primitive_poses[0].position.z = 1.0;
+  EXPECT_TRUE(receiver->processCollisionObjectMsg(msg.world.collision_objects[0]));
+  EXPECT_EQ(received_box, receiver->getWorld()->getObject("box")->shapes_[0]);
+
+  /* different geometry replaces the shape */
+  msg.world.collision_objects[0].primitives[0].dimensions[2] = 0.4;
+  EXPECT_TRUE(receiver->processCollisionObjectMsg(msg.world.collision_objects[0]));
+  const shapes::ShapeConstPtr changed_box = receiver->getWorld()->getObject("box")->shapes_[0];
+  EXPECT_NE(received_box, changed_box);
+  ASSERT_EQ(changed_box->type, shapes::BOX);
+  EXPECT_EQ(static_cast<const shapes::Box&>(*changed_box).size[2], 0.4);
+  EXPECT_EQ(static_cast<const shapes::Box&>(*received_box).size[2], 0.3);
+}
+
 TEST(PlanningScene, MakeAttachedDiff)
 {
   urdf::ModelInterfaceSharedPtr urdf_model = moveit::core::loadModelInterface("pr2");
@@ -212,6 +263,90 @@ TEST(PlanningScene, loadBadSceneGeometry)
   EXPECT_FALSE(ps->loadGeometryFromStream(malformed_scene_geometry));
 }
 
+TEST(PlanningScene, Hash)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model->getURDF(), robot_model->getSRDF());
+  const std::uint64_t initial_hash = ps->getHash();
+  EXPECT_EQ(initial_hash, ps->getHash());
+
+  // joint values are not part of the hash
+  ps->getCurrentStateNonConst().setToRandomPositions();
+  EXPECT_EQ(initial_hash, ps->getHash());
+
+  ps->getAllowedCollisionMatrixNonConst().setEntry("r_gripper_palm_link", "l_gripper_palm_link", true);
+  const std::uint64_t acm_hash = ps->getHash();
+  EXPECT_NE(initial_hash, acm_hash);
+  ps->getAllowedCollisionMatrixNonConst().removeEntry("r_gripper_palm_link", "l_gripper_palm_link");
+  EXPECT_EQ(initial_hash, ps->getHash());
+
+  ps->getCollisionEnvNonConst()->setLinkPadding("r_gripper_palm_link", 0.1);
+  const std::uint64_t padding_hash = ps->getHash();
+  EXPECT_NE(initial_hash, padding_hash);
+  EXPECT_NE(acm_hash, padding_hash);
+
+  moveit_msgs::AttachedCollisionObject att_obj;
+  att_obj.link_name = "r_wrist_roll_link";
+  att_obj.object.id = "sphere";
+  att_obj.object.operation = moveit_msgs::CollisionObject::ADD;
+  att_obj.object.header.frame_id = "r_wrist_roll_link";
+  att_obj.object.primitives.resize(1);
+  att_obj.object.primitives[0].type = shape_msgs::SolidPrimitive::SPHERE;
+  att_obj.object.primitives[0].dimensions.push_back(0.05);
+  att_obj.object.primitive_poses.resize(1);
+  att_obj.object.primitive_poses[0].orientation.w = 1.0;
+  ASSERT_TRUE(ps->processAttachedCollisionObjectMsg(att_obj));
+  const std::uint64_t attached_hash = ps->getHash();
+  EXPECT_NE(padding_hash, attached_hash);
+
+  // touch links are part of the attached body
+  att_obj.touch_links.push_back("r_gripper_palm_link");
+  ASSERT_TRUE(ps->processAttachedCollisionObjectMsg(att_obj));
+  EXPECT_NE(attached_hash, ps->getHash());
+  att_obj.object.operation = moveit_msgs::CollisionObject::REMOVE;
+  ASSERT_TRUE(ps->processAttachedCollisionObjectMsg(att_obj));
+  // the detached object is put into the world
+  EXPECT_NE(padding_hash, ps->getHash());
+  ps->getWorldNonConst()->removeObject("sphere");
+  EXPECT_EQ(padding_hash, ps->getHash());
+
+  // in-place updates of the octomap change the hash through their version, unless the octomap is left out
+  auto octree = std::make_shared<octomap::OcTree>(0.1);
+  ps->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 1);
+  const std::uint64_t octomap_hash = ps->getHash();
+  EXPECT_NE(padding_hash, octomap_hash);
+  EXPECT_EQ(padding_hash, ps->getHash(false));
+  octree->updateNode(octomap::point3d(1.0, 0.0, 0.0), true);
+  ps->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 2);
+  EXPECT_NE(octomap_hash, ps->getHash());
+  EXPECT_EQ(padding_hash, ps->getHash(false));
+}
+
+TEST(PlanningScene, SkipUnchangedOctomap)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model->getURDF(), robot_model->getSRDF());
+  auto octree = std::make_shared<octomap::OcTree>(0.1);
+  octree->updateNode(octomap::point3d(1.0, 0.0, 0.0), true);
+  EXPECT_TRUE(ps->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 1));
+
+  // the same version of the same tree does not modify the scene
+  planning_scene::PlanningScenePtr diff = ps->diff();
+  const std::uint64_t hash = diff->getHash();
+  EXPECT_FALSE(diff->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 1));
+  moveit_msgs::PlanningScene diff_msg;
+  diff->getPlanningSceneDiffMsg(diff_msg);
+  EXPECT_TRUE(diff_msg.world.octomap.header.frame_id.empty());
+  EXPECT_EQ(hash, diff->getHash());
+
+  // a new version is an in-place update, which is sent with the diff
+  octree->updateNode(octomap::point3d(2.0, 0.0, 0.0), true);
+  EXPECT_TRUE(diff->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 2));
+  diff->getPlanningSceneDiffMsg(diff_msg);
+  EXPECT_FALSE(diff_msg.world.octomap.header.frame_id.empty());
+  EXPECT_NE(hash, diff->getHash());
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,168 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace moveit
+{
+namespace tools
+{
+/** \brief Low-overhead tracer for timing spans of hot code paths.
+
+    Unlike Profiler, which aggregates statistics under a global lock, the tracer keeps the individual spans: every
+    thread writes completed spans into its own fixed-size ring buffer, so recording never takes a lock and never
+    allocates. Once a buffer is full, the oldest spans of that thread are overwritten. The recorded spans can be
+    exported in the Chrome trace event format, which both chrome://tracing and Perfetto (https://ui.perfetto.dev) load.
+
+    Tracing is disabled by default, in which case a span costs a single relaxed atomic load. If the environment
+    variable MOVEIT_TRACE_FILE is set, tracing is enabled at startup and the trace is written to that file when the
+    process exits. */
+class Tracer : private boost::noncopyable
+{
+public:
+  /** \brief A completed span. The name must point to a string with static storage duration (e.g. a literal). */
+  struct Span
+  {
+    const char* name;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+  };
+
+  /** \brief Records a span covering the lifetime of this instance, if tracing is enabled at construction time. */
+  class ScopedSpan
+  {
+  public:
+    explicit ScopedSpan(const char* name) : name_(name), begin_ns_(Tracer::isEnabled() ? Tracer::now() : 0)
+    {
+    }
+
+    ~ScopedSpan()
+    {
+      if (begin_ns_)
+        Tracer::instance().record(name_, begin_ns_, Tracer::now());
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+  private:
+    const char* name_;
+    std::uint64_t begin_ns_;
+  };
+
+  /** \brief Return the process-wide tracer */
+  static Tracer& instance();
+
+  /** \brief Check whether spans are currently being recorded */
+  static bool isEnabled()
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /** \brief Monotonic timestamp in nanoseconds, as used for recorded spans */
+  static std::uint64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /** \brief Start recording spans */
+  void enable();
+
+  /** \brief Stop recording spans. Spans recorded so far are kept until clear() is called. */
+  void disable();
+
+  /** \brief Set the number of spans kept per thread. Only affects threads that record their first span afterwards. */
+  void setBufferCapacity(std::size_t capacity);
+
+  /** \brief Return a copy of \e name that stays valid for the lifetime of the process, for use as a span name.
+      Repeated calls with the same name return the same pointer. This takes a lock, so only call it while tracing. */
+  const char* intern(const std::string& name);
+
+  /** \brief Record a completed span for the calling thread */
+  void record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns);
+
+  /** \brief Discard all spans recorded so far, and release the buffers of threads that have exited */
+  void clear();
+
+  /** \brief Return the spans currently held for each thread, oldest first */
+  std::vector<std::vector<Span>> getSpans() const;
+
+  /** \brief Write the recorded spans as a Chrome trace event JSON document */
+  void writeChromeTrace(std::ostream& out) const;
+
+  /** \brief Write the recorded spans as a Chrome trace event JSON document to \e filename. Return true on success. */
+  bool writeChromeTrace(const std::string& filename) const;
+
+private:
+  struct ThreadBuffer;
+  using ThreadBufferPtr = std::shared_ptr<ThreadBuffer>;
+
+  Tracer();
+  ~Tracer();
+
+  ThreadBuffer& getThreadBuffer();
+  std::vector<std::vector<Span>> getSpans(std::vector<std::uint32_t>& thread_ids) const;
+
+  static std::atomic<bool> enabled_;
+
+  mutable std::mutex buffers_lock_;
+  std::vector<ThreadBufferPtr> buffers_;
+  std::size_t buffer_capacity_;
+  std::uint32_t next_thread_id_;
+  std::string output_file_;
+
+  std::mutex names_lock_;
+  std::unordered_set<std::string> names_;
+};
+}  // namespace tools
+}  // namespace moveit
+
+#define MOVEIT_TRACE_CONCAT_IMPL(a, b) a##b
+#define MOVEIT_TRACE_CONCAT(a, b) MOVEIT_TRACE_CONCAT_IMPL(a, b)
+
+/** \brief Trace the enclosing scope under \e name, which must be a string literal */
+#define MOVEIT_TRACE_SCOPE(name)                                                                                       \
+  ::moveit::tools::Tracer::ScopedSpan MOVEIT_TRACE_CONCAT(moveit_trace_span_, __LINE__)(name)
@@ -0,0 +1,279 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/profiler/tracer.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <unistd.h>
+
+namespace moveit
+{
+namespace tools
+{
+namespace
+{
+constexpr const char* LOGNAME = "tracer";
+constexpr std::size_t DEFAULT_BUFFER_CAPACITY = 16384;
+
+void writeJsonString(std::ostream& out, const char* str)
+{
+  out << '"';
+  for (; *str; ++str)
+  {
+    if (*str == '"' || *str == '\\')
+      out << '\\' << *str;
+    else if (static_cast<unsigned char>(*str) >= 0x20)
+      out << *str;
+  }
+  out << '"';
+}
+}  // namespace
+
+// Single-producer ring buffer. The owning thread is the only writer; readers may run concurrently and use the write
+// count to discard slots that may have been overwritten while they were copied. All slot fields are atomics, so a
+// concurrent read is never a data race, only potentially stale.
+struct Tracer::ThreadBuffer
+{
+  struct Slot
+  {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<std::uint64_t> begin_ns{ 0 };
+    std::atomic<std::uint64_t> end_ns{ 0 };
+  };
+
+  ThreadBuffer(std::size_t capacity, std::uint32_t thread_id)
+    : slots(new Slot[capacity]), capacity(capacity), thread_id(thread_id)
+  {
+  }
+
+  std::unique_ptr<Slot[]> slots;
+  const std::size_t capacity;
+  const std::uint32_t thread_id;
+
+  // number of spans ever written to this buffer
+  std::atomic<std::uint64_t> written{ 0 };
+  // spans with an index below this one have been cleared
+  std::atomic<std::uint64_t> first_valid{ 0 };
+};
+
+std::atomic<bool> Tracer::enabled_{ false };
+
+Tracer& Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() : buffer_capacity_(DEFAULT_BUFFER_CAPACITY), next_thread_id_(1)
+{
+  if (const char* file = std::getenv("MOVEIT_TRACE_FILE"))
+  {
+    output_file_ = file;
+    if (!output_file_.empty())
+      enable();
+  }
+}
+
+Tracer::~Tracer()
+{
+  if (!output_file_.empty())
+  {
+    disable();
+    writeChromeTrace(output_file_);
+  }
+}
+
+void Tracer::enable()
+{
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::disable()
+{
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::setBufferCapacity(std::size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(buffers_lock_);
+  buffer_capacity_ = std::max<std::size_t>(capacity, 1);
+}
+
+Tracer::ThreadBuffer& Tracer::getThreadBuffer()
+{
+  // The registry keeps its own reference, so the spans of a thread survive until they are cleared
+  thread_local ThreadBufferPtr buffer;
+  if (!buffer)
+  {
+    std::lock_guard<std::mutex> lock(buffers_lock_);
+    buffer = std::make_shared<ThreadBuffer>(buffer_capacity_, next_thread_id_++);
+    buffers_.push_back(buffer);
+  }
+  return *buffer;
+}
+
+const char* Tracer::intern(const std::string& name)
+{
+  // the nodes of an unordered set are never moved, so the returned pointers stay valid
+  std::lock_guard<std::mutex> lock(names_lock_);
+  return names_.insert(name).first->c_str();
+}
+
+void Tracer::record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns)
+{
+  ThreadBuffer& buffer = getThreadBuffer();
+  const std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+  // Orders the previous update of the write count before the slot is overwritten, so a reader that sees any of the
+  // new slot values also sees a write count that marks the old span in this slot as lost
+  std::atomic_thread_fence(std::memory_order_release);
+  ThreadBuffer::Slot& slot = buffer.slots[index % buffer.capacity];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+  slot.end_ns.store(end_ns, std::memory_order_relaxed);
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::clear()
+{
+  std::lock_guard<std::mutex> lock(buffers_lock_);
+  for (const ThreadBufferPtr& buffer : buffers_)
+    buffer->first_valid.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+  // buffers only referenced by the registry belong to threads that have exited
+  buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                [](const ThreadBufferPtr& buffer) { return buffer.use_count() == 1; }),
+                 buffers_.end());
+}
+
+std::vector<std::vector<Tracer::Span>> Tracer::getSpans() const
+{
+  std::vector<std::uint32_t> thread_ids;
+  return getSpans(thread_ids);
+}
+
+std::vector<std::vector<Tracer::Span>> Tracer::getSpans(std::vector<std::uint32_t>& thread_ids) const
+{
+  std::vector<ThreadBufferPtr> buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffers_lock_);
+    buffers = buffers_;
+  }
+
+  std::vector<std::vector<Span>> result;
+  result.reserve(buffers.size());
+  thread_ids.clear();
+  for (const ThreadBufferPtr& buffer : buffers)
+  {
+    thread_ids.push_back(buffer->thread_id);
+    const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+    std::uint64_t begin = buffer->first_valid.load(std::memory_order_relaxed);
+    if (written > buffer->capacity)
+      begin = std::max<std::uint64_t>(begin, written - buffer->capacity);
+
+    std::vector<Span> spans;
+    spans.reserve(written > begin ? written - begin : 0);
+    for (std::uint64_t i = begin; i < written; ++i)
+    {
+      const ThreadBuffer::Slot& slot = buffer->slots[i % buffer->capacity];
+      spans.push_back({ slot.name.load(std::memory_order_relaxed), slot.begin_ns.load(std::memory_order_relaxed),
+                        slot.end_ns.load(std::memory_order_relaxed) });
+    }
+
+    // drop the spans the owning thread may have overwritten while they were being copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t written_after = buffer->written.load(std::memory_order_relaxed);
+    if (written_after >= begin + buffer->capacity)
+    {
+      const std::size_t lost = std::min<std::uint64_t>(written_after - buffer->capacity + 1 - begin, spans.size());
+      spans.erase(spans.begin(), spans.begin() + lost);
+    }
+    result.push_back(std::move(spans));
+  }
+  return result;
+}
+
+void Tracer::writeChromeTrace(std::ostream& out) const
+{
+  std::vector<std::uint32_t> thread_ids;
+  const std::vector<std::vector<Span>> spans = getSpans(thread_ids);
+
+  const int pid = ::getpid();
+  const std::ios_base::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+
+  // timestamps and durations are in microseconds
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  for (std::size_t i = 0; i < spans.size(); ++i)
+    for (const Span& span : spans[i])
+    {
+      if (!span.name)
+        continue;
+      out << (first ? "\n" : ",\n") << "{\"name\":";
+      writeJsonString(out, span.name);
+      out << ",\"cat\":\"moveit\",\"ph\":\"X\",\"ts\":" << span.begin_ns * 1e-3
+          << ",\"dur\":" << (span.end_ns - span.begin_ns) * 1e-3 << ",\"pid\":" << pid << ",\"tid\":" << thread_ids[i]
+          << "}";
+      first = false;
+    }
+  out << "\n]}\n";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+bool Tracer::writeChromeTrace(const std::string& filename) const
+{
+  std::ofstream out(filename.c_str());
+  if (!out.good())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Unable to open '%s' for writing the trace", filename.c_str());
+    return false;
+  }
+  writeChromeTrace(out);
+  out.close();
+  if (out.fail())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to write the trace to '%s'", filename.c_str());
+    return false;
+  }
+  return true;
+}
+}  // namespace tools
+}  // namespace moveit
@@ -0,0 +1,162 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/profiler/tracer.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using moveit::tools::Tracer;
+
+namespace
+{
+// Return the spans recorded by the calling thread, assuming it is the only one that recorded any
+std::vector<Tracer::Span> getRecordedSpans()
+{
+  std::vector<Tracer::Span> result;
+  for (const std::vector<Tracer::Span>& spans : Tracer::instance().getSpans())
+    result.insert(result.end(), spans.begin(), spans.end());
+  return result;
+}
+
+std::size_t countOccurrences(const std::string& str, const std::string& pattern)
+{
+  std::size_t count = 0;
+  for (std::size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+    ++count;
+  return count;
+}
+
+class TracerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    Tracer::instance().clear();
+    Tracer::instance().enable();
+  }
+
+  void TearDown() override
+  {
+    Tracer::instance().disable();
+    Tracer::instance().clear();
+  }
+};
+}  // namespace
+
+TEST_F(TracerTest, NestedSpans)
+{
+  {
+    MOVEIT_TRACE_SCOPE("outer");
+    {
+      MOVEIT_TRACE_SCOPE("inner");
+    }
+  }
+
+  // spans are recorded when they end, so the inner one comes first
+  const std::vector<Tracer::Span> spans = getRecordedSpans();
+  ASSERT_EQ(spans.size(), 2u);
+  EXPECT_STREQ(spans[0].name, "inner");
+  EXPECT_STREQ(spans[1].name, "outer");
+  EXPECT_LE(spans[1].begin_ns, spans[0].begin_ns);
+  EXPECT_LE(spans[0].begin_ns, spans[0].end_ns);
+  EXPECT_LE(spans[0].end_ns, spans[1].end_ns);
+}
+
+TEST_F(TracerTest, DisabledTracerRecordsNothing)
+{
+  Tracer::instance().disable();
+  {
+    MOVEIT_TRACE_SCOPE("ignored");
+  }
+  EXPECT_TRUE(getRecordedSpans().empty());
+}
+
+TEST_F(TracerTest, RingBufferKeepsNewestSpans)
+{
+  // the capacity only applies to threads that record their first span afterwards
+  Tracer::instance().setBufferCapacity(4);
+  std::thread thread([] {
+    for (std::uint64_t i = 1; i <= 10; ++i)
+      Tracer::instance().record("span", i, i + 1);
+  });
+  thread.join();
+
+  // a reader skips the slot the next span of the thread would overwrite, so it may see one span less
+  const std::vector<Tracer::Span> spans = getRecordedSpans();
+  ASSERT_GE(spans.size(), 3u);
+  ASSERT_LE(spans.size(), 4u);
+  for (std::size_t i = 0; i < spans.size(); ++i)
+    EXPECT_EQ(spans[i].begin_ns, 11 - spans.size() + i);
+
+  // clearing drops both the spans and the buffer of the finished thread
+  Tracer::instance().clear();
+  EXPECT_TRUE(getRecordedSpans().empty());
+}
+
+TEST_F(TracerTest, InternedNames)
+{
+  const char* name = Tracer::instance().intern(std::string("adapter"));
+  EXPECT_STREQ(name, "adapter");
+  EXPECT_EQ(Tracer::instance().intern("adapter"), name);
+  EXPECT_NE(Tracer::instance().intern("other adapter"), name);
+}
+
+TEST_F(TracerTest, ChromeTraceExport)
+{
+  Tracer::instance().record("plan", 1000, 3500);
+  Tracer::instance().record("quoted \"name\"", 2000, 2500);
+
+  std::stringstream out;
+  Tracer::instance().writeChromeTrace(out);
+  const std::string json = out.str();
+
+  EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+  EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+  EXPECT_EQ(countOccurrences(json, "\"ph\":\"X\""), 2u);
+  // timestamps and durations are in microseconds
+  EXPECT_NE(json.find("{\"name\":\"plan\",\"cat\":\"moveit\",\"ph\":\"X\",\"ts\":1.000,\"dur\":2.500,"),
+            std::string::npos);
+  EXPECT_NE(json.find("{\"name\":\"quoted \\\"name\\\"\",\"cat\":\"moveit\",\"ph\":\"X\",\"ts\":2.000,\"dur\":0.500,"),
+            std::string::npos);
+  // events are separated by commas, without a trailing one
+  EXPECT_EQ(countOccurrences(json, "},\n{"), 1u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -401,6 +401,11 @@ public:
   }
   double getMaximumExtent(const JointBoundsVector& active_joint_bounds) const;
 
+  /** \brief Compute the distance between two group states, the sum of the active joints' distances weighted by their
+      distance factors.
+
+      For groups made only of single-variable revolute and prismatic joints, this and interpolate() run as a single
+      vectorized loop over the group state instead of a virtual call per joint. */
   double distance(const double* state1, const double* state2) const;
   void interpolate(const double* from, const double* to, double t, double* state) const;
 
@@ -719,6 +724,18 @@ protected:
 
   bool is_single_dof_;
 
+  /** \brief True if all active joints are single-variable revolute or prismatic joints, stored in order at the start
+      of the group state, so that distance(), interpolate() and enforcePositionBounds() can process all variables in
+      one loop */
+  bool has_uniform_active_joints_;
+
+  /** \brief The distance factors of the active variables, if has_uniform_active_joints_ */
+  Eigen::ArrayXd active_variable_distance_factors_;
+
+  /** \brief 1.0 for the active variables of continuous joints, 0.0 otherwise, if has_uniform_active_joints_.
+      Used to blend in the wrap-around of continuous joints without branching per variable. */
+  Eigen::ArrayXd active_variable_continuous_mask_;
+
   struct GroupMimicUpdate
   {
     GroupMimicUpdate(int s, int d, double f, double o) : src(s), dest(d), factor(f), offset(o)
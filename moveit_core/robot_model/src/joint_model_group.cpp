@@ -40,6 +40,7 @@
 #include <moveit/robot_model/revolute_joint_model.h>
 #include <moveit/exceptions/exceptions.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
 #include <algorithm>
 #include "order_robot_model_items.inc"
 
@@ -108,6 +109,7 @@ JointModelGroup::JointModelGroup(const std::string& group_name, const srdf::Mode
   , is_contiguous_index_list_(true)
   , is_chain_(false)
   , is_single_dof_(true)
+  , has_uniform_active_joints_(false)
   , config_(config)
 {
   // sort joints in Depth-First order
@@ -160,6 +162,29 @@ JointModelGroup::JointModelGroup(const std::string& group_name, const srdf::Mode
       fixed_joints_.push_back(joint_model);
   }
 
+  // groups of single-variable revolute and prismatic joints (the typical arm) get vectorized distance and
+  // interpolation; this requires the active variables to come first and in order in the group state
+  has_uniform_active_joints_ = !active_joint_model_vector_.empty();
+  for (std::size_t i = 0; i < active_joint_model_vector_.size() && has_uniform_active_joints_; ++i)
+    has_uniform_active_joints_ = active_joint_model_start_index_[i] == static_cast<int>(i) &&
+                                 (active_joint_model_vector_[i]->getType() == JointModel::REVOLUTE ||
+                                  active_joint_model_vector_[i]->getType() == JointModel::PRISMATIC);
+  if (has_uniform_active_joints_)
+  {
+    active_variable_distance_factors_.resize(active_joint_model_vector_.size());
+    active_variable_continuous_mask_.resize(active_joint_model_vector_.size());
+    for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+    {
+      const JointModel* joint_model = active_joint_model_vector_[i];
+      active_variable_distance_factors_[i] = joint_model->getDistanceFactor();
+      active_variable_continuous_mask_[i] =
+          joint_model->getType() == JointModel::REVOLUTE &&
+                  static_cast<const RevoluteJointModel*>(joint_model)->isContinuous() ?
+              1.0 :
+              0.0;
+    }
+  }
+
   // now we need to find all the set of joints within this group
   // that root distinct subtrees
   for (const JointModel* active_joint_model : active_joint_model_vector_)
@@ -388,10 +413,37 @@ bool JointModelGroup::enforcePositionBounds(double* state, const JointBoundsVect
 {
   assert(active_joint_bounds.size() == active_joint_model_vector_.size());
   bool change = false;
-  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
-    if (active_joint_model_vector_[i]->enforcePositionBounds(state + active_joint_model_start_index_[i],
-                                                             *active_joint_bounds[i]))
-      change = true;
+  if (has_uniform_active_joints_)
+  {
+    // clamp the bounded variables inline; only continuous joints need the joint model to wrap them
+    for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+    {
+      if (active_variable_continuous_mask_[i] != 0.0)
+      {
+        if (active_joint_model_vector_[i]->enforcePositionBounds(state + i, *active_joint_bounds[i]))
+          change = true;
+        continue;
+      }
+      const VariableBounds& bounds = active_joint_bounds[i]->front();
+      if (state[i] < bounds.min_position_)
+      {
+        state[i] = bounds.min_position_;
+        change = true;
+      }
+      else if (state[i] > bounds.max_position_)
+      {
+        state[i] = bounds.max_position_;
+        change = true;
+      }
+    }
+  }
+  else
+  {
+    for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+      if (active_joint_model_vector_[i]->enforcePositionBounds(state + active_joint_model_start_index_[i],
+                                                               *active_joint_bounds[i]))
+        change = true;
+  }
   if (change)
     updateMimicJoints(state);
   return change;
@@ -408,6 +460,21 @@ double JointModelGroup::getMaximumExtent(const JointBoundsVector& active_joint_b
 
 double JointModelGroup::distance(const double* state1, const double* state2) const
 {
+  if (has_uniform_active_joints_)
+  {
+    const Eigen::Map<const Eigen::ArrayXd> from(state1, active_variable_distance_factors_.size());
+    const Eigen::Map<const Eigen::ArrayXd> to(state2, active_variable_distance_factors_.size());
+    const auto d = (from - to).abs();
+    if (continuous_joint_model_vector_.empty())
+      return (active_variable_distance_factors_ * d).sum();
+
+    // for continuous joints, take the shorter way around the circle, as RevoluteJointModel::distance() does
+    const double TWO_PI = 2.0 * boost::math::constants::pi<double>();
+    const auto& mask = active_variable_continuous_mask_;
+    const auto wrapped = d - TWO_PI * (d * (1.0 / TWO_PI)).floor();
+    return (active_variable_distance_factors_ * ((1.0 - mask) * d + mask * wrapped.min(TWO_PI - wrapped).abs())).sum();
+  }
+
   double d = 0.0;
   for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
     d += active_joint_model_vector_[i]->getDistanceFactor() *
@@ -419,10 +486,29 @@ double JointModelGroup::distance(const double* state1, const double* state2) con
 void JointModelGroup::interpolate(const double* from, const double* to, double t, double* state) const
 {
   // we interpolate values only for active joint models (non-mimic)
-  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
-    active_joint_model_vector_[i]->interpolate(from + active_joint_model_start_index_[i],
-                                               to + active_joint_model_start_index_[i], t,
-                                               state + active_joint_model_start_index_[i]);
+  if (has_uniform_active_joints_)
+  {
+    const Eigen::Map<const Eigen::ArrayXd> a(from, active_variable_distance_factors_.size());
+    const Eigen::Map<const Eigen::ArrayXd> b(to, active_variable_distance_factors_.size());
+    Eigen::Map<Eigen::ArrayXd> result(state, active_variable_distance_factors_.size());
+    const auto diff = b - a;
+    if (continuous_joint_model_vector_.empty())
+      result = a + diff * t;
+    else
+    {
+      // continuous joints more than pi apart go the other way around and are wrapped back into (-pi, pi], as in
+      // RevoluteJointModel::interpolate(); a single expression keeps this correct if state aliases from or to
+      const double PI = boost::math::constants::pi<double>();
+      const auto wrap = active_variable_continuous_mask_ * (diff.abs() > PI).cast<double>();
+      const auto unwrapped = a + (diff - wrap * diff.sign() * (2.0 * PI)) * t;
+      result = unwrapped - wrap * ((unwrapped > PI).cast<double>() - (unwrapped < -PI).cast<double>()) * (2.0 * PI);
+    }
+  }
+  else
+    for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+      active_joint_model_vector_[i]->interpolate(from + active_joint_model_start_index_[i],
+                                                 to + active_joint_model_start_index_[i], t,
+                                                 state + active_joint_model_start_index_[i]);
 
   // now we update mimic as needed
   updateMimicJoints(state);
@@ -41,6 +41,7 @@
 #include <boost/filesystem/path.hpp>
 #include <moveit/profiler/profiler.h>
 #include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
 
 class LoadPlanningModelsPr2 : public testing::Test
 {
@@ -82,6 +83,69 @@ TEST_F(LoadPlanningModelsPr2, Model)
   moveit::tools::Profiler::Status();
 }
 
+TEST_F(LoadPlanningModelsPr2, GroupDistanceInterpolateBounds)
+{
+  // compare the group functions with the per-joint computations, for groups of revolute (some continuous), prismatic
+  // and multi-dof joints
+  random_numbers::RandomNumberGenerator rng(3);
+  for (const moveit::core::JointModelGroup* jmg : robot_model_->getJointModelGroups())
+  {
+    std::vector<double> a, b, state(jmg->getVariableCount());
+    for (int i = 0; i < 100; ++i)
+    {
+      jmg->getVariableRandomPositions(rng, a);
+      jmg->getVariableRandomPositions(rng, b);
+      const double t = rng.uniform01();
+
+      double distance = 0.0;
+      std::vector<double> interpolated = a;
+      for (const moveit::core::JointModel* joint : jmg->getActiveJointModels())
+      {
+        const int idx = jmg->getVariableGroupIndex(joint->getName());
+        distance += joint->getDistanceFactor() * joint->distance(&a[idx], &b[idx]);
+        joint->interpolate(&a[idx], &b[idx], t, &interpolated[idx]);
+      }
+      EXPECT_NEAR(jmg->distance(a.data(), b.data()), distance, 1e-12) << jmg->getName();
+      jmg->interpolate(a.data(), b.data(), t, state.data());
+      for (const moveit::core::JointModel* joint : jmg->getActiveJointModels())
+      {
+        const int idx = jmg->getVariableGroupIndex(joint->getName());
+        for (std::size_t j = 0; j < joint->getVariableCount(); ++j)
+          EXPECT_NEAR(state[idx + j], interpolated[idx + j], 1e-12) << jmg->getName() << " " << joint->getName();
+      }
+
+      // interpolating single-variable joints in place gives the same result
+      std::vector<double> in_place = a;
+      jmg->interpolate(in_place.data(), b.data(), t, in_place.data());
+      for (const moveit::core::JointModel* joint : jmg->getActiveJointModels())
+      {
+        const int idx = jmg->getVariableGroupIndex(joint->getName());
+        if (joint->getVariableCount() == 1)
+          EXPECT_EQ(in_place[idx], state[idx]) << jmg->getName() << " " << joint->getName();
+      }
+
+      // out of bounds values are clamped, resp. wrapped for continuous joints
+      std::vector<double> out_of_bounds = a;
+      for (double& value : out_of_bounds)
+        value = 4.0 * value + 7.0;
+      std::vector<double> enforced = out_of_bounds;
+      bool changed = false;
+      for (const moveit::core::JointModel* joint : jmg->getActiveJointModels())
+      {
+        const int idx = jmg->getVariableGroupIndex(joint->getName());
+        changed |= joint->enforcePositionBounds(&enforced[idx]);
+      }
+      EXPECT_EQ(jmg->enforcePositionBounds(out_of_bounds.data()), changed) << jmg->getName();
+      for (const moveit::core::JointModel* joint : jmg->getActiveJointModels())
+      {
+        const int idx = jmg->getVariableGroupIndex(joint->getName());
+        for (std::size_t j = 0; j < joint->getVariableCount(); ++j)
+          EXPECT_EQ(out_of_bounds[idx + j], enforced[idx + j]) << jmg->getName() << " " << joint->getName();
+      }
+    }
+  }
+}
+
 TEST(SiblingAssociateLinks, SimpleYRobot)
 {
   /* base_link - a - b - c
@@ -86,6 +86,19 @@ struct MaxEEFStep
   double rotation;     // Radians
 };
 
+/** \brief Struct for containing the precision of the adaptive variant of computeCartesianPath
+
+    Between two consecutive states of the path, the link is assumed to follow the joint-space interpolation of the
+    states. A step is bisected while the link deviates from the straight Cartesian path by more than \e translational
+    or \e rotational in the middle of the step, or while a joint moves by more than the absolute jump thresholds.
+    Steps are not bisected below \e max_resolution, given as a fraction of the path. */
+struct CartesianPrecision
+{
+  double translational = 0.001;  // Meters
+  double rotational = 0.01;      // Radians
+  double max_resolution = 1e-5;  // Fraction of the path
+};
+
 class CartesianInterpolator
 {
   // TODO(mlautman): Eventually, this planner should be moved out of robot_state
@@ -157,6 +170,42 @@ public:
                        const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
                        const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
 
+  /** \brief Compute a straight Cartesian path to \e target with adaptive step sizes.
+
+     The path is first divided into coarse steps according to \e max_step. Each step is bisected only where needed
+     to meet \e precision: if the IK solution cannot be found from the previous state, if the joint-space
+     interpolation between the two states deviates too much from the Cartesian path, or if a joint moves by more than
+     the absolute thresholds of \e jump_threshold. Every IK call is seeded with the previous state of the path.
+
+     Absolute joint-space jumps are detected during the computation: if a step still violates them, or still deviates
+     from the Cartesian path, at the resolution limit, the computation stops there instead of computing the remaining
+     path first. Relative jumps can only be detected on the complete path and are tested afterwards. As the steps
+     differ in size, the joint-space distance of each step is compared to the average joint-space distance per
+     Cartesian distance, scaled by the Cartesian size of the step.
+
+     The returned value is the fraction of the path that was computed. All other comments of the fixed-step variant
+     apply. */
+  static double
+  computeCartesianPath(RobotState* start_state, const JointModelGroup* group,
+                       std::vector<std::shared_ptr<RobotState>>& traj, const LinkModel* link,
+                       const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
+                       const CartesianPrecision& precision, const JumpThreshold& jump_threshold,
+                       const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+                       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
+
+  /** \brief Compute a Cartesian path through \e waypoints with adaptive step sizes.
+
+     Each segment between two waypoints is computed as in the adaptive variant for a single target. Relative jumps
+     are tested on the complete path. Like the single-target variant, \e traj is cleared first. */
+  static double
+  computeCartesianPath(RobotState* start_state, const JointModelGroup* group,
+                       std::vector<std::shared_ptr<RobotState>>& traj, const LinkModel* link,
+                       const EigenSTL::vector_Isometry3d& waypoints, bool global_reference_frame,
+                       const MaxEEFStep& max_step, const CartesianPrecision& precision,
+                       const JumpThreshold& jump_threshold,
+                       const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+                       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
+
   /** \brief Tests joint space jumps of a trajectory.
 
      If \e jump_threshold_factor is non-zero, we test for relative jumps.
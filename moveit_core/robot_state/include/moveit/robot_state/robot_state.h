@@ -45,6 +45,7 @@
 #include <std_msgs/ColorRGBA.h>
 #include <geometry_msgs/Twist.h>
 #include <cassert>
+#include <cstring>
 
 #include <boost/assert.hpp>
 
@@ -1693,6 +1694,21 @@ public:
   /** \brief Check if a transformation matrix from the model frame (root of model) to frame \e frame_id is known */
   bool knowsFrameTransform(const std::string& frame_id) const;
 
+  /** \brief Resolve the frame \e frame_id to the link that it is defined relative to
+   *
+   * The frame can be the model frame, a link, an attached body or a subframe of an attached body.
+   * A link resolves to itself, an attached body or subframe to the link the body is attached to. Unlike
+   * RobotModel::getRigidlyConnectedParentLinkModel(), this does not walk up fixed joints.
+   * Its pose relative to the returned link does not depend on the joint values, so a frame that is needed for many
+   * states can be resolved once and then be computed as getGlobalLinkTransform(link) * \e transform, without
+   * looking up its name again. The resolution stays valid until the attached bodies change.
+   * The link transforms of this state do not need to be up to date.
+   *
+   * @param frame_id The frame to resolve
+   * @param transform If not NULL, receives the pose of the frame relative to the returned link
+   * @return The link, or NULL if the frame is not known */
+  const LinkModel* resolveFrameToLink(const std::string& frame_id, Eigen::Isometry3d* transform = nullptr) const;
+
   /** @brief Get a MarkerArray that fully describes the robot markers for a given robot.
    *  @param arr The returned marker array
    *  @param link_names The list of link names for which the markers should be created.
@@ -1757,9 +1773,14 @@ private:
   void initTransforms();
   void copyFrom(const RobotState& other);
 
+  /** \brief Get the attached body that has the subframe \e frame_id ("body name/subframe name"), or NULL.
+   * The body is looked up directly by the prefixes of \e frame_id, not by visiting all attached bodies. */
+  const AttachedBody* getAttachedBodyWithSubframe(const std::string& frame_id) const;
+
   void markDirtyJointTransforms(const JointModel* joint)
   {
     dirty_joint_transforms_[joint->getJointIndex()] = 1;
+    dirty_link_subtrees_[joint->getJointIndex()] = 1;
     dirty_link_transforms_ =
         dirty_link_transforms_ == nullptr ? joint : robot_model_->getCommonRoot(dirty_link_transforms_, joint);
   }
@@ -1767,12 +1788,20 @@ private:
   void markDirtyJointTransforms(const JointModelGroup* group)
   {
     for (const JointModel* jm : group->getActiveJointModels())
-      dirty_joint_transforms_[jm->getJointIndex()] = 1;
+      dirty_joint_transforms_[jm->getJointIndex()] = dirty_link_subtrees_[jm->getJointIndex()] = 1;
     dirty_link_transforms_ = dirty_link_transforms_ == nullptr ?
                                  group->getCommonRoot() :
                                  robot_model_->getCommonRoot(dirty_link_transforms_, group->getCommonRoot());
   }
 
+  /** \brief Mark all joint transforms dirty and the link transforms of the whole tree, after all variables changed */
+  void markDirtyAllTransforms()
+  {
+    memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
+    dirty_link_transforms_ = robot_model_->getRootJoint();
+    dirty_link_subtrees_[dirty_link_transforms_->getJointIndex()] = 1;
+  }
+
   void markVelocity();
   void markAcceleration();
   void markEffort();
@@ -1795,10 +1824,10 @@ private:
     {
       const int fvi = jm->getFirstVariableIndex();
       position_[fvi] = jm->getMimicFactor() * position_[jm->getMimic()->getFirstVariableIndex()] + jm->getMimicOffset();
-      // Only mark joint transform dirty, but not the associated link transform
+      // Only mark joint transform and its link subtree dirty, but not the associated link transform
       // as this function is always used in combination of
       // updateMimicJoint(group->getMimicJointModels()) + markDirtyJointTransforms(group);
-      dirty_joint_transforms_[jm->getJointIndex()] = 1;
+      dirty_joint_transforms_[jm->getJointIndex()] = dirty_link_subtrees_[jm->getJointIndex()] = 1;
     }
   }
 
@@ -1814,8 +1843,16 @@ private:
     markDirtyJointTransforms(group);
   }
 
+  /** \brief Recompute the link transforms below \e start, if that joint is marked in dirty_link_subtrees_ */
+  void updateDirtyLinkSubtree(const JointModel* start);
+
   void updateLinkTransformsInternal(const JointModel* start);
 
+  /** \brief Recompute the global transforms of the bodies attached to links below the joint \e start.
+   *
+   * The transforms of bodies attached elsewhere are left untouched, as their links have not moved. */
+  void updateAttachedBodyTransforms(const JointModel* start);
+
   void getMissingKeys(const std::map<std::string, double>& variable_map,
                       std::vector<std::string>& missing_variables) const;
   void getStateTreeJointString(std::ostream& ss, const JointModel* jm, const std::string& pfx0, bool last) const;
@@ -1850,6 +1887,8 @@ private:
   Eigen::Isometry3d* global_link_transforms_;            ///< Transforms from model frame to link frame for each link
   Eigen::Isometry3d* global_collision_body_transforms_;  ///< Transforms from model frame to collision bodies
   unsigned char* dirty_joint_transforms_;
+  /// Joints whose subtree of link transforms needs an update. dirty_link_transforms_ is their common root.
+  unsigned char* dirty_link_subtrees_;
 
   /** \brief All attached bodies that are part of this state, indexed by their name */
   std::map<std::string, AttachedBody*> attached_body_map_;
@@ -51,6 +51,228 @@ static const std::size_t MIN_STEPS_FOR_JUMP_THRESH = 10;
 
 const std::string LOGNAME = "cartesian_interpolator";
 
+namespace
+{
+// To limit absolute joint-space jumps, we pass consistency limits to the IK solver
+std::vector<double> computeConsistencyLimits(const JointModelGroup* group, const JumpThreshold& jump_threshold)
+{
+  std::vector<double> consistency_limits;
+  if (jump_threshold.prismatic > 0 || jump_threshold.revolute > 0)
+    for (const JointModel* jm : group->getActiveJointModels())
+    {
+      double limit;
+      switch (jm->getType())
+      {
+        case JointModel::REVOLUTE:
+          limit = jump_threshold.revolute;
+          break;
+        case JointModel::PRISMATIC:
+          limit = jump_threshold.prismatic;
+          break;
+        default:
+          limit = 0.0;
+      }
+      if (limit == 0.0)
+        limit = jm->getMaximumExtent();
+      consistency_limits.push_back(limit);
+    }
+  return consistency_limits;
+}
+
+// Whether any revolute or prismatic joint moves by more than the absolute jump thresholds between two states
+bool hasAbsoluteJointSpaceJump(const JointModelGroup* group, const RobotState& from, const RobotState& to,
+                               const JumpThreshold& jump_threshold)
+{
+  for (const JointModel* joint : group->getActiveJointModels())
+  {
+    double threshold;
+    switch (joint->getType())
+    {
+      case JointModel::REVOLUTE:
+        threshold = jump_threshold.revolute;
+        break;
+      case JointModel::PRISMATIC:
+        threshold = jump_threshold.prismatic;
+        break;
+      default:
+        continue;
+    }
+    if (threshold > 0.0 && from.distance(to, joint) > threshold)
+      return true;
+  }
+  return false;
+}
+
+// Compute a path to target with adaptive step sizes, as documented for CartesianInterpolator::computeCartesianPath(),
+// without relative jump detection. For each step after the start state, the fraction of the path it reaches and its
+// Cartesian size in units of max_step are appended to percentages and step_sizes.
+double computeAdaptiveCartesianPath(RobotState* start_state, const JointModelGroup* group,
+                                    std::vector<RobotStatePtr>& traj, const LinkModel* link,
+                                    const Eigen::Isometry3d& target, bool global_reference_frame,
+                                    const MaxEEFStep& max_step, const CartesianPrecision& precision,
+                                    const JumpThreshold& jump_threshold,
+                                    const GroupStateValidityCallbackFn& validCallback,
+                                    const kinematics::KinematicsQueryOptions& options, std::vector<double>& percentages,
+                                    std::vector<double>& step_sizes)
+{
+  const std::vector<const JointModel*>& cjnt = group->getContinuousJointModels();
+  // make sure that continuous joints wrap
+  for (const JointModel* joint : cjnt)
+    start_state->enforceBounds(joint);
+
+  // this is the Cartesian pose we start from, and we move in the direction indicated
+  // getGlobalLinkTransform() returns a valid isometry by contract
+  Eigen::Isometry3d start_pose = start_state->getGlobalLinkTransform(link);  // valid isometry
+
+  ASSERT_ISOMETRY(target)  // unsanitized input, could contain a non-isometry
+
+  // the target can be in the local reference frame (in which case we rotate it)
+  Eigen::Isometry3d rotated_target = global_reference_frame ? target : start_pose * target;  // valid isometry
+
+  Eigen::Quaterniond start_quaternion(start_pose.linear());
+  Eigen::Quaterniond target_quaternion(rotated_target.linear());
+
+  if (max_step.translation <= 0.0 && max_step.rotation <= 0.0)
+  {
+    ROS_ERROR_NAMED(LOGNAME,
+                    "Invalid MaxEEFStep passed into computeCartesianPath. Both the MaxEEFStep.rotation and "
+                    "MaxEEFStep.translation components must be non-negative and at least one component must be "
+                    "greater than zero");
+    return 0.0;
+  }
+  if (precision.translational <= 0.0 || precision.rotational <= 0.0 || precision.max_resolution <= 0.0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Invalid CartesianPrecision passed into computeCartesianPath. All components must be "
+                             "greater than zero");
+    return 0.0;
+  }
+
+  double rotation_distance = start_quaternion.angularDistance(target_quaternion);
+  double translation_distance = (rotated_target.translation() - start_pose.translation()).norm();
+
+  // decide how many coarse steps we will need for this trajectory
+  std::size_t translation_steps = 0;
+  if (max_step.translation > 0.0)
+    translation_steps = floor(translation_distance / max_step.translation);
+
+  std::size_t rotation_steps = 0;
+  if (max_step.rotation > 0.0)
+    rotation_steps = floor(rotation_distance / max_step.rotation);
+
+  // the size of the path in units of max_step, to compare the sizes of steps across paths
+  const double path_size = std::max(max_step.translation > 0.0 ? translation_distance / max_step.translation : 0.0,
+                                    max_step.rotation > 0.0 ? rotation_distance / max_step.rotation : 0.0);
+
+  // If we are testing for relative jumps, we always want at least MIN_STEPS_FOR_JUMP_THRESH steps
+  std::size_t steps = std::max(translation_steps, rotation_steps) + 1;
+  if (jump_threshold.factor > 0 && steps < MIN_STEPS_FOR_JUMP_THRESH)
+    steps = MIN_STEPS_FOR_JUMP_THRESH;
+
+  const std::vector<double> consistency_limits = computeConsistencyLimits(group, jump_threshold);
+
+  auto pose_at = [&](double percentage) {
+    Eigen::Isometry3d pose(start_quaternion.slerp(percentage, target_quaternion));
+    pose.translation() = percentage * rotated_target.translation() + (1 - percentage) * start_pose.translation();
+    return pose;
+  };
+
+  traj.clear();
+  traj.push_back(RobotStatePtr(new moveit::core::RobotState(*start_state)));
+
+  // the percentages still to be reached, the next one is at the back
+  std::vector<double> pending;
+  pending.reserve(steps);
+  for (std::size_t i = steps; i > 0; --i)
+    pending.push_back((double)i / (double)steps);
+
+  RobotState mid_state(*start_state);
+  double last_valid_percentage = 0.0;
+  while (!pending.empty())
+  {
+    const double percentage = pending.back();
+    const bool can_bisect = percentage - last_valid_percentage > precision.max_resolution;
+    const RobotState& last_state = *traj.back();
+
+    // seed IK with the previous state of the path, using a single attempt to get a smooth trajectory
+    *start_state = last_state;
+    bool valid = start_state->setFromIK(group, pose_at(percentage), link->getName(), consistency_limits, 0.0,
+                                        validCallback, options);
+
+    if (valid && hasAbsoluteJointSpaceJump(group, last_state, *start_state, jump_threshold))
+    {
+      if (!can_bisect)
+        ROS_DEBUG_NAMED(LOGNAME, "Stopping Cartesian path due to a joint-space jump at %.4f", percentage);
+      valid = false;
+    }
+
+    if (valid)
+    {
+      // the link follows the joint-space interpolation between the states, compare it in the middle of the step
+      last_state.interpolate(*start_state, 0.5, mid_state, group);
+      const Eigen::Isometry3d& mid_pose = mid_state.getGlobalLinkTransform(link);
+      const Eigen::Isometry3d expected_pose = pose_at(0.5 * (last_valid_percentage + percentage));
+      valid = (mid_pose.translation() - expected_pose.translation()).norm() <= precision.translational &&
+              Eigen::Quaterniond(mid_pose.linear()).angularDistance(Eigen::Quaterniond(expected_pose.linear())) <=
+                  precision.rotational;
+      if (!valid && !can_bisect)
+        ROS_DEBUG_NAMED(LOGNAME, "Stopping Cartesian path due to a deviation from the Cartesian line at %.4f",
+                        percentage);
+    }
+
+    if (valid)
+    {
+      traj.push_back(RobotStatePtr(new moveit::core::RobotState(*start_state)));
+      percentages.push_back(percentage);
+      step_sizes.push_back((percentage - last_valid_percentage) * path_size);
+      last_valid_percentage = percentage;
+      pending.pop_back();
+    }
+    else if (can_bisect)
+      pending.push_back(0.5 * (last_valid_percentage + percentage));
+    else
+      break;
+  }
+
+  return last_valid_percentage;
+}
+
+// Truncate traj before the first step whose joint-space distance exceeds factor times the average joint-space distance
+// per Cartesian step size, as steps of adaptive paths differ in size. Returns the number of steps kept.
+std::size_t truncateAtRelativeJump(const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+                                   const std::vector<double>& step_sizes, double factor)
+{
+  if (traj.size() < MIN_STEPS_FOR_JUMP_THRESH)
+    ROS_WARN_NAMED(LOGNAME,
+                   "The computed trajectory is too short to detect jumps in joint-space "
+                   "Need at least %zu steps, only got %zu. Try a lower max_step.",
+                   MIN_STEPS_FOR_JUMP_THRESH, traj.size());
+
+  std::vector<double> distances;
+  distances.reserve(step_sizes.size());
+  double total_distance = 0.0;
+  double total_size = 0.0;
+  for (std::size_t i = 0; i < step_sizes.size(); ++i)
+  {
+    distances.push_back(traj[i + 1]->distance(*traj[i], group));
+    total_distance += distances.back();
+    total_size += step_sizes[i];
+  }
+  if (total_size <= 0.0)
+    return step_sizes.size();
+
+  // steps without Cartesian motion (to a waypoint at the current pose) are not compared
+  const double threshold = factor * total_distance / total_size;
+  for (std::size_t i = 0; i < step_sizes.size(); ++i)
+    if (step_sizes[i] > 0.0 && distances[i] > threshold * step_sizes[i])
+    {
+      ROS_DEBUG_NAMED(LOGNAME, "Truncating Cartesian path due to detected jump in joint-space distance");
+      traj.resize(i + 1);
+      return i;
+    }
+  return step_sizes.size();
+}
+}  // namespace
+
 double CartesianInterpolator::computeCartesianPath(RobotState* start_state, const JointModelGroup* group,
                                                    std::vector<RobotStatePtr>& traj, const LinkModel* link,
                                                    const Eigen::Vector3d& direction, bool global_reference_frame,
@@ -126,26 +348,7 @@ double CartesianInterpolator::computeCartesianPath(RobotState* start_state, cons
     steps = MIN_STEPS_FOR_JUMP_THRESH;
 
   // To limit absolute joint-space jumps, we pass consistency limits to the IK solver
-  std::vector<double> consistency_limits;
-  if (jump_threshold.prismatic > 0 || jump_threshold.revolute > 0)
-    for (const JointModel* jm : group->getActiveJointModels())
-    {
-      double limit;
-      switch (jm->getType())
-      {
-        case JointModel::REVOLUTE:
-          limit = jump_threshold.revolute;
-          break;
-        case JointModel::PRISMATIC:
-          limit = jump_threshold.prismatic;
-          break;
-        default:
-          limit = 0.0;
-      }
-      if (limit == 0.0)
-        limit = jm->getMaximumExtent();
-      consistency_limits.push_back(limit);
-    }
+  const std::vector<double> consistency_limits = computeConsistencyLimits(group, jump_threshold);
 
   traj.clear();
   traj.push_back(RobotStatePtr(new moveit::core::RobotState(*start_state)));
@@ -214,6 +417,75 @@ double CartesianInterpolator::computeCartesianPath(RobotState* start_state, cons
   return percentage_solved;
 }
 
+double CartesianInterpolator::computeCartesianPath(RobotState* start_state, const JointModelGroup* group,
+                                                   std::vector<RobotStatePtr>& traj, const LinkModel* link,
+                                                   const Eigen::Isometry3d& target, bool global_reference_frame,
+                                                   const MaxEEFStep& max_step, const CartesianPrecision& precision,
+                                                   const JumpThreshold& jump_threshold,
+                                                   const GroupStateValidityCallbackFn& validCallback,
+                                                   const kinematics::KinematicsQueryOptions& options)
+{
+  std::vector<double> percentages, step_sizes;
+  double percentage_solved =
+      computeAdaptiveCartesianPath(start_state, group, traj, link, target, global_reference_frame, max_step, precision,
+                                   jump_threshold, validCallback, options, percentages, step_sizes);
+  if (jump_threshold.factor > 0.0 && !step_sizes.empty())
+  {
+    const std::size_t kept = truncateAtRelativeJump(group, traj, step_sizes, jump_threshold.factor);
+    if (kept < step_sizes.size())
+      percentage_solved = kept > 0 ? percentages[kept - 1] : 0.0;
+  }
+  return percentage_solved;
+}
+
+double CartesianInterpolator::computeCartesianPath(RobotState* start_state, const JointModelGroup* group,
+                                                   std::vector<RobotStatePtr>& traj, const LinkModel* link,
+                                                   const EigenSTL::vector_Isometry3d& waypoints,
+                                                   bool global_reference_frame, const MaxEEFStep& max_step,
+                                                   const CartesianPrecision& precision,
+                                                   const JumpThreshold& jump_threshold,
+                                                   const GroupStateValidityCallbackFn& validCallback,
+                                                   const kinematics::KinematicsQueryOptions& options)
+{
+  // Absolute jumps are detected per segment, relative jumps are tested later on the whole trajectory.
+  // The fraction of the whole path reached by each step and the sizes of the steps are collected for this.
+  // The steps are indexed from the start of traj, so it must not keep states of a previous call.
+  std::vector<double> percentages, step_sizes;
+  traj.clear();
+  double percentage_solved = 0.0;
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    std::vector<RobotStatePtr> waypoint_traj;
+    std::vector<double> wp_percentages;
+    double wp_percentage_solved = computeAdaptiveCartesianPath(
+        start_state, group, waypoint_traj, link, waypoints[i], global_reference_frame, max_step, precision,
+        jump_threshold, validCallback, options, wp_percentages, step_sizes);
+    for (double wp_percentage : wp_percentages)
+      percentages.push_back((i + wp_percentage) / (double)waypoints.size());
+    std::vector<RobotStatePtr>::iterator start = waypoint_traj.begin();
+    if (i > 0 && !waypoint_traj.empty())
+      std::advance(start, 1);
+    traj.insert(traj.end(), start, waypoint_traj.end());
+
+    if (fabs(wp_percentage_solved - 1.0) < std::numeric_limits<double>::epsilon())
+      percentage_solved = (double)(i + 1) / (double)waypoints.size();
+    else
+    {
+      percentage_solved += wp_percentage_solved / (double)waypoints.size();
+      break;
+    }
+  }
+
+  if (jump_threshold.factor > 0.0 && !step_sizes.empty())
+  {
+    const std::size_t kept = truncateAtRelativeJump(group, traj, step_sizes, jump_threshold.factor);
+    if (kept < step_sizes.size())
+      percentage_solved = kept > 0 ? percentages[kept - 1] : 0.0;
+  }
+
+  return percentage_solved;
+}
+
 double CartesianInterpolator::checkJointSpaceJump(const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
                                                   const JumpThreshold& jump_threshold)
 {
@@ -87,9 +87,9 @@ void RobotState::allocMemory()
                 "sizeof(Eigen::Isometry3d) should be a multiple of EIGEN_MAX_ALIGN_BYTES");
 
   constexpr unsigned int extra_alignment_bytes = EIGEN_MAX_ALIGN_BYTES - 1;
-  // memory for the dirty joint transforms
+  // memory for the dirty joint transforms and the dirty link subtrees
   const int nr_doubles_for_dirty_joint_transforms =
-      1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
+      1 + 2 * robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
   const size_t bytes =
       sizeof(Eigen::Isometry3d) * (robot_model_->getJointModelCount() + robot_model_->getLinkModelCount() +
                                    robot_model_->getLinkGeometryCount()) +
@@ -105,6 +105,7 @@ void RobotState::allocMemory()
   global_collision_body_transforms_ = global_link_transforms_ + robot_model_->getLinkModelCount();
   dirty_joint_transforms_ =
       reinterpret_cast<unsigned char*>(global_collision_body_transforms_ + robot_model_->getLinkGeometryCount());
+  dirty_link_subtrees_ = dirty_joint_transforms_ + robot_model_->getJointModelCount();
   position_ = reinterpret_cast<double*>(dirty_joint_transforms_) + nr_doubles_for_dirty_joint_transforms;
   velocity_ = position_ + robot_model_->getVariableCount();
   // acceleration and effort share the memory (not both can be specified)
@@ -113,9 +114,9 @@ void RobotState::allocMemory()
 
 void RobotState::initTransforms()
 {
-  // mark all transforms as dirty
+  // mark all transforms (and all link subtrees) as dirty
   const int nr_doubles_for_dirty_joint_transforms =
-      1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
+      1 + 2 * robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
   memset(dirty_joint_transforms_, 1, sizeof(double) * nr_doubles_for_dirty_joint_transforms);
 
   // initialize last row of transformation matrices, which will not be modified by transform updates anymore
@@ -154,7 +155,7 @@ void RobotState::copyFrom(const RobotState& other)
   {
     // copy all the memory; maybe avoid copying velocity and acceleration if possible
     const int nr_doubles_for_dirty_joint_transforms =
-        1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
+        1 + 2 * robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
     const size_t bytes =
         sizeof(Eigen::Isometry3d) * (robot_model_->getJointModelCount() + robot_model_->getLinkModelCount() +
                                      robot_model_->getLinkGeometryCount()) +
@@ -276,8 +277,7 @@ void RobotState::setToRandomPositions()
 {
   random_numbers::RandomNumberGenerator& rng = getRandomNumberGenerator();
   robot_model_->getVariableRandomPositions(rng, position_);
-  memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
   // mimic values are correctly set in RobotModel
 }
 
@@ -341,8 +341,7 @@ void RobotState::setToDefaultValues()
   robot_model_->getVariableDefaultPositions(position_);  // mimic values are updated
   // set velocity & acceleration to 0
   memset(velocity_, 0, sizeof(double) * 2 * robot_model_->getVariableCount());
-  memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
 }
 
 void RobotState::setVariablePositions(const double* position)
@@ -353,8 +352,7 @@ void RobotState::setVariablePositions(const double* position)
   // the full state includes mimic joint values, so no need to update mimic here
 
   // Since all joint values have potentially changed, we will need to recompute all transforms
-  memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
 }
 
 void RobotState::setVariablePositions(const std::map<std::string, double>& variable_map)
@@ -612,8 +610,7 @@ void RobotState::update(bool force)
   // make sure we do everything from scratch if needed
   if (force)
   {
-    memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-    dirty_link_transforms_ = robot_model_->getRootJoint();
+    markDirtyAllTransforms();
   }
 
   // this actually triggers all needed updates
@@ -652,7 +649,11 @@ void RobotState::updateLinkTransforms()
 {
   if (dirty_link_transforms_ != nullptr)
   {
-    updateLinkTransformsInternal(dirty_link_transforms_);
+    // dirty_link_transforms_ is only the common root of all changed joints (e.g. the torso when both arms of a
+    // dual-arm robot moved), so only recompute the subtrees below the joints that were actually marked dirty
+    updateDirtyLinkSubtree(dirty_link_transforms_);
+    for (const JointModel* joint : dirty_link_transforms_->getDescendantJointModels())
+      updateDirtyLinkSubtree(joint);
     if (dirty_collision_body_transforms_)
       dirty_collision_body_transforms_ =
           robot_model_->getCommonRoot(dirty_collision_body_transforms_, dirty_link_transforms_);
@@ -662,6 +663,19 @@ void RobotState::updateLinkTransforms()
   }
 }
 
+void RobotState::updateDirtyLinkSubtree(const JointModel* start)
+{
+  if (!dirty_link_subtrees_[start->getJointIndex()])
+    return;
+  updateLinkTransformsInternal(start);
+  updateAttachedBodyTransforms(start);
+
+  // the whole subtree is up to date now, including the subtrees of dirty descendants
+  dirty_link_subtrees_[start->getJointIndex()] = 0;
+  for (const JointModel* joint : start->getDescendantJointModels())
+    dirty_link_subtrees_[joint->getJointIndex()] = 0;
+}
+
 void RobotState::updateLinkTransformsInternal(const JointModel* start)
 {
   for (const LinkModel* link : start->getDescendantLinkModels())
@@ -694,11 +708,6 @@ void RobotState::updateLinkTransformsInternal(const JointModel* start)
             link->getJointOriginTransform().affine() * getJointTransform(link->getParentJointModel()).matrix();
     }
   }
-
-  // update attached bodies tf; these are usually very few, so we update them all
-  for (std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.begin();
-       it != attached_body_map_.end(); ++it)
-    it->second->computeTransform(global_link_transforms_[it->second->getAttachedLink()->getLinkIndex()]);
 }
 
 void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isometry3d& transform, bool backward)
@@ -747,10 +756,18 @@ void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isome
     dirty_collision_body_transforms_ = parent_link->getParentJointModel();
   }
 
-  // update attached bodies tf; these are usually very few, so we update them all
-  for (std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.begin();
-       it != attached_body_map_.end(); ++it)
-    it->second->computeTransform(global_link_transforms_[it->second->getAttachedLink()->getLinkIndex()]);
+  updateAttachedBodyTransforms(backward ? robot_model_->getRootJoint() : link->getParentJointModel());
+}
+
+void RobotState::updateAttachedBodyTransforms(const JointModel* start)
+{
+  // only bodies attached below start have moved; getCommonRoot() is a table lookup
+  for (const std::pair<const std::string, AttachedBody*>& it : attached_body_map_)
+  {
+    const LinkModel* link = it.second->getAttachedLink();
+    if (robot_model_->getCommonRoot(start, link->getParentJointModel()) == start)
+      it.second->computeTransform(global_link_transforms_[link->getLinkIndex()]);
+  }
 }
 
 bool RobotState::satisfiesBounds(double margin) const
@@ -880,8 +897,7 @@ void RobotState::interpolate(const RobotState& to, double t, RobotState& state)
 {
   robot_model_->interpolate(getVariablePositions(), to.getVariablePositions(), t, state.getVariablePositions());
 
-  memset(state.dirty_joint_transforms_, 1, state.robot_model_->getJointModelCount() * sizeof(unsigned char));
-  state.dirty_link_transforms_ = state.robot_model_->getRootJoint();
+  state.markDirtyAllTransforms();
 }
 
 void RobotState::interpolate(const RobotState& to, double t, RobotState& state, const JointModelGroup* joint_group) const
@@ -1089,15 +1105,12 @@ const Eigen::Isometry3d& RobotState::getFrameInfo(const std::string& frame_id, c
   }
 
   // Check if an AttachedBody has a subframe with name frame_id
-  for (const std::pair<const std::string, AttachedBody*>& body : attached_body_map_)
+  if (const AttachedBody* body = getAttachedBodyWithSubframe(frame_id))
   {
-    const auto& transform = body.second->getGlobalSubframeTransform(frame_id, &frame_found);
-    if (frame_found)
-    {
-      robot_link = body.second->getAttachedLink();
-      BOOST_VERIFY(checkLinkTransforms());
-      return transform;
-    }
+    robot_link = body->getAttachedLink();
+    frame_found = true;
+    BOOST_VERIFY(checkLinkTransforms());
+    return body->getGlobalSubframeTransform(frame_id);
   }
 
   robot_link = nullptr;
@@ -1105,6 +1118,52 @@ const Eigen::Isometry3d& RobotState::getFrameInfo(const std::string& frame_id, c
   return IDENTITY_TRANSFORM;
 }
 
+const AttachedBody* RobotState::getAttachedBodyWithSubframe(const std::string& frame_id) const
+{
+  // body names may contain '/' themselves, so try every prefix that ends before a '/', shortest first
+  for (std::size_t pos = frame_id.find('/'); pos != std::string::npos; pos = frame_id.find('/', pos + 1))
+  {
+    std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.find(frame_id.substr(0, pos));
+    if (it != attached_body_map_.end() && it->second->hasSubframeTransform(frame_id))
+      return it->second;
+  }
+  return nullptr;
+}
+
+const LinkModel* RobotState::resolveFrameToLink(const std::string& frame_id, Eigen::Isometry3d* transform) const
+{
+  if (!frame_id.empty() && frame_id[0] == '/')
+    return resolveFrameToLink(frame_id.substr(1), transform);
+
+  const LinkModel* link = nullptr;
+  Eigen::Isometry3d link_to_frame = Eigen::Isometry3d::Identity();
+  if (frame_id == robot_model_->getModelFrame())
+    link = robot_model_->getRootLink();
+  else if (robot_model_->hasLinkModel(frame_id))
+    link = robot_model_->getLinkModel(frame_id);
+  else
+  {
+    std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.find(frame_id);
+    if (it != attached_body_map_.end())
+    {
+      // as in getFrameInfo(), the frame of an attached body is the pose of its first shape
+      if (it->second->getFixedTransforms().empty())
+        return nullptr;
+      link = it->second->getAttachedLink();
+      link_to_frame = it->second->getFixedTransforms()[0];
+    }
+    else if (const AttachedBody* body = getAttachedBodyWithSubframe(frame_id))
+    {
+      link = body->getAttachedLink();
+      link_to_frame = body->getSubframeTransform(frame_id);
+    }
+  }
+
+  if (link && transform)
+    *transform = link_to_frame;
+  return link;
+}
+
 bool RobotState::knowsFrameTransform(const std::string& frame_id) const
 {
   if (!frame_id.empty() && frame_id[0] == '/')
@@ -1118,12 +1177,7 @@ bool RobotState::knowsFrameTransform(const std::string& frame_id) const
     return !it->second->getGlobalCollisionBodyTransforms().empty();
 
   // Check if an AttachedBody has a subframe with name frame_id
-  for (const std::pair<const std::string, AttachedBody*>& body : attached_body_map_)
-  {
-    if (body.second->hasSubframeTransform(frame_id))
-      return true;
-  }
-  return false;
+  return getAttachedBodyWithSubframe(frame_id) != nullptr;
 }
 
 void RobotState::getRobotMarkers(visualization_msgs::MarkerArray& arr, const std::vector<std::string>& link_names,
@@ -45,6 +45,7 @@
 #include <moveit/profiler/profiler.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <ros/package.h>
+#include <random_numbers/random_numbers.h>
 
 class LoadPlanningModelsPr2 : public testing::Test
 {
@@ -263,6 +264,116 @@ TEST_F(LoadPlanningModelsPr2, FullTest)
   ASSERT_EQ(attached_bodies_2.size(), 0u);
 }
 
+TEST_F(LoadPlanningModelsPr2, AttachedBodyFrames)
+{
+  moveit::core::RobotModelPtr robot_model(new moveit::core::RobotModel(urdf_model_, srdf_model_));
+  moveit::core::RobotState ks(robot_model);
+  ks.setToDefaultValues();
+  ks.setVariablePosition("r_shoulder_pan_joint", 0.3);
+  ks.update();
+
+  std::vector<shapes::ShapeConstPtr> shapes(1, std::make_shared<const shapes::Box>(.1, .1, .1));
+  EigenSTL::vector_Isometry3d poses(1, Eigen::Isometry3d(Eigen::Translation3d(0.1, 0, 0)));
+  moveit::core::FixedTransformsMap subframes;
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.2));
+  // a body name containing '/' and a body whose name is a prefix of it
+  ks.attachBody("tool", shapes, poses, std::set<std::string>(), "r_gripper_palm_link",
+                trajectory_msgs::JointTrajectory(), subframes);
+  ks.attachBody("tool/holder", shapes, poses, std::set<std::string>(), "l_gripper_palm_link",
+                trajectory_msgs::JointTrajectory(), subframes);
+  ks.update();
+
+  const moveit::core::LinkModel* r_palm = robot_model->getLinkModel("r_gripper_palm_link");
+  const moveit::core::LinkModel* l_palm = robot_model->getLinkModel("l_gripper_palm_link");
+  for (const std::string& frame : { std::string("r_gripper_palm_link"), std::string("tool"), std::string("tool/tip"),
+                                    std::string("tool/holder"), std::string("tool/holder/tip"),
+                                    robot_model->getModelFrame() })
+  {
+    EXPECT_TRUE(ks.knowsFrameTransform(frame)) << frame;
+    Eigen::Isometry3d link_to_frame;
+    const moveit::core::LinkModel* link = ks.resolveFrameToLink(frame, &link_to_frame);
+    ASSERT_TRUE(link != nullptr) << frame;
+    EXPECT_TRUE((ks.getGlobalLinkTransform(link) * link_to_frame).isApprox(ks.getFrameTransform(frame), 1e-12))
+        << frame;
+  }
+  EXPECT_EQ(ks.resolveFrameToLink("tool/tip"), r_palm);
+  EXPECT_EQ(ks.resolveFrameToLink("tool/holder/tip"), l_palm);
+
+  EXPECT_FALSE(ks.knowsFrameTransform("tool/unknown"));
+  EXPECT_FALSE(ks.knowsFrameTransform("holder/tip"));
+  EXPECT_EQ(ks.resolveFrameToLink("tool/unknown"), nullptr);
+}
+
+TEST_F(LoadPlanningModelsPr2, AttachedBodyTransformsFollowLinks)
+{
+  moveit::core::RobotModelPtr robot_model(new moveit::core::RobotModel(urdf_model_, srdf_model_));
+  const moveit::core::JointModelGroup* right_arm = robot_model->getJointModelGroup("right_arm");
+  moveit::core::RobotState ks(robot_model);
+  ks.setToDefaultValues();
+  ks.update();
+
+  std::vector<shapes::ShapeConstPtr> shapes(1, std::make_shared<const shapes::Box>(.1, .1, .1));
+  EigenSTL::vector_Isometry3d poses(1, Eigen::Isometry3d(Eigen::Translation3d(0.1, 0, 0)));
+  moveit::core::FixedTransformsMap subframes;
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.2));
+  const std::vector<std::string> links = { "r_gripper_palm_link", "l_gripper_palm_link", "base_link" };
+  for (const std::string& link : links)
+    ks.attachBody("box_" + link, shapes, poses, std::set<std::string>(), link, trajectory_msgs::JointTrajectory(),
+                  subframes);
+
+  // after moving only the right arm, or a link directly, all bodies must still follow their links
+  random_numbers::RandomNumberGenerator rng(7);
+  for (int i = 0; i < 10; ++i)
+  {
+    ks.setToRandomPositions(right_arm, rng);
+    if (i % 2)
+      ks.updateStateWithLinkAt("r_shoulder_pan_link", ks.getGlobalLinkTransform("r_shoulder_pan_link") *
+                                                          Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.01)));
+    else
+      ks.update();
+    for (const std::string& link : links)
+    {
+      const moveit::core::AttachedBody* body = ks.getAttachedBody("box_" + link);
+      const Eigen::Isometry3d& link_pose = ks.getGlobalLinkTransform(link);
+      EXPECT_TRUE(body->getGlobalCollisionBodyTransforms()[0].isApprox(link_pose * poses[0], 1e-12)) << link;
+      EXPECT_TRUE(
+          body->getGlobalSubframeTransform("box_" + link + "/tip").isApprox(link_pose * subframes["tip"], 1e-12))
+          << link;
+    }
+  }
+}
+
+TEST_F(LoadPlanningModelsPr2, UpdateDisjointSubtrees)
+{
+  moveit::core::RobotModelPtr robot_model(new moveit::core::RobotModel(urdf_model_, srdf_model_));
+  const moveit::core::JointModelGroup* right_arm = robot_model->getJointModelGroup("right_arm");
+  const moveit::core::JointModelGroup* left_arm = robot_model->getJointModelGroup("left_arm");
+  moveit::core::RobotState ks(robot_model);
+  ks.setToDefaultValues();
+  ks.update();
+
+  random_numbers::RandomNumberGenerator rng(11);
+  for (int i = 0; i < 20; ++i)
+  {
+    // change both arms, or one arm and a single joint elsewhere, so the dirty joints lie in disjoint subtrees
+    ks.setToRandomPositions(right_arm, rng);
+    if (i % 2)
+      ks.setToRandomPositions(left_arm, rng);
+    else
+      ks.setVariablePosition("head_pan_joint", rng.uniformReal(-1.0, 1.0));
+    // computing a joint transform early must not hide its subtree from the link update
+    ks.getJointTransform("r_elbow_flex_joint");
+    ks.update();
+
+    moveit::core::RobotState reference(robot_model);
+    reference.setVariablePositions(ks.getVariablePositions());
+    reference.update();
+    for (const moveit::core::LinkModel* link : robot_model->getLinkModels())
+      EXPECT_TRUE(ks.getGlobalLinkTransform(link).isApprox(reference.getGlobalLinkTransform(link), 1e-12))
+          << link->getName();
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
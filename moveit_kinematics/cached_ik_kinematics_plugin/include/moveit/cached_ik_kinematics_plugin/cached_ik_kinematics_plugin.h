@@ -44,7 +44,10 @@
 #include <moveit/cached_ik_kinematics_plugin/detail/NearestNeighborsGNAT.h>
 #include <boost/filesystem.hpp>
 #include <unordered_map>
+#include <condition_variable>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <utility>
 
 namespace cached_ik_kinematics_plugin
@@ -115,8 +118,14 @@ public:
 protected:
   /** compute the distance between two joint configurations */
   double configDistance2(const std::vector<double>& config1, const std::vector<double>& config2) const;
+  /** append an entry to the cache; must be called with lock_ held exclusively */
+  void addEntry(const std::vector<Pose>& poses, const std::vector<double>& config) const;
   /** save current state of cache to disk */
   void saveCache() const;
+  /** body of save_thread_: save the cache whenever requested by addEntry() */
+  void saveCacheLoop();
+  /** stop save_thread_ if it is running */
+  void stopSaveThread();
 
   /** number of joints in the system */
   unsigned int num_joints_;
@@ -132,17 +141,26 @@ protected:
 
   /**
     the IK methods are declared const in the base class, but the
-    wrapped methods need to modify the cache, so the next four members
+    wrapped methods need to modify the cache, so the following members
     are mutable
-    cache of IK solutions
+    cache of IK solutions. Its capacity is reserved upfront and entries
+    are only ever appended, so existing entries never move or change.
   */
   mutable std::vector<IKEntry> ik_cache_;
   /** nearest neighbor data structure over IK cache entries */
   mutable NearestNeighborsGNAT<IKEntry*> ik_nn_;
   /** size of the cache when it was last saved */
   mutable unsigned int last_saved_cache_size_{ 0 };
-  /** mutex for changing IK cache */
-  mutable std::mutex lock_;
+  /** lookups share this lock, adding entries requires exclusive access */
+  mutable std::shared_timed_mutex lock_;
+
+  /** saves the cache in the background, so that IK calls never wait for disk I/O */
+  std::thread save_thread_;
+  /** protects save_requested_ and stop_saving_ */
+  mutable std::mutex save_lock_;
+  mutable std::condition_variable save_condition_;
+  mutable bool save_requested_{ false };
+  bool stop_saving_{ false };
 };
 
 /** a container of IK caches for cases where there is no fixed base frame */
@@ -54,13 +54,17 @@ IKCache::IKCache()
 
 IKCache::~IKCache()
 {
-  if (!ik_cache_.empty())
+  stopSaveThread();
+  if (ik_cache_.size() > last_saved_cache_size_)
     saveCache();
 }
 
 void IKCache::initializeCache(const std::string& robot_id, const std::string& group_name, const std::string& cache_name,
                               const unsigned int num_joints, const Options& opts)
 {
+  // a previous cache might still be saved in the background
+  stopSaveThread();
+
   // read ROS parameters
   max_cache_size_ = opts.max_cache_size;
   ik_cache_.reserve(max_cache_size_);
@@ -70,7 +74,7 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
   std::string cached_ik_path = opts.cached_ik_path;
 
   // use mutex lock for rest of initialization
-  std::lock_guard<std::mutex> slock(lock_);
+  std::unique_lock<std::shared_timed_mutex> slock(lock_);
   // determine cache file name
   boost::filesystem::path prefix(!cached_ik_path.empty() ? cached_ik_path : boost::filesystem::current_path());
   // create cache directory if necessary
@@ -102,7 +106,17 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
     unsigned int config_size = num_dofs * sizeof(double);
     unsigned int offset_conf = pose_size * num_tips;
     unsigned int bufsize = offset_conf + config_size;
-    char* buffer = new char[bufsize];
+
+    // entries have a fixed size, so read all of them at once
+    std::vector<char> buffer(static_cast<std::size_t>(bufsize) * last_saved_cache_size_);
+    cache_file.read(buffer.data(), buffer.size());
+    if (static_cast<std::size_t>(cache_file.gcount()) != buffer.size())
+    {
+      ROS_ERROR_NAMED("cached_ik", "Cache file %s is truncated, only reading complete entries",
+                      cache_file_name_.string().c_str());
+      last_saved_cache_size_ = cache_file.gcount() / bufsize;
+    }
+
     IKEntry entry;
     entry.first.resize(num_tips);
     entry.second.resize(num_dofs);
@@ -110,20 +124,17 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
 
     for (unsigned i = 0; i < last_saved_cache_size_; ++i)
     {
+      const char* record = buffer.data() + static_cast<std::size_t>(i) * bufsize;
       unsigned int j = 0;
-      cache_file.read(buffer, bufsize);
       for (auto& pose : entry.first)
       {
-        memcpy(&pose.position[0], buffer + j * pose_size, position_size);
-        memcpy(&pose.orientation[0], buffer + j * pose_size + position_size, orientation_size);
+        memcpy(&pose.position[0], record + j * pose_size, position_size);
+        memcpy(&pose.orientation[0], record + j * pose_size + position_size, orientation_size);
         ++j;
       }
-      memcpy(&entry.second[0], buffer + offset_conf, config_size);
+      memcpy(&entry.second[0], record + offset_conf, config_size);
       ik_cache_.push_back(entry);
     }
-    ROS_INFO_NAMED("cached_ik", "freeing buffer");
-    delete[] buffer;
-    ROS_INFO_NAMED("cached_ik", "freed buffer");
     std::vector<IKEntry*> ik_entry_ptrs(last_saved_cache_size_);
     for (unsigned int i = 0; i < last_saved_cache_size_; ++i)
       ik_entry_ptrs[i] = &ik_cache_[i];
@@ -132,6 +143,13 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
 
   num_joints_ = num_joints;
 
+  {
+    std::lock_guard<std::mutex> lock(save_lock_);
+    save_requested_ = false;
+    stop_saving_ = false;
+  }
+  save_thread_ = std::thread(&IKCache::saveCacheLoop, this);
+
   ROS_INFO_NAMED("cached_ik", "cache file %s initialized!", cache_file_name_.string().c_str());
 }
 
@@ -148,6 +166,7 @@ double IKCache::configDistance2(const std::vector<double>& config1, const std::v
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const Pose& pose) const
 {
+  std::shared_lock<std::shared_timed_mutex> slock(lock_);
   if (ik_cache_.empty())
   {
     static IKEntry dummy = std::make_pair(std::vector<Pose>(1, pose), std::vector<double>(num_joints_, 0.));
@@ -159,6 +178,7 @@ const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const Pose& pose)
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const std::vector<Pose>& poses) const
 {
+  std::shared_lock<std::shared_timed_mutex> slock(lock_);
   if (ik_cache_.empty())
   {
     static IKEntry dummy = std::make_pair(poses, std::vector<double>(num_joints_, 0.));
@@ -170,81 +190,141 @@ const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const std::vector<
 
 void IKCache::updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const
 {
-  if (ik_cache_.size() < ik_cache_.capacity() && (nearest.first[0].distance(pose) > min_pose_distance_ ||
-                                                  configDistance2(nearest.second, config) > min_config_distance2_))
+  if (nearest.first[0].distance(pose) > min_pose_distance_ ||
+      configDistance2(nearest.second, config) > min_config_distance2_)
   {
-    std::lock_guard<std::mutex> slock(lock_);
-    ik_cache_.emplace_back(std::vector<Pose>(1u, pose), config);
-    ik_nn_.add(&ik_cache_.back());
-    if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
-      saveCache();
+    std::unique_lock<std::shared_timed_mutex> slock(lock_);
+    addEntry(std::vector<Pose>(1u, pose), config);
   }
 }
 
 void IKCache::updateCache(const IKEntry& nearest, const std::vector<Pose>& poses,
                           const std::vector<double>& config) const
 {
-  if (ik_cache_.size() < ik_cache_.capacity())
+  bool add_to_cache = configDistance2(nearest.second, config) > min_config_distance2_;
+  if (!add_to_cache)
   {
-    bool add_to_cache = configDistance2(nearest.second, config) > min_config_distance2_;
-    if (!add_to_cache)
+    double dist = 0.;
+    for (unsigned int i = 0; i < poses.size(); ++i)
     {
-      double dist = 0.;
-      for (unsigned int i = 0; i < poses.size(); ++i)
+      dist += nearest.first[i].distance(poses[i]);
+      if (dist > min_pose_distance_)
       {
-        dist += nearest.first[i].distance(poses[i]);
-        if (dist > min_pose_distance_)
-        {
-          add_to_cache = true;
-          break;
-        }
+        add_to_cache = true;
+        break;
       }
     }
-    if (add_to_cache)
-    {
-      std::lock_guard<std::mutex> slock(lock_);
-      ik_cache_.emplace_back(poses, config);
-      ik_nn_.add(&ik_cache_.back());
-      if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
-        saveCache();
-    }
+  }
+  if (add_to_cache)
+  {
+    std::unique_lock<std::shared_timed_mutex> slock(lock_);
+    addEntry(poses, config);
+  }
+}
+
+void IKCache::addEntry(const std::vector<Pose>& poses, const std::vector<double>& config) const
+{
+  // never grow beyond the reserved capacity, so that entries (and pointers to them) stay valid
+  if (ik_cache_.size() >= ik_cache_.capacity())
+    return;
+
+  ik_cache_.emplace_back(poses, config);
+  ik_nn_.add(&ik_cache_.back());
+  if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
+  {
+    std::lock_guard<std::mutex> lock(save_lock_);
+    save_requested_ = true;
+    save_condition_.notify_one();
+  }
+}
+
+void IKCache::saveCacheLoop()
+{
+  std::unique_lock<std::mutex> lock(save_lock_);
+  while (true)
+  {
+    save_condition_.wait(lock, [this] { return save_requested_ || stop_saving_; });
+    if (stop_saving_)
+      return;
+    save_requested_ = false;
+    lock.unlock();
+    saveCache();
+    lock.lock();
   }
 }
 
+void IKCache::stopSaveThread()
+{
+  if (!save_thread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(save_lock_);
+    stop_saving_ = true;
+  }
+  save_condition_.notify_one();
+  save_thread_.join();
+}
+
 void IKCache::saveCache() const
 {
   if (cache_file_name_.empty())
+  {
     ROS_ERROR_NAMED("cached_ik", "can't save cache before initialization");
+    return;
+  }
 
-  ROS_INFO_NAMED("cached_ik", "writing %ld IK solutions to %s", ik_cache_.size(), cache_file_name_.string().c_str());
+  // Entries are append-only and never reallocated, so the first num_entries entries can be written
+  // without holding the lock, while IK queries keep using and extending the cache.
+  std::size_t num_entries;
+  const IKEntry* entries;
+  {
+    std::shared_lock<std::shared_timed_mutex> slock(lock_);
+    num_entries = ik_cache_.size();
+    entries = ik_cache_.data();
+    last_saved_cache_size_ = num_entries;
+  }
+  if (num_entries == 0)
+    return;
+
+  ROS_INFO_NAMED("cached_ik", "writing %zu IK solutions to %s", num_entries, cache_file_name_.string().c_str());
 
-  boost::filesystem::ofstream cache_file(cache_file_name_, std::ios_base::binary | std::ios_base::out);
+  // write to a temporary file first, so that the cache file is never left partially written
+  boost::filesystem::path tmp_file_name(cache_file_name_);
+  tmp_file_name += ".tmp";
+  boost::filesystem::ofstream cache_file(tmp_file_name, std::ios_base::binary | std::ios_base::out);
   unsigned int position_size = 3 * sizeof(tf2Scalar);
   unsigned int orientation_size = 4 * sizeof(tf2Scalar);
   unsigned int pose_size = position_size + orientation_size;
-  unsigned int num_tips = ik_cache_[0].first.size();
-  unsigned int config_size = ik_cache_[0].second.size() * sizeof(double);
+  unsigned int num_tips = entries[0].first.size();
+  unsigned int config_size = entries[0].second.size() * sizeof(double);
   unsigned int offset_conf = num_tips * pose_size;
   unsigned int bufsize = offset_conf + config_size;
-  char* buffer = new char[bufsize];
+  std::vector<char> buffer(bufsize);
 
   // write number of IK entries and size of each configuration first
-  last_saved_cache_size_ = ik_cache_.size();
-  cache_file.write((char*)&last_saved_cache_size_, sizeof(unsigned int));
-  unsigned int sz = ik_cache_[0].second.size();
+  unsigned int num = num_entries;
+  cache_file.write((char*)&num, sizeof(unsigned int));
+  unsigned int sz = entries[0].second.size();
   cache_file.write((char*)&sz, sizeof(unsigned int));
   cache_file.write((char*)&num_tips, sizeof(unsigned int));
-  for (const auto& entry : ik_cache_)
+  for (std::size_t k = 0; k < num_entries; ++k)
   {
+    const IKEntry& entry = entries[k];
     for (unsigned int i = 0; i < num_tips; ++i)
     {
-      memcpy(buffer + i * pose_size, &entry.first[i].position[0], position_size);
-      memcpy(buffer + i * pose_size + position_size, &entry.first[i].orientation[0], orientation_size);
+      memcpy(buffer.data() + i * pose_size, &entry.first[i].position[0], position_size);
+      memcpy(buffer.data() + i * pose_size + position_size, &entry.first[i].orientation[0], orientation_size);
     }
-    memcpy(buffer + offset_conf, &entry.second[0], config_size);
-    cache_file.write(buffer, bufsize);
+    memcpy(buffer.data() + offset_conf, &entry.second[0], config_size);
+    cache_file.write(buffer.data(), bufsize);
   }
-  delete[] buffer;
+  cache_file.close();
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmp_file_name, cache_file_name_, ec);
+  if (ec)
+    ROS_ERROR_NAMED("cached_ik", "Failed to write cache file %s: %s", cache_file_name_.string().c_str(),
+                    ec.message().c_str());
 }
 
 void IKCache::verifyCache(kdl_kinematics_plugin::KDLKinematicsPlugin& fk) const
@@ -253,6 +333,7 @@ void IKCache::verifyCache(kdl_kinematics_plugin::KDLKinematicsPlugin& fk) const
   std::vector<geometry_msgs::Pose> poses(tip_names.size());
   double error, max_error = 0.;
 
+  std::shared_lock<std::shared_timed_mutex> slock(lock_);
   for (const auto& entry : ik_cache_)
   {
     fk.getPositionFK(tip_names, entry.second, poses);
@@ -110,6 +110,8 @@ private:
   ChainJntToJacSolver jnt2jac_;
 
   Eigen::JacobiSVD<Eigen::MatrixXd> svd_;
+  Eigen::MatrixXd jac_weighted_;  // (position rows of) weighted reduced Jacobian, input to svd_
+  Eigen::VectorXd svd_tmp_;       // intermediate result of the pseudo-inverse solve
   Eigen::VectorXd qdot_out_reduced_;
 
   Jacobian jac_;          // full Jacobian
@@ -58,6 +58,9 @@
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
 
+#include <memory>
+#include <mutex>
+
 namespace KDL
 {
 class ChainIkSolverVelMimicSVD;
@@ -77,6 +80,8 @@ public:
    */
   KDLKinematicsPlugin();
 
+  ~KDLKinematicsPlugin() override;
+
   bool
   getPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
                 std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
@@ -104,6 +109,13 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  /// Solves the poses one after another, reusing the solver and buffers of a single workspace for all of them
+  bool searchPositionIKBatch(
+      const std::vector<geometry_msgs::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::MoveItErrorCodes>& error_codes, const IKCallbackFn& solution_callback = IKCallbackFn(),
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::Pose>& poses) const override;
 
@@ -124,13 +136,50 @@ public:
 protected:
   typedef Eigen::Matrix<double, 6, 1> Twist;
 
-  /// Solve position IK given initial joint values
+  /** Solvers and scratch buffers needed by a single IK query.
+   *  Workspaces are created up front and recycled, so that IK queries do not allocate memory after warm-up. */
+  struct IKWorkspace;
+
+  /// Solve position IK given initial joint values ws.q_in, writing the result to ws.q_out
   // NOLINTNEXTLINE(readability-identifier-naming)
-  int CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, const KDL::JntArray& q_init, const KDL::Frame& p_in,
-                KDL::JntArray& q_out, const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
+  int CartToJnt(IKWorkspace& ws, const KDL::Frame& p_in, const unsigned int max_iter,
                 const Twist& cartesian_weights) const;
 
 private:
+  /// Take a workspace from the pool, creating a new one if all are in use (e.g. by concurrent queries)
+  std::unique_ptr<IKWorkspace> acquireWorkspace() const;
+  /// Return a workspace to the pool
+  void releaseWorkspace(std::unique_ptr<IKWorkspace> ws) const;
+
+  /// Holds a workspace of the pool and returns it when going out of scope, also if the query throws
+  class WorkspaceGuard
+  {
+  public:
+    explicit WorkspaceGuard(const KDLKinematicsPlugin& plugin);
+    ~WorkspaceGuard();
+    WorkspaceGuard(const WorkspaceGuard&) = delete;
+    WorkspaceGuard& operator=(const WorkspaceGuard&) = delete;
+
+    IKWorkspace& operator*() const
+    {
+      return *ws_;
+    }
+    IKWorkspace* operator->() const
+    {
+      return ws_.get();
+    }
+
+  private:
+    const KDLKinematicsPlugin& plugin_;
+    std::unique_ptr<IKWorkspace> ws_;
+  };
+
+  /// Implementation of searchPositionIK() using the given workspace
+  bool searchPositionIK(IKWorkspace& ws, const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                        double timeout, const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                        const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const;
+
   void getJointWeights();
   bool timedOut(const ros::WallTime& start_time, double duration) const;
 
@@ -167,8 +216,12 @@ private:
   std::unique_ptr<KDL::ChainFkSolverPos> fk_solver_;
   std::vector<JointMimic> mimic_joints_;
   std::vector<double> joint_weights_;
+  Eigen::VectorXd joint_weights_vector_;   ///< joint_weights_ as Eigen vector, to avoid conversions per query
   Eigen::VectorXd joint_min_, joint_max_;  ///< joint limits
 
+  mutable std::mutex workspaces_mutex_;                           ///< protects workspaces_
+  mutable std::vector<std::unique_ptr<IKWorkspace>> workspaces_;  ///< pool of currently unused workspaces
+
   int max_solver_iterations_;
   double epsilon_;
   /** weight of orientation error vs position error
@@ -51,6 +51,9 @@ ChainIkSolverVelMimicSVD::ChainIkSolverVelMimicSVD(const Chain& chain,
   // Performing a position-only IK, we just need to consider the first 3 rows of the Jacobian for SVD
   // SVD doesn't consider mimic joints, but only their driving joints
   , svd_(position_ik ? 3 : 6, chain_.getNrOfJoints() - num_mimic_joints_, Eigen::ComputeThinU | Eigen::ComputeThinV)
+  , jac_weighted_(svd_.rows(), svd_.cols())
+  , svd_tmp_(std::min(svd_.rows(), svd_.cols()))
+  , qdot_out_reduced_(svd_.cols())
   , jac_(chain_.getNrOfJoints())
   , jac_reduced_(svd_.cols())
 {
@@ -110,18 +113,26 @@ int ChainIkSolverVelMimicSVD::CartToJnt(const JntArray& q_in, const Twist& v_in,
   vin.bottomRows<3>() = Eigen::Map<const Eigen::Array3d>(v_in.rot.data, 3) * cartesian_weights.bottomRows<3>().array();
 
   // Do a singular value decomposition: J = U*S*V^t
-  svd_.compute(jac.topRows(rows));
+  // Copying into a preallocated matrix first avoids a temporary: JacobiSVD::compute() only accepts a plain matrix
+  jac_weighted_ = jac.topRows(rows);
+  svd_.compute(jac_weighted_);
+
+  // Solve with the pseudo-inverse V * S^-1 * U^t, which is what svd_.solve() does, but without allocating
+  const Eigen::Index rank = svd_.rank();
+  auto tmp = svd_tmp_.head(rank);
+  tmp.noalias() = svd_.matrixU().leftCols(rank).transpose() * vin.topRows(rows);
+  tmp.array() /= svd_.singularValues().head(rank).array();
 
   if (num_mimic_joints_ > 0)
   {
-    qdot_out_reduced_.noalias() = svd_.solve(vin.topRows(rows));
+    qdot_out_reduced_.noalias() = svd_.matrixV().leftCols(rank) * tmp;
     qdot_out_reduced_.array() *= joint_weights.array();
     for (unsigned int i = 0; i < chain_.getNrOfJoints(); ++i)
       qdot_out(i) = qdot_out_reduced_[mimic_joints_[i].map_index] * mimic_joints_[i].multiplier;
   }
   else
   {
-    qdot_out.data.noalias() = svd_.solve(vin.topRows(rows));
+    qdot_out.data.noalias() = svd_.matrixV().leftCols(rank) * tmp;
     qdot_out.data.array() *= joint_weights.array();
   }
 
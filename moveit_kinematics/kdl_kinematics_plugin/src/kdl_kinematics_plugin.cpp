@@ -45,16 +45,76 @@
 #include <kdl/frames_io.hpp>
 #include <kdl/kinfam_io.hpp>
 
+#include <thread>
+
 // register KDLKinematics as a KinematicsBase implementation
 #include <class_loader/class_loader.hpp>
 CLASS_LOADER_REGISTER_CLASS(kdl_kinematics_plugin::KDLKinematicsPlugin, kinematics::KinematicsBase)
 
 namespace kdl_kinematics_plugin
 {
+struct KDLKinematicsPlugin::IKWorkspace
+{
+  IKWorkspace(const KDL::Chain& chain, const std::vector<JointMimic>& mimic_joints, bool position_ik,
+              unsigned int dimension, std::size_t num_active)
+    : ik_solver_vel(chain, mimic_joints, position_ik)
+    , fk_solver(chain)
+    , seed(dimension)
+    , q_in(dimension)
+    , q_out(dimension)
+    , delta_q(dimension)
+    , q_backup(dimension)
+    , extra_joint_weights(num_active)
+    , weighted_joint_weights(num_active)
+  {
+    consistency_limits_mimic.reserve(dimension);
+  }
+
+  KDL::ChainIkSolverVelMimicSVD ik_solver_vel;
+  KDL::ChainFkSolverPos_recursive fk_solver;
+  KDL::JntArray seed, q_in, q_out, delta_q, q_backup;
+  Eigen::ArrayXd extra_joint_weights;
+  Eigen::VectorXd weighted_joint_weights;
+  std::vector<double> consistency_limits_mimic;
+};
+
 KDLKinematicsPlugin::KDLKinematicsPlugin() : initialized_(false)
 {
 }
 
+KDLKinematicsPlugin::~KDLKinematicsPlugin() = default;
+
+std::unique_ptr<KDLKinematicsPlugin::IKWorkspace> KDLKinematicsPlugin::acquireWorkspace() const
+{
+  {
+    std::lock_guard<std::mutex> lock(workspaces_mutex_);
+    if (!workspaces_.empty())
+    {
+      std::unique_ptr<IKWorkspace> ws = std::move(workspaces_.back());
+      workspaces_.pop_back();
+      return ws;
+    }
+  }
+  return std::make_unique<IKWorkspace>(kdl_chain_, mimic_joints_, orientation_vs_position_weight_ == 0.0, dimension_,
+                                       joint_weights_.size());
+}
+
+void KDLKinematicsPlugin::releaseWorkspace(std::unique_ptr<IKWorkspace> ws) const
+{
+  std::lock_guard<std::mutex> lock(workspaces_mutex_);
+  workspaces_.push_back(std::move(ws));
+}
+
+KDLKinematicsPlugin::WorkspaceGuard::WorkspaceGuard(const KDLKinematicsPlugin& plugin)
+  : plugin_(plugin), ws_(plugin.acquireWorkspace())
+{
+}
+
+KDLKinematicsPlugin::WorkspaceGuard::~WorkspaceGuard()
+{
+  plugin_.releaseWorkspace(std::move(ws_));
+}
+
 void KDLKinematicsPlugin::getRandomConfiguration(Eigen::VectorXd& jnt_array) const
 {
   state_->setToRandomPositions(joint_model_group_);
@@ -261,6 +321,12 @@ bool KDLKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
 
   fk_solver_.reset(new KDL::ChainFkSolverPos_recursive(kdl_chain_));
 
+  // Preallocate one workspace for IK queries, and room in the pool for concurrent callers to return theirs
+  joint_weights_vector_ = Eigen::Map<const Eigen::VectorXd>(joint_weights_.data(), joint_weights_.size());
+  workspaces_.clear();
+  workspaces_.reserve(std::max(1u, std::thread::hardware_concurrency()));
+  releaseWorkspace(acquireWorkspace());
+
   initialized_ = true;
   ROS_DEBUG_NAMED("kdl", "KDL solver initialized");
   return true;
@@ -318,6 +384,51 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
                                            std::vector<double>& solution, const IKCallbackFn& solution_callback,
                                            moveit_msgs::MoveItErrorCodes& error_code,
                                            const kinematics::KinematicsQueryOptions& options) const
+{
+  // All buffers used below are taken from a recycled workspace, so this does not allocate memory
+  WorkspaceGuard ws(*this);
+  return searchPositionIK(*ws, ik_pose, ik_seed_state, timeout, consistency_limits, solution, solution_callback,
+                          error_code, options);
+}
+
+bool KDLKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                                const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                                                std::vector<std::vector<double>>& solutions,
+                                                std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                                                const IKCallbackFn& solution_callback,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  // the default implementation reports invalid seeds
+  if (ik_seed_states.empty() || (ik_seed_states.size() != 1 && ik_seed_states.size() != ik_poses.size()))
+    return KinematicsBase::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes,
+                                                 solution_callback, options);
+
+  solutions.resize(ik_poses.size());
+  error_codes.resize(ik_poses.size());
+
+  // a single workspace serves all poses
+  WorkspaceGuard ws(*this);
+  const std::vector<double> consistency_limits;
+  bool all_found = true;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    const std::vector<double>& seed = ik_seed_states.size() == 1 ? ik_seed_states[0] : ik_seed_states[i];
+    if (!searchPositionIK(*ws, ik_poses[i], seed, timeout, consistency_limits, solutions[i], solution_callback,
+                          error_codes[i], options))
+    {
+      solutions[i].clear();
+      all_found = false;
+    }
+  }
+  return all_found;
+}
+
+bool KDLKinematicsPlugin::searchPositionIK(IKWorkspace& ws, const geometry_msgs::Pose& ik_pose,
+                                           const std::vector<double>& ik_seed_state, double timeout,
+                                           const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                                           const IKCallbackFn& solution_callback,
+                                           moveit_msgs::MoveItErrorCodes& error_code,
+                                           const kinematics::KinematicsQueryOptions& options) const
 {
   ros::WallTime start_time = ros::WallTime::now();
   if (!initialized_)
@@ -336,7 +447,8 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
   }
 
   // Resize consistency limits to remove mimic joints
-  std::vector<double> consistency_limits_mimic;
+  std::vector<double>& consistency_limits_mimic = ws.consistency_limits_mimic;
+  consistency_limits_mimic.clear();
   if (!consistency_limits.empty())
   {
     if (consistency_limits.size() != dimension_)
@@ -357,13 +469,12 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
   cartesian_weights.topRows<3>().setConstant(1.0);
   cartesian_weights.bottomRows<3>().setConstant(orientation_vs_position_weight_);
 
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
+  KDL::JntArray& jnt_seed_state = ws.seed;
+  KDL::JntArray& jnt_pos_in = ws.q_in;
+  KDL::JntArray& jnt_pos_out = ws.q_out;
   jnt_seed_state.data = Eigen::Map<const Eigen::VectorXd>(ik_seed_state.data(), ik_seed_state.size());
   jnt_pos_in = jnt_seed_state;
 
-  KDL::ChainIkSolverVelMimicSVD ik_solver_vel(kdl_chain_, mimic_joints_, orientation_vs_position_weight_ == 0.0);
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
@@ -387,9 +498,7 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
       ROS_DEBUG_STREAM_NAMED("kdl", "New random configuration (" << attempt << "): " << jnt_pos_in);
     }
 
-    int ik_valid =
-        CartToJnt(ik_solver_vel, jnt_pos_in, pose_desired, jnt_pos_out, max_solver_iterations_,
-                  Eigen::Map<const Eigen::VectorXd>(joint_weights_.data(), joint_weights_.size()), cartesian_weights);
+    int ik_valid = CartToJnt(ws, pose_desired, max_solver_iterations_, cartesian_weights);
     if (ik_valid == 0 || options.return_approximate_solution)  // found acceptable solution
     {
       if (!consistency_limits_mimic.empty() &&
@@ -419,16 +528,19 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming)
-int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, const KDL::JntArray& q_init,
-                                   const KDL::Frame& p_in, KDL::JntArray& q_out, const unsigned int max_iter,
-                                   const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights) const
+int KDLKinematicsPlugin::CartToJnt(IKWorkspace& ws, const KDL::Frame& p_in, const unsigned int max_iter,
+                                   const Twist& cartesian_weights) const
 {
   double last_delta_twist_norm = DBL_MAX;
   double step_size = 1.0;
   KDL::Frame f;
   KDL::Twist delta_twist;
-  KDL::JntArray delta_q(q_out.rows()), q_backup(q_out.rows());
-  Eigen::ArrayXd extra_joint_weights(joint_weights.rows());
+  KDL::ChainIkSolverVelMimicSVD& ik_solver = ws.ik_solver_vel;
+  const KDL::JntArray& q_init = ws.q_in;
+  KDL::JntArray& q_out = ws.q_out;
+  KDL::JntArray& delta_q = ws.delta_q;
+  KDL::JntArray& q_backup = ws.q_backup;
+  Eigen::ArrayXd& extra_joint_weights = ws.extra_joint_weights;
   extra_joint_weights.setOnes();
 
   q_out = q_init;
@@ -438,7 +550,7 @@ int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, con
   bool success = false;
   for (i = 0; i < max_iter; ++i)
   {
-    fk_solver_->JntToCart(q_out, f);
+    ws.fk_solver.JntToCart(q_out, f);
     delta_twist = diff(f, p_in);
     ROS_DEBUG_STREAM_NAMED("kdl", "[" << std::setw(3) << i << "] delta_twist: " << delta_twist);
 
@@ -468,7 +580,8 @@ int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, con
       step_size = 1.0;   // reset step size
       last_delta_twist_norm = delta_twist_norm;
 
-      ik_solver.CartToJnt(q_out, delta_twist, delta_q, extra_joint_weights * joint_weights.array(), cartesian_weights);
+      ws.weighted_joint_weights.array() = extra_joint_weights * joint_weights_vector_.array();
+      ik_solver.CartToJnt(q_out, delta_twist, delta_q, ws.weighted_joint_weights, cartesian_weights);
     }
 
     clipToJointLimits(q_out, delta_q, extra_joint_weights);
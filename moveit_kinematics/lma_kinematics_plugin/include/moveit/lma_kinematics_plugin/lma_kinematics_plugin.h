@@ -57,6 +57,9 @@
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
 
+#include <memory>
+#include <mutex>
+
 namespace lma_kinematics_plugin
 {
 /**
@@ -71,6 +74,8 @@ public:
    */
   LMAKinematicsPlugin();
 
+  ~LMAKinematicsPlugin() override;
+
   bool
   getPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
                 std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
@@ -98,6 +103,13 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  /// Solves the poses one after another, reusing the solver and buffers of a single workspace for all of them
+  bool searchPositionIKBatch(
+      const std::vector<geometry_msgs::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::MoveItErrorCodes>& error_codes, const IKCallbackFn& solution_callback = IKCallbackFn(),
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::Pose>& poses) const override;
 
@@ -116,6 +128,44 @@ public:
   const std::vector<std::string>& getLinkNames() const override;
 
 private:
+  /** Solver and scratch buffers needed by a single IK query.
+   *  Workspaces are created up front and recycled, so that IK queries do not allocate memory after warm-up. */
+  struct IKWorkspace;
+
+  /// Take a workspace from the pool, creating a new one if all are in use (e.g. by concurrent queries)
+  std::unique_ptr<IKWorkspace> acquireWorkspace() const;
+  /// Return a workspace to the pool
+  void releaseWorkspace(std::unique_ptr<IKWorkspace> ws) const;
+
+  /// Holds a workspace of the pool and returns it when going out of scope, also if the query throws
+  class WorkspaceGuard
+  {
+  public:
+    explicit WorkspaceGuard(const LMAKinematicsPlugin& plugin);
+    ~WorkspaceGuard();
+    WorkspaceGuard(const WorkspaceGuard&) = delete;
+    WorkspaceGuard& operator=(const WorkspaceGuard&) = delete;
+
+    IKWorkspace& operator*() const
+    {
+      return *ws_;
+    }
+    IKWorkspace* operator->() const
+    {
+      return ws_.get();
+    }
+
+  private:
+    const LMAKinematicsPlugin& plugin_;
+    std::unique_ptr<IKWorkspace> ws_;
+  };
+
+  /// Implementation of searchPositionIK() using the given workspace
+  bool searchPositionIK(IKWorkspace& ws, const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                        double timeout, const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                        const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const;
+
   bool timedOut(const ros::WallTime& start_time, double duration) const;
 
   /** @brief Check whether the solution lies within the consistency limits of the seed state
@@ -153,6 +203,9 @@ private:
   std::vector<const moveit::core::JointModel*> joints_;
   std::vector<std::string> joint_names_;
 
+  mutable std::mutex workspaces_mutex_;                           ///< protects workspaces_
+  mutable std::vector<std::unique_ptr<IKWorkspace>> workspaces_;  ///< pool of currently unused workspaces
+
   int max_solver_iterations_;
   double epsilon_;
   /** weight of orientation error vs position error
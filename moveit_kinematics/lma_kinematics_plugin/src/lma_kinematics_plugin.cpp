@@ -43,16 +43,69 @@
 #include <kdl/frames_io.hpp>
 #include <kdl/kinfam_io.hpp>
 
+#include <thread>
+
 // register as a KinematicsBase implementation
 #include <class_loader/class_loader.hpp>
 CLASS_LOADER_REGISTER_CLASS(lma_kinematics_plugin::LMAKinematicsPlugin, kinematics::KinematicsBase)
 
 namespace lma_kinematics_plugin
 {
+struct LMAKinematicsPlugin::IKWorkspace
+{
+  IKWorkspace(const KDL::Chain& chain, const Eigen::Matrix<double, 6, 1>& cartesian_weights, double epsilon,
+              int max_iterations, unsigned int dimension)
+    : ik_solver_pos(chain, cartesian_weights, epsilon, max_iterations)
+    , seed(dimension)
+    , q_in(dimension)
+    , q_out(dimension)
+  {
+  }
+
+  KDL::ChainIkSolverPos_LMA ik_solver_pos;
+  KDL::JntArray seed, q_in, q_out;
+};
+
 LMAKinematicsPlugin::LMAKinematicsPlugin() : initialized_(false)
 {
 }
 
+LMAKinematicsPlugin::~LMAKinematicsPlugin() = default;
+
+std::unique_ptr<LMAKinematicsPlugin::IKWorkspace> LMAKinematicsPlugin::acquireWorkspace() const
+{
+  {
+    std::lock_guard<std::mutex> lock(workspaces_mutex_);
+    if (!workspaces_.empty())
+    {
+      std::unique_ptr<IKWorkspace> ws = std::move(workspaces_.back());
+      workspaces_.pop_back();
+      return ws;
+    }
+  }
+
+  Eigen::Matrix<double, 6, 1> cartesian_weights;
+  cartesian_weights.topRows<3>().setConstant(1.0);
+  cartesian_weights.bottomRows<3>().setConstant(orientation_vs_position_weight_);
+  return std::make_unique<IKWorkspace>(kdl_chain_, cartesian_weights, epsilon_, max_solver_iterations_, dimension_);
+}
+
+void LMAKinematicsPlugin::releaseWorkspace(std::unique_ptr<IKWorkspace> ws) const
+{
+  std::lock_guard<std::mutex> lock(workspaces_mutex_);
+  workspaces_.push_back(std::move(ws));
+}
+
+LMAKinematicsPlugin::WorkspaceGuard::WorkspaceGuard(const LMAKinematicsPlugin& plugin)
+  : plugin_(plugin), ws_(plugin.acquireWorkspace())
+{
+}
+
+LMAKinematicsPlugin::WorkspaceGuard::~WorkspaceGuard()
+{
+  plugin_.releaseWorkspace(std::move(ws_));
+}
+
 void LMAKinematicsPlugin::getRandomConfiguration(Eigen::VectorXd& jnt_array) const
 {
   state_->setToRandomPositions(joint_model_group_);
@@ -137,6 +190,11 @@ bool LMAKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
 
   fk_solver_.reset(new KDL::ChainFkSolverPos_recursive(kdl_chain_));
 
+  // Preallocate one workspace for IK queries, and room in the pool for concurrent callers to return theirs
+  workspaces_.clear();
+  workspaces_.reserve(std::max(1u, std::thread::hardware_concurrency()));
+  releaseWorkspace(acquireWorkspace());
+
   initialized_ = true;
   ROS_DEBUG_NAMED("lma", "LMA solver initialized");
   return true;
@@ -210,6 +268,51 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
                                            std::vector<double>& solution, const IKCallbackFn& solution_callback,
                                            moveit_msgs::MoveItErrorCodes& error_code,
                                            const kinematics::KinematicsQueryOptions& options) const
+{
+  // The solver and all buffers are taken from a recycled workspace, so this does not allocate memory
+  WorkspaceGuard ws(*this);
+  return searchPositionIK(*ws, ik_pose, ik_seed_state, timeout, consistency_limits, solution, solution_callback,
+                          error_code, options);
+}
+
+bool LMAKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                                const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                                                std::vector<std::vector<double>>& solutions,
+                                                std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                                                const IKCallbackFn& solution_callback,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  // the default implementation reports invalid seeds
+  if (ik_seed_states.empty() || (ik_seed_states.size() != 1 && ik_seed_states.size() != ik_poses.size()))
+    return KinematicsBase::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes,
+                                                 solution_callback, options);
+
+  solutions.resize(ik_poses.size());
+  error_codes.resize(ik_poses.size());
+
+  // a single workspace serves all poses
+  WorkspaceGuard ws(*this);
+  const std::vector<double> consistency_limits;
+  bool all_found = true;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    const std::vector<double>& seed = ik_seed_states.size() == 1 ? ik_seed_states[0] : ik_seed_states[i];
+    if (!searchPositionIK(*ws, ik_poses[i], seed, timeout, consistency_limits, solutions[i], solution_callback,
+                          error_codes[i], options))
+    {
+      solutions[i].clear();
+      all_found = false;
+    }
+  }
+  return all_found;
+}
+
+bool LMAKinematicsPlugin::searchPositionIK(IKWorkspace& ws, const geometry_msgs::Pose& ik_pose,
+                                           const std::vector<double>& ik_seed_state, double timeout,
+                                           const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                                           const IKCallbackFn& solution_callback,
+                                           moveit_msgs::MoveItErrorCodes& error_code,
+                                           const kinematics::KinematicsQueryOptions& options) const
 {
   ros::WallTime start_time = ros::WallTime::now();
   if (!initialized_)
@@ -235,21 +338,13 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
     return false;
   }
 
-  Eigen::Matrix<double, 6, 1> cartesian_weights;
-  cartesian_weights(0) = 1;
-  cartesian_weights(1) = 1;
-  cartesian_weights(2) = 1;
-  cartesian_weights(3) = orientation_vs_position_weight_;
-  cartesian_weights(4) = orientation_vs_position_weight_;
-  cartesian_weights(5) = orientation_vs_position_weight_;
-
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
+  KDL::ChainIkSolverPos_LMA& ik_solver_pos = ws.ik_solver_pos;
+  KDL::JntArray& jnt_seed_state = ws.seed;
+  KDL::JntArray& jnt_pos_in = ws.q_in;
+  KDL::JntArray& jnt_pos_out = ws.q_out;
   jnt_seed_state.data = Eigen::Map<const Eigen::VectorXd>(ik_seed_state.data(), ik_seed_state.size());
   jnt_pos_in = jnt_seed_state;
 
-  KDL::ChainIkSolverPos_LMA ik_solver_pos(kdl_chain_, cartesian_weights, epsilon_, max_solver_iterations_);
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
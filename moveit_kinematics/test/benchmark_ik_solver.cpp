@@ -0,0 +1,161 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <ros/ros.h>
+#include <boost/program_options.hpp>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/robot_state.h>
+
+namespace po = boost::program_options;
+
+// Count heap allocations of the benchmarking thread only, ignoring those of ROS' background threads
+static thread_local std::size_t num_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+  ++num_allocations;
+  if (void* ptr = std::malloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+  std::free(ptr);
+}
+
+/** Benchmark program measuring throughput and heap allocations of the IK solvers of the robot described in
+ * robot_description. In contrast to benchmark_ik, the solvers are called directly, bypassing RobotState::setFromIK(). */
+int main(int argc, char* argv[])
+{
+  std::string group;
+  unsigned int num;
+  unsigned int warmup;
+  po::options_description desc("Options");
+  // clang-format off
+  desc.add_options()
+      ("help", "show help message")
+      ("group", po::value<std::string>(&group)->default_value("all"), "name of planning group")
+      ("num", po::value<unsigned int>(&num)->default_value(10000), "number of IK solutions to compute")
+      ("warmup", po::value<unsigned int>(&warmup)->default_value(10), "number of IK calls excluded from statistics");
+  // clang-format on
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help") != 0u)
+  {
+    std::cout << desc << "\n";
+    return 1;
+  }
+
+  ros::init(argc, argv, "benchmark_ik_solver");
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  robot_model_loader::RobotModelLoader robot_model_loader;
+  const moveit::core::RobotModelPtr& kinematic_model = robot_model_loader.getModel();
+  moveit::core::RobotState kinematic_state(kinematic_model);
+  std::vector<moveit::core::JointModelGroup*> groups;
+
+  if (group == "all")
+    groups = kinematic_model->getJointModelGroups();
+  else
+    groups.push_back(kinematic_model->getJointModelGroup(group));
+
+  for (const auto& group : groups)
+  {
+    // skip group if there's no IK solver
+    const kinematics::KinematicsBaseConstPtr& solver = group->getSolverInstance();
+    if (!solver)
+      continue;
+    if (solver->getTipFrames().size() != 1)
+    {
+      ROS_WARN_NAMED("benchmark_ik_solver", "Skipping group %s with multiple tips", group->getName().c_str());
+      continue;
+    }
+
+    // precompute goal poses, so that only the IK calls are measured
+    kinematic_state.setToDefaultValues();
+    std::vector<double> seed;
+    kinematic_state.copyJointGroupPositions(group, seed);
+    std::vector<geometry_msgs::Pose> goals(warmup + num);
+    std::vector<double> values;
+    for (geometry_msgs::Pose& goal : goals)
+    {
+      kinematic_state.setToRandomPositions(group);
+      kinematic_state.copyJointGroupPositions(group, values);
+      std::vector<geometry_msgs::Pose> poses;
+      solver->getPositionFK(solver->getTipFrames(), values, poses);
+      goal = poses[0];
+    }
+
+    std::vector<double> solution(seed.size());
+    moveit_msgs::MoveItErrorCodes error_code;
+    std::chrono::duration<double> ik_time(0);
+    std::size_t allocations = 0;
+    unsigned int num_failed_calls = 0;
+    for (unsigned int i = 0; i < goals.size(); ++i)
+    {
+      const std::size_t allocations_before = num_allocations;
+      const auto start = std::chrono::steady_clock::now();
+      bool found_ik = solver->searchPositionIK(goals[i], seed, 0.1, solution, error_code);
+      const auto end = std::chrono::steady_clock::now();
+      if (i < warmup)
+        continue;
+      allocations += num_allocations - allocations_before;
+      ik_time += end - start;
+      if (!found_ik)
+        ++num_failed_calls;
+    }
+
+    ROS_INFO_NAMED("benchmark_ik_solver",
+                   "Summary for group %s: %g solves/s, %g allocations per call, %g%% of calls failed to return a "
+                   "solution.",
+                   group->getName().c_str(), num / ik_time.count(), (double)allocations / num,
+                   100. * num_failed_calls / num);
+  }
+
+  ros::shutdown();
+  return 0;
+}
@@ -50,6 +50,7 @@
 #include <moveit/robot_state/robot_state.h>
 
 #include <moveit/robot_state/conversions.h>
+#include <moveit/robot_state/cartesian_interpolator.h>
 #include <moveit_msgs/DisplayTrajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
@@ -607,6 +608,99 @@ TEST_F(KinematicsTest, searchIKWithCallback)
   EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_cb_tests_);
 }
 
+TEST_F(KinematicsTest, searchIKBatch)
+{
+  std::vector<double> fk_values;
+  const std::vector<std::string>& fk_names = kinematics_solver_->getTipFrames();
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+
+  std::vector<geometry_msgs::Pose> goals;
+  for (unsigned int i = 0; i < num_ik_tests_; ++i)
+  {
+    robot_state.setToRandomPositions(jmg_, this->rng_);
+    robot_state.copyJointGroupPositions(jmg_, fk_values);
+    std::vector<geometry_msgs::Pose> poses;
+    ASSERT_TRUE(kinematics_solver_->getPositionFK(fk_names, fk_values, poses));
+    goals.push_back(poses[0]);
+  }
+
+  // a single seed shared by all poses
+  const std::vector<std::vector<double>> seeds(1, std::vector<double>(kinematics_solver_->getJointNames().size(), 0.0));
+  std::vector<std::vector<double>> solutions;
+  std::vector<moveit_msgs::MoveItErrorCodes> error_codes;
+  kinematics_solver_->searchPositionIKBatch(goals, seeds, timeout_, solutions, error_codes);
+  ASSERT_EQ(solutions.size(), goals.size());
+  ASSERT_EQ(error_codes.size(), goals.size());
+
+  unsigned int success = 0;
+  for (std::size_t i = 0; i < goals.size(); ++i)
+  {
+    if (error_codes[i].val != error_codes[i].SUCCESS)
+    {
+      EXPECT_TRUE(solutions[i].empty());
+      continue;
+    }
+    success++;
+
+    std::vector<geometry_msgs::Pose> reached_poses;
+    kinematics_solver_->getPositionFK(fk_names, solutions[i], reached_poses);
+    EXPECT_NEAR_POSES({ goals[i] }, reached_poses, tolerance_);
+  }
+
+  ROS_INFO_STREAM("Success Rate: " << (double)success / num_ik_tests_);
+  EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_tests_);
+}
+
+TEST_F(KinematicsTest, searchIKBatchMatchesSingleQueries)
+{
+  std::vector<double> fk_values;
+  const std::vector<std::string>& fk_names = kinematics_solver_->getTipFrames();
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+
+  std::vector<geometry_msgs::Pose> goals;
+  std::vector<std::vector<double>> seeds;
+  for (unsigned int i = 0; i < num_ik_tests_; ++i)
+  {
+    robot_state.setToRandomPositions(jmg_, this->rng_);
+    robot_state.copyJointGroupPositions(jmg_, fk_values);
+    std::vector<geometry_msgs::Pose> poses;
+    ASSERT_TRUE(kinematics_solver_->getPositionFK(fk_names, fk_values, poses));
+    goals.push_back(poses[0]);
+
+    // one seed per pose, near its solution
+    for (double& value : fk_values)
+      value += 0.05;
+    seeds.push_back(fk_values);
+  }
+
+  // a timeout of zero allows a single attempt from the seed, without random restarts, so the results are
+  // deterministic and the override must return exactly what the default implementation returns
+  std::vector<std::vector<double>> solutions, expected_solutions;
+  std::vector<moveit_msgs::MoveItErrorCodes> error_codes, expected_error_codes;
+  const bool found = kinematics_solver_->searchPositionIKBatch(goals, seeds, 0.0, solutions, error_codes);
+  const bool expected_found = kinematics_solver_->kinematics::KinematicsBase::searchPositionIKBatch(
+      goals, seeds, 0.0, expected_solutions, expected_error_codes);
+  EXPECT_EQ(found, expected_found);
+  ASSERT_EQ(solutions.size(), goals.size());
+  ASSERT_EQ(error_codes.size(), goals.size());
+  ASSERT_EQ(expected_solutions.size(), goals.size());
+
+  unsigned int success = 0;
+  for (std::size_t i = 0; i < goals.size(); ++i)
+  {
+    EXPECT_EQ(error_codes[i].val, expected_error_codes[i].val) << i;
+    ASSERT_EQ(solutions[i].size(), expected_solutions[i].size()) << i;
+    for (std::size_t j = 0; j < solutions[i].size(); ++j)
+      EXPECT_NEAR(solutions[i][j], expected_solutions[i][j], 1e-12) << i;
+    if (error_codes[i].val == error_codes[i].SUCCESS)
+      success++;
+  }
+  ROS_INFO_STREAM("Success Rate: " << (double)success / num_ik_tests_);
+  EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_tests_);
+}
+
 TEST_F(KinematicsTest, getIK)
 {
   std::vector<double> fk_values, solution;
@@ -732,6 +826,176 @@ TEST_F(KinematicsTest, getNearestIKSolution)
   }
 }
 
+// Distance of p from the line segment between a and b
+double distanceToSegment(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b)
+{
+  const Eigen::Vector3d ab = b - a;
+  double t = ab.squaredNorm() > 0.0 ? (p - a).dot(ab) / ab.squaredNorm() : 0.0;
+  t = std::min(1.0, std::max(0.0, t));
+  return (a + t * ab - p).norm();
+}
+
+// Tests for the adaptive variants of CartesianInterpolator::computeCartesianPath(), using the solver under test
+class CartesianPathTest : public KinematicsTest
+{
+protected:
+  void SetUp() override
+  {
+    KinematicsTest::SetUp();
+    if (HasFatalFailure() || !getParam("test_cartesian_path", enabled_) || !enabled_)
+      return;
+
+    // let RobotState::setFromIK() use the solver under test
+    kinematics::KinematicsBasePtr solver = kinematics_solver_;
+    jmg_->setSolverAllocators([solver](const moveit::core::JointModelGroup* /*unused*/) { return solver; });
+    ASSERT_EQ(jmg_->getSolverInstance(), solver);
+
+    start_state_ = std::make_shared<moveit::core::RobotState>(robot_model_);
+    start_state_->setToDefaultValues();
+    if (!seed_.empty())
+      start_state_->setJointGroupPositions(jmg_, seed_);
+    start_state_->update();
+    link_ = robot_model_->getLinkModel(tip_link_);
+    start_pose_ = start_state_->getGlobalLinkTransform(link_);
+  }
+
+  void TearDown() override
+  {
+    // the robot model is shared by all tests, don't keep the solver alive beyond its loader
+    if (enabled_)
+      jmg_->setSolverAllocators(
+          [](const moveit::core::JointModelGroup* /*unused*/) { return kinematics::KinematicsBasePtr(); });
+  }
+
+  // Expect the link to follow the polyline through points with constant orientation, at each state of traj
+  // and in the middle of each step
+  void expectOnPath(const std::vector<moveit::core::RobotStatePtr>& traj, const EigenSTL::vector_Vector3d& points,
+                    const moveit::core::CartesianPrecision& precision)
+  {
+    const Eigen::Quaterniond orientation(start_pose_.linear());
+    moveit::core::RobotState mid_state(robot_model_);
+    for (std::size_t i = 1; i < traj.size(); ++i)
+    {
+      traj[i - 1]->interpolate(*traj[i], 0.5, mid_state, jmg_);
+      for (moveit::core::RobotState* state : { traj[i].get(), &mid_state })
+      {
+        const Eigen::Isometry3d& pose = state->getGlobalLinkTransform(link_);
+        double distance = std::numeric_limits<double>::infinity();
+        for (std::size_t j = 1; j < points.size(); ++j)
+          distance = std::min(distance, distanceToSegment(pose.translation(), points[j - 1], points[j]));
+        EXPECT_LE(distance, precision.translational + tolerance_) << "step " << i;
+        EXPECT_LE(Eigen::Quaterniond(pose.linear()).angularDistance(orientation), precision.rotational + tolerance_)
+            << "step " << i;
+      }
+    }
+  }
+
+  bool enabled_ = false;
+  moveit::core::RobotStatePtr start_state_;
+  const moveit::core::LinkModel* link_ = nullptr;
+  Eigen::Isometry3d start_pose_;
+};
+
+TEST_F(CartesianPathTest, adaptiveSingleTarget)
+{
+  if (!enabled_)
+    return;
+
+  moveit::core::CartesianPrecision precision;
+  const EigenSTL::vector_Vector3d offsets = { Eigen::Vector3d(0.05, 0, 0), Eigen::Vector3d(-0.05, 0, 0),
+                                              Eigen::Vector3d(0, 0.05, 0), Eigen::Vector3d(0, -0.05, 0),
+                                              Eigen::Vector3d(0, 0, 0.05), Eigen::Vector3d(0, 0, -0.05) };
+  for (const Eigen::Vector3d& offset : offsets)
+  {
+    SCOPED_TRACE(::testing::Message() << "offset " << offset.transpose());
+    Eigen::Isometry3d target = start_pose_;
+    target.translation() += offset;
+
+    // the relative jump test must not be confused by the different sizes of the steps
+    moveit::core::RobotState state(*start_state_);
+    std::vector<moveit::core::RobotStatePtr> traj;
+    double fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+        &state, jmg_, traj, link_, target, true, moveit::core::MaxEEFStep(0.02), precision,
+        moveit::core::JumpThreshold(10.0));
+    EXPECT_NEAR(fraction, 1.0, 1e-9);
+    ASSERT_GE(traj.size(), 2u);
+    expectOnPath(traj, { start_pose_.translation(), target.translation() }, precision);
+  }
+}
+
+TEST_F(CartesianPathTest, adaptiveWaypoints)
+{
+  if (!enabled_)
+    return;
+
+  moveit::core::CartesianPrecision precision;
+  EigenSTL::vector_Isometry3d waypoints(2, start_pose_);
+  waypoints[0].translation() += Eigen::Vector3d(0.05, 0, 0);
+  waypoints[1].translation() += Eigen::Vector3d(0.05, 0.05, 0);
+
+  moveit::core::RobotState state(*start_state_);
+  std::vector<moveit::core::RobotStatePtr> traj;
+  double fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+      &state, jmg_, traj, link_, waypoints, true, moveit::core::MaxEEFStep(0.02), precision,
+      moveit::core::JumpThreshold(10.0));
+  EXPECT_NEAR(fraction, 1.0, 1e-9);
+  ASSERT_GE(traj.size(), 3u);
+  EXPECT_TRUE(traj.back()->getGlobalLinkTransform(link_).translation().isApprox(waypoints[1].translation(), 1e-3));
+  expectOnPath(traj, { start_pose_.translation(), waypoints[0].translation(), waypoints[1].translation() },
+               precision);
+
+  // states of a previous path are replaced, not extended
+  const std::size_t size = traj.size();
+  state = *start_state_;
+  fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+      &state, jmg_, traj, link_, waypoints, true, moveit::core::MaxEEFStep(0.02), precision,
+      moveit::core::JumpThreshold(10.0));
+  EXPECT_NEAR(fraction, 1.0, 1e-9);
+  EXPECT_EQ(traj.size(), size);
+}
+
+TEST_F(CartesianPathTest, adaptiveStopsAtJump)
+{
+  if (!enabled_)
+    return;
+
+  // coarse steps cannot be bisected, so any step moves the joints by more than the absolute thresholds
+  moveit::core::CartesianPrecision precision;
+  precision.max_resolution = 0.4;
+  const moveit::core::JumpThreshold jump_threshold(1e-3, 1e-3);
+  Eigen::Isometry3d target = start_pose_;
+  target.translation() += Eigen::Vector3d(0.1, 0, 0);
+  EigenSTL::vector_Isometry3d waypoints(1, target);
+
+  auto expect_no_jump = [&](const std::vector<moveit::core::RobotStatePtr>& traj) {
+    for (std::size_t i = 1; i < traj.size(); ++i)
+      for (const moveit::core::JointModel* joint : jmg_->getActiveJointModels())
+        EXPECT_LE(traj[i]->distance(*traj[i - 1], joint), jump_threshold.revolute);
+  };
+
+  moveit::core::RobotState state(*start_state_);
+  std::vector<moveit::core::RobotStatePtr> traj;
+  double fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+      &state, jmg_, traj, link_, target, true, moveit::core::MaxEEFStep(0.05), precision, jump_threshold);
+  EXPECT_LT(fraction, 1.0);
+  expect_no_jump(traj);
+
+  state = *start_state_;
+  traj.clear();
+  fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+      &state, jmg_, traj, link_, waypoints, true, moveit::core::MaxEEFStep(0.05), precision, jump_threshold);
+  EXPECT_LT(fraction, 1.0);
+  expect_no_jump(traj);
+
+  // without the thresholds and with bisection allowed, the same path is complete
+  state = *start_state_;
+  traj.clear();
+  fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+      &state, jmg_, traj, link_, target, true, moveit::core::MaxEEFStep(0.05), moveit::core::CartesianPrecision(),
+      moveit::core::JumpThreshold());
+  EXPECT_NEAR(fraction, 1.0, 1e-9);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
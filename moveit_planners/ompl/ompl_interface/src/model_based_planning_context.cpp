@@ -47,6 +47,7 @@
 
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/profiler/profiler.h>
+#include <moveit/profiler/tracer.h>
 #include <moveit/utils/lexical_casts.h>
 
 #include <ompl/config.h>
@@ -399,12 +400,14 @@ void ompl_interface::ModelBasedPlanningContext::setPlanningVolume(const moveit_m
 
 void ompl_interface::ModelBasedPlanningContext::simplifySolution(double timeout)
 {
+  MOVEIT_TRACE_SCOPE("ModelBasedPlanningContext::simplifySolution");
   ompl_simple_setup_->simplifySolution(timeout);
   last_simplify_time_ = ompl_simple_setup_->getLastSimplificationTime();
 }
 
 void ompl_interface::ModelBasedPlanningContext::interpolateSolution()
 {
+  MOVEIT_TRACE_SCOPE("ModelBasedPlanningContext::interpolateSolution");
   if (ompl_simple_setup_->haveSolutionPath())
   {
     og::PathGeometric& pg = ompl_simple_setup_->getSolutionPath();
@@ -757,6 +760,7 @@ bool ompl_interface::ModelBasedPlanningContext::solve(planning_interface::Motion
 bool ompl_interface::ModelBasedPlanningContext::solve(double timeout, unsigned int count)
 {
   moveit::tools::Profiler::ScopedBlock sblock("PlanningContext:Solve");
+  MOVEIT_TRACE_SCOPE("ModelBasedPlanningContext::solve");
   ompl::time::point start = ompl::time::now();
   preSolve();
 
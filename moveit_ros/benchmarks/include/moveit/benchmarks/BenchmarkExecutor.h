@@ -50,6 +50,7 @@
 #include <pluginlib/class_loader.hpp>
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <boost/function.hpp>
@@ -58,6 +59,9 @@ namespace moveit_ros_benchmarks
 {
 /// A class that executes motion plan requests and aggregates data across multiple runs
 /// Note: This class operates outside of MoveGroup and does NOT use PlanningRequestAdapters
+/// Note: When running several jobs in parallel, the runs of a planner are distributed over worker threads that plan on
+/// their own copy of the planning scene. Pre-run and post-run events are never invoked concurrently, but each run
+/// passes its own copy of the request to the pre-run events.
 class BenchmarkExecutor
 {
 public:
@@ -198,6 +202,19 @@ protected:
   void runBenchmark(moveit_msgs::MotionPlanRequest request,
                     const std::map<std::string, std::vector<std::string>>& planners, int runs);
 
+  /// Solve the given request once, then invoke the post-run events and collect the metrics of the run
+  bool runPlanner(const moveit_msgs::MotionPlanRequest& request,
+                  const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                  const planning_scene::PlanningScenePtr& scene,
+                  const planning_interface::PlanningContextPtr& planning_context,
+                  planning_interface::MotionPlanDetailedResponse& response, PlannerRunData& run_data);
+
+  /// Get the path of the log files written for the given request, without the start time and extension
+  std::string getOutputFilePrefix(const BenchmarkRequest& brequest) const;
+
+  /// Check whether a complete log file was already written for the given request
+  bool hasOutput(const BenchmarkRequest& brequest) const;
+
   planning_scene_monitor::PlanningSceneMonitor* psm_;
   moveit_warehouse::PlanningSceneStorage* pss_;
   moveit_warehouse::PlanningSceneWorldStorage* psws_;
@@ -220,5 +237,8 @@ protected:
   std::vector<PlannerCompletionEventFunction> planner_completion_fns_;
   std::vector<QueryStartEventFunction> query_start_fns_;
   std::vector<QueryCompletionEventFunction> query_end_fns_;
+
+  /// Serializes the invocation of run events when running several jobs in parallel
+  std::mutex run_events_lock_;
 };
 }  // namespace moveit_ros_benchmarks
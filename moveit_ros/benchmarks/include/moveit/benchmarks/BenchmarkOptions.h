@@ -68,6 +68,10 @@ public:
   int getNumRuns() const;
   /** \brief Get the maximum timeout per planning attempt */
   double getTimeout() const;
+  /** \brief Get the number of runs executed concurrently (0 uses one job per hardware thread) */
+  int getNumParallelJobs() const;
+  /** \brief Whether queries with existing result logs in the output directory are skipped */
+  bool getResume() const;
   /** \brief Get the reference name of the benchmark */
   const std::string& getBenchmarkName() const;
   /** \brief Get the name of the planning group to run the benchmark with */
@@ -118,6 +122,8 @@ protected:
   /// benchmark parameters
   int runs_;
   double timeout_;
+  int parallel_jobs_ = 1;
+  bool resume_ = false;
   std::string benchmark_name_;
   std::string group_name_;
   std::string output_directory_;
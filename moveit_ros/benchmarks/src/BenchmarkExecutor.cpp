@@ -47,6 +47,8 @@
 #include <boost/math/constants/constants.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <atomic>
+#include <thread>
 #ifndef _WIN32
 #include <unistd.h>
 #else
@@ -211,6 +213,14 @@ bool BenchmarkExecutor::runBenchmarks(const BenchmarkOptions& opts)
 
     for (std::size_t i = 0; i < queries.size(); ++i)
     {
+      // Skip the queries that were completed by an earlier, interrupted benchmark
+      if (options_.getResume() && hasOutput(queries[i]))
+      {
+        ROS_INFO("Skipping query '%s' (%lu of %lu), results already exist", queries[i].name.c_str(), i + 1,
+                 queries.size());
+        continue;
+      }
+
       // Configure planning scene
       if (scene_msg.robot_model_name != planning_scene_->getRobotModel()->getName())
       {
@@ -758,6 +768,11 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
 
   boost::progress_display progress(num_planners * runs, std::cout);
 
+  int num_jobs = options_.getNumParallelJobs();
+  if (num_jobs <= 0)
+    num_jobs = std::max(1u, std::thread::hardware_concurrency());
+  num_jobs = std::min(num_jobs, runs);
+
   // Iterate through all planning pipelines
   for (const std::pair<const std::string, std::vector<std::string>>& pipeline_entry : pipeline_map)
   {
@@ -779,49 +794,61 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
       for (PlannerStartEventFunction& planner_start_fn : planner_start_fns_)
         planner_start_fn(request, planner_data);
 
-      planning_interface::PlanningContextPtr planning_context;
-      if (use_planning_context)
-        planning_context = planning_pipeline->getPlannerManager()->getPlanningContext(planning_scene_, request);
-
-      // Iterate runs
-      for (int j = 0; j < runs; ++j)
+      if (num_jobs <= 1)
       {
-        // Pre-run events
-        for (PreRunEventFunction& pre_event_fn : pre_event_fns_)
-          pre_event_fn(request);
-
-        // Solve problem
-        ros::WallTime start = ros::WallTime::now();
+        planning_interface::PlanningContextPtr planning_context;
         if (use_planning_context)
+          planning_context = planning_pipeline->getPlannerManager()->getPlanningContext(planning_scene_, request);
+
+        // Iterate runs
+        for (int j = 0; j < runs; ++j)
         {
-          solved[j] = planning_context->solve(responses[j]);
+          // Pre-run events
+          for (PreRunEventFunction& pre_event_fn : pre_event_fns_)
+            pre_event_fn(request);
+
+          solved[j] = runPlanner(request, planning_pipeline, planning_scene_, planning_context, responses[j],
+                                 planner_data[j]);
+          ++progress;
         }
-        else
-        {
-          // The planning pipeline does not support MotionPlanDetailedResponse
-          planning_interface::MotionPlanResponse response;
-          solved[j] = planning_pipeline->generatePlan(planning_scene_, request, response);
-          responses[j].error_code_ = response.error_code_;
-          if (response.trajectory_)
+      }
+      else
+      {
+        // The runs are independent of each other, so workers pick them up in any order
+        std::atomic<int> next_run(0);
+        std::mutex progress_lock;
+        auto run_worker = [&]() {
+          planning_scene::PlanningScenePtr scene = planning_scene::PlanningScene::clone(planning_scene_);
+          planning_interface::PlanningContextPtr planning_context;
+          if (use_planning_context)
+            planning_context = planning_pipeline->getPlannerManager()->getPlanningContext(scene, request);
+
+          for (int j = next_run++; j < runs; j = next_run++)
           {
-            responses[j].description_.push_back("plan");
-            responses[j].trajectory_.push_back(response.trajectory_);
-            responses[j].processing_time_.push_back(response.planning_time_);
+            moveit_msgs::MotionPlanRequest run_request = request;
+            {
+              // Pre-run events
+              std::lock_guard<std::mutex> lock(run_events_lock_);
+              for (PreRunEventFunction& pre_event_fn : pre_event_fns_)
+                pre_event_fn(run_request);
+            }
+
+            bool run_solved =
+                runPlanner(run_request, planning_pipeline, scene, planning_context, responses[j], planner_data[j]);
+
+            // std::vector<bool> elements cannot be written concurrently
+            std::lock_guard<std::mutex> lock(progress_lock);
+            solved[j] = run_solved;
+            ++progress;
           }
-        }
-        double total_time = (ros::WallTime::now() - start).toSec();
-
-        // Collect data
-        start = ros::WallTime::now();
-
-        // Post-run events
-        for (PostRunEventFunction& post_event_fn : post_event_fns_)
-          post_event_fn(request, responses[j], planner_data[j]);
-        collectMetrics(planner_data[j], responses[j], solved[j], total_time);
-        double metrics_time = (ros::WallTime::now() - start).toSec();
-        ROS_DEBUG("Spent %lf seconds collecting metrics", metrics_time);
-
-        ++progress;
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(num_jobs);
+        for (int k = 0; k < num_jobs; ++k)
+          workers.emplace_back(run_worker);
+        for (std::thread& worker : workers)
+          worker.join();
       }
 
       computeAveragePathSimilarities(planner_data, responses, solved);
@@ -835,6 +862,50 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
   }
 }
 
+bool BenchmarkExecutor::runPlanner(const moveit_msgs::MotionPlanRequest& request,
+                                   const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                   const planning_scene::PlanningScenePtr& scene,
+                                   const planning_interface::PlanningContextPtr& planning_context,
+                                   planning_interface::MotionPlanDetailedResponse& response, PlannerRunData& run_data)
+{
+  // Solve problem
+  bool solved;
+  ros::WallTime start = ros::WallTime::now();
+  if (planning_context)
+  {
+    solved = planning_context->solve(response);
+  }
+  else
+  {
+    // The planning pipeline does not support MotionPlanDetailedResponse
+    planning_interface::MotionPlanResponse mp_response;
+    solved = planning_pipeline->generatePlan(scene, request, mp_response);
+    response.error_code_ = mp_response.error_code_;
+    if (mp_response.trajectory_)
+    {
+      response.description_.push_back("plan");
+      response.trajectory_.push_back(mp_response.trajectory_);
+      response.processing_time_.push_back(mp_response.planning_time_);
+    }
+  }
+  double total_time = (ros::WallTime::now() - start).toSec();
+
+  // Collect data
+  start = ros::WallTime::now();
+
+  // Post-run events
+  {
+    std::lock_guard<std::mutex> lock(run_events_lock_);
+    for (PostRunEventFunction& post_event_fn : post_event_fns_)
+      post_event_fn(request, response, run_data);
+  }
+  collectMetrics(run_data, response, solved, total_time);
+  double metrics_time = (ros::WallTime::now() - start).toSec();
+  ROS_DEBUG("Spent %lf seconds collecting metrics", metrics_time);
+
+  return solved;
+}
+
 void BenchmarkExecutor::collectMetrics(PlannerRunData& metrics,
                                        const planning_interface::MotionPlanDetailedResponse& mp_res, bool solved,
                                        double total_time)
@@ -1061,19 +1132,19 @@ void BenchmarkExecutor::writeOutput(const BenchmarkRequest& brequest, const std:
   if (hostname.empty())
     hostname = "UNKNOWN";
 
-  std::string filename = options_.getOutputDirectory();
-  if (!filename.empty() && filename[filename.size() - 1] != '/')
-    filename.append("/");
+  std::string filename = getOutputFilePrefix(brequest) + start_time + ".log";
 
   // Ensure directories exist
-  boost::filesystem::create_directories(filename);
+  boost::filesystem::path directory = boost::filesystem::path(filename).parent_path();
+  if (!directory.empty())
+    boost::filesystem::create_directories(directory);
 
-  filename += (options_.getBenchmarkName().empty() ? "" : options_.getBenchmarkName() + "_") + brequest.name + "_" +
-              getHostname() + "_" + start_time + ".log";
-  std::ofstream out(filename.c_str());
+  // Write to a temporary file first, so that only complete logs are found when resuming a benchmark
+  std::string tmp_filename = filename + ".tmp";
+  std::ofstream out(tmp_filename.c_str());
   if (!out)
   {
-    ROS_ERROR("Failed to open '%s' for benchmark output", filename.c_str());
+    ROS_ERROR("Failed to open '%s' for benchmark output", tmp_filename.c_str());
     return;
   }
 
@@ -1150,5 +1221,43 @@ void BenchmarkExecutor::writeOutput(const BenchmarkRequest& brequest, const std:
   }
 
   out.close();
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    ROS_ERROR("Failed to save benchmark results to '%s': %s", filename.c_str(), ec.message().c_str());
+    return;
+  }
   ROS_INFO("Benchmark results saved to '%s'", filename.c_str());
 }
+
+std::string BenchmarkExecutor::getOutputFilePrefix(const BenchmarkRequest& brequest) const
+{
+  std::string filename = options_.getOutputDirectory();
+  if (!filename.empty() && filename[filename.size() - 1] != '/')
+    filename.append("/");
+
+  filename += (options_.getBenchmarkName().empty() ? "" : options_.getBenchmarkName() + "_") + brequest.name + "_" +
+              getHostname() + "_";
+  return filename;
+}
+
+bool BenchmarkExecutor::hasOutput(const BenchmarkRequest& brequest) const
+{
+  boost::filesystem::path prefix(getOutputFilePrefix(brequest));
+  boost::filesystem::path directory = prefix.has_parent_path() ? prefix.parent_path() : boost::filesystem::path(".");
+  const std::string file_prefix = prefix.filename().string();
+
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(directory, ec))
+    return false;
+  for (boost::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+  {
+    const std::string name = it->path().filename().string();
+    if (name.size() > file_prefix.size() + 4 && name.compare(0, file_prefix.size(), file_prefix) == 0 &&
+        name.compare(name.size() - 4, 4, ".log") == 0)
+      return true;
+  }
+  return false;
+}
@@ -96,6 +96,16 @@ double BenchmarkOptions::getTimeout() const
   return timeout_;
 }
 
+int BenchmarkOptions::getNumParallelJobs() const
+{
+  return parallel_jobs_;
+}
+
+bool BenchmarkOptions::getResume() const
+{
+  return resume_;
+}
+
 const std::string& BenchmarkOptions::getBenchmarkName() const
 {
   return benchmark_name_;
@@ -192,6 +202,8 @@ void BenchmarkOptions::readBenchmarkParameters(ros::NodeHandle& nh)
   nh.param(std::string("benchmark_config/parameters/name"), benchmark_name_, std::string(""));
   nh.param(std::string("benchmark_config/parameters/runs"), runs_, 10);
   nh.param(std::string("benchmark_config/parameters/timeout"), timeout_, 10.0);
+  nh.param(std::string("benchmark_config/parameters/parallel_jobs"), parallel_jobs_, 1);
+  nh.param(std::string("benchmark_config/parameters/resume"), resume_, false);
   nh.param(std::string("benchmark_config/parameters/output_directory"), output_directory_, std::string(""));
   nh.param(std::string("benchmark_config/parameters/queries"), query_regex_, std::string(".*"));
   nh.param(std::string("benchmark_config/parameters/start_states"), start_state_regex_, std::string(""));
@@ -219,6 +231,7 @@ void BenchmarkOptions::readBenchmarkParameters(ros::NodeHandle& nh)
   ROS_INFO("Benchmark name: '%s'", benchmark_name_.c_str());
   ROS_INFO("Benchmark #runs: %d", runs_);
   ROS_INFO("Benchmark timeout: %f secs", timeout_);
+  ROS_INFO("Benchmark parallel jobs: %d", parallel_jobs_);
   ROS_INFO("Benchmark group: %s", group_name_.c_str());
   ROS_INFO("Benchmark query regex: '%s'", query_regex_.c_str());
   ROS_INFO("Benchmark start state regex: '%s':", start_state_regex_.c_str());
@@ -41,6 +41,7 @@
 #include <moveit/planning_interface/planning_interface.h>
 #include <moveit/plan_execution/plan_representation.h>
 #include <moveit/move_group/move_group_context.h>
+#include <functional>
 
 namespace move_group
 {
@@ -92,6 +93,12 @@ protected:
   moveit_msgs::PlanningScene clearSceneRobotState(const moveit_msgs::PlanningScene& scene) const;
   bool performTransform(geometry_msgs::PoseStamped& pose_msg, const std::string& target_frame) const;
 
+  /** \brief Call \e plan_fn once the context's planning request scheduler admits the request, passing the time (in
+      seconds) the request was queued. Without a scheduler, \e plan_fn is called right away. If the request is
+      rejected, or is not admitted within \e allowed_planning_time, \e error_code is set and false is returned. */
+  bool schedulePlanningRequest(int priority, double allowed_planning_time, const std::function<void(double)>& plan_fn,
+                               moveit_msgs::MoveItErrorCodes& error_code) const;
+
   ros::NodeHandle root_node_handle_;
   ros::NodeHandle node_handle_;
   std::string capability_name_;
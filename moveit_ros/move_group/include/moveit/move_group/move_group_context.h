@@ -62,6 +62,7 @@ MOVEIT_CLASS_FORWARD(TrajectoryExecutionManager);  // Defines TrajectoryExecutio
 namespace move_group
 {
 MOVEIT_STRUCT_FORWARD(MoveGroupContext);
+MOVEIT_CLASS_FORWARD(PlanningRequestScheduler);  // Defines PlanningRequestSchedulerPtr, ConstPtr, WeakPtr... etc
 
 struct MoveGroupContext
 {
@@ -76,6 +77,8 @@ struct MoveGroupContext
   planning_pipeline::PlanningPipelinePtr planning_pipeline_;
   plan_execution::PlanExecutionPtr plan_execution_;
   plan_execution::PlanWithSensingPtr plan_with_sensing_;
+  /// Admission control for concurrent planning requests; if not set, requests are planned as they arrive
+  PlanningRequestSchedulerPtr planning_request_scheduler_;
   bool allow_trajectory_execution_;
   bool debug_;
 };
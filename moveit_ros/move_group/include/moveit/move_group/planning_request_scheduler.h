@@ -0,0 +1,117 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace move_group
+{
+MOVEIT_CLASS_FORWARD(PlanningRequestScheduler);  // Defines PlanningRequestSchedulerPtr, ConstPtr, WeakPtr... etc
+
+/** \brief Admission control for planning requests served concurrently by move_group.
+
+    At most a fixed number of requests plan at the same time, and at most a fixed number of further requests wait for
+    their turn; requests beyond that are rejected right away. Waiting requests are admitted by priority, and in arrival
+    order within the same priority. A request that is still waiting when its deadline passes is dropped. Requests run
+    in the thread that submitted them, so callers are expected to be served by a multi-threaded spinner. */
+class PlanningRequestScheduler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /** \brief Priority of requests that are part of a move action; these are admitted before plan service requests */
+  static const int MOVE_ACTION_PRIORITY = 1;
+  /** \brief Priority of plan-only service requests */
+  static const int PLAN_SERVICE_PRIORITY = 0;
+
+  enum class Admission
+  {
+    ADMITTED,
+    QUEUE_FULL,
+    DEADLINE_EXCEEDED
+  };
+
+  /** \brief Queueing and planning statistics; times are in seconds */
+  struct Statistics
+  {
+    std::size_t completed = 0;
+    std::size_t rejected = 0;
+    std::size_t expired = 0;
+    double total_queue_time = 0.0;
+    double max_queue_time = 0.0;
+    double total_planning_time = 0.0;
+    double max_planning_time = 0.0;
+  };
+
+  PlanningRequestScheduler(std::size_t max_concurrent_requests, std::size_t max_queued_requests);
+
+  /** \brief Wait for a free slot and call \e fn with the time (in seconds) the request spent waiting.
+      \e fn is not called if the queue is full or \e deadline passes before a slot becomes free. */
+  Admission run(int priority, const Clock::time_point& deadline, const std::function<void(double)>& fn);
+
+  Statistics getStatistics() const;
+
+  std::size_t getMaxConcurrentRequests() const
+  {
+    return max_concurrent_requests_;
+  }
+
+  std::size_t getMaxQueuedRequests() const
+  {
+    return max_queued_requests_;
+  }
+
+private:
+  // (negated priority, arrival number): the first element is the next request to admit
+  using QueueKey = std::pair<int, std::uint64_t>;
+
+  const std::size_t max_concurrent_requests_;
+  const std::size_t max_queued_requests_;
+
+  mutable std::mutex lock_;
+  std::condition_variable slot_released_;
+  std::set<QueueKey> waiting_;
+  std::size_t running_;
+  std::uint64_t next_arrival_;
+  Statistics statistics_;
+};
+}  // namespace move_group
@@ -43,6 +43,7 @@
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/utils/message_checks.h>
 #include <moveit/move_group/capability_names.h>
+#include <moveit/move_group/planning_request_scheduler.h>
 
 namespace move_group
 {
@@ -165,30 +166,34 @@ void MoveGroupMoveAction::executeMoveCallbackPlanOnly(const moveit_msgs::MoveGro
 {
   ROS_INFO_NAMED(getName(), "Planning request received for MoveGroup action. Forwarding to planning pipeline.");
 
-  // lock the scene so that it does not modify the world representation while diff() is called
-  planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);
-  const planning_scene::PlanningSceneConstPtr& the_scene =
-      (moveit::core::isEmpty(goal->planning_options.planning_scene_diff)) ?
-          static_cast<const planning_scene::PlanningSceneConstPtr&>(lscene) :
-          lscene->diff(goal->planning_options.planning_scene_diff);
   planning_interface::MotionPlanResponse res;
-
-  if (preempt_requested_)
-  {
-    ROS_INFO_NAMED(getName(), "Preempt requested before the goal is planned.");
-    action_res.error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
-    return;
-  }
-
-  try
-  {
-    context_->planning_pipeline_->generatePlan(the_scene, goal->request, res);
-  }
-  catch (std::exception& ex)
-  {
-    ROS_ERROR_NAMED(getName(), "Planning pipeline threw an exception: %s", ex.what());
-    res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
-  }
+  const auto plan = [this, &goal, &res](double /* queue_time */) {
+    // lock the scene so that it does not modify the world representation while diff() is called
+    planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);
+    const planning_scene::PlanningSceneConstPtr& the_scene =
+        (moveit::core::isEmpty(goal->planning_options.planning_scene_diff)) ?
+            static_cast<const planning_scene::PlanningSceneConstPtr&>(lscene) :
+            lscene->diff(goal->planning_options.planning_scene_diff);
+
+    if (preempt_requested_)
+    {
+      ROS_INFO_NAMED(getName(), "Preempt requested before the goal is planned.");
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      return;
+    }
+
+    try
+    {
+      context_->planning_pipeline_->generatePlan(the_scene, goal->request, res);
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED(getName(), "Planning pipeline threw an exception: %s", ex.what());
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    }
+  };
+  schedulePlanningRequest(PlanningRequestScheduler::MOVE_ACTION_PRIORITY, goal->request.allowed_planning_time, plan,
+                          res.error_code_);
 
   convertToMsg(res.trajectory_, action_res.trajectory_start, action_res.planned_trajectory);
   action_res.error_code = res.error_code_;
@@ -200,18 +205,22 @@ bool MoveGroupMoveAction::planUsingPlanningPipeline(const planning_interface::Mo
 {
   setMoveState(PLANNING);
 
-  planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor_);
   bool solved = false;
   planning_interface::MotionPlanResponse res;
-  try
-  {
-    solved = context_->planning_pipeline_->generatePlan(plan.planning_scene_, req, res);
-  }
-  catch (std::exception& ex)
-  {
-    ROS_ERROR_NAMED(getName(), "Planning pipeline threw an exception: %s", ex.what());
-    res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
-  }
+  const auto plan_fn = [this, &req, &plan, &res, &solved](double /* queue_time */) {
+    planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor_);
+    try
+    {
+      solved = context_->planning_pipeline_->generatePlan(plan.planning_scene_, req, res);
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED(getName(), "Planning pipeline threw an exception: %s", ex.what());
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    }
+  };
+  schedulePlanningRequest(PlanningRequestScheduler::MOVE_ACTION_PRIORITY, req.allowed_planning_time, plan_fn,
+                          res.error_code_);
   if (res.trajectory_)
   {
     plan.plan_components_.resize(1);
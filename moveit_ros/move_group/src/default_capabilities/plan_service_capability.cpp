@@ -37,6 +37,8 @@
 #include "plan_service_capability.h"
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/move_group/capability_names.h>
+#include <moveit/move_group/planning_request_scheduler.h>
+#include <algorithm>
 
 namespace move_group
 {
@@ -54,25 +56,57 @@ bool MoveGroupPlanService::computePlanService(moveit_msgs::GetMotionPlan::Reques
                                               moveit_msgs::GetMotionPlan::Response& res)
 {
   ROS_INFO_NAMED(getName(), "Received new planning service request...");
+  const auto plan = [this, &req, &res](double queue_time) {
+    computePlan(req.motion_plan_request, queue_time, res.motion_plan_response);
+  };
+  schedulePlanningRequest(PlanningRequestScheduler::PLAN_SERVICE_PRIORITY,
+                          req.motion_plan_request.allowed_planning_time, plan, res.motion_plan_response.error_code);
+  return true;
+}
+
+void MoveGroupPlanService::computePlan(const moveit_msgs::MotionPlanRequest& req, double queue_time,
+                                       moveit_msgs::MotionPlanResponse& res)
+{
   // before we start planning, ensure that we have the latest robot state received...
-  if (static_cast<bool>(req.motion_plan_request.start_state.is_diff))
+  if (static_cast<bool>(req.start_state.is_diff))
     context_->planning_scene_monitor_->waitForCurrentRobotState(ros::Time::now());
   context_->planning_scene_monitor_->updateFrameTransforms();
 
-  planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
+  if (!context_->planning_request_scheduler_)
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
+    computePlan(ps, req, res);
+    return;
+  }
+
+  // time spent waiting for admission counts against the planning time of the request
+  moveit_msgs::MotionPlanRequest request = req;
+  if (request.allowed_planning_time > 0.0)
+    request.allowed_planning_time = std::max(request.allowed_planning_time - queue_time, 0.0);
+
+  // plan on a private copy, so concurrent requests do not keep the monitored scene locked while they plan
+  planning_scene::PlanningScenePtr scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
+    scene = planning_scene::PlanningScene::clone(ps);
+  }
+  computePlan(scene, request, res);
+}
+
+void MoveGroupPlanService::computePlan(const planning_scene::PlanningSceneConstPtr& scene,
+                                       const moveit_msgs::MotionPlanRequest& req, moveit_msgs::MotionPlanResponse& res)
+{
   try
   {
     planning_interface::MotionPlanResponse mp_res;
-    context_->planning_pipeline_->generatePlan(ps, req.motion_plan_request, mp_res);
-    mp_res.getMessage(res.motion_plan_response);
+    context_->planning_pipeline_->generatePlan(scene, req, mp_res);
+    mp_res.getMessage(res);
   }
   catch (std::exception& ex)
   {
     ROS_ERROR_NAMED(getName(), "Planning pipeline threw an exception: %s", ex.what());
-    res.motion_plan_response.error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+    res.error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
   }
-
-  return true;
 }
 }  // namespace move_group
 
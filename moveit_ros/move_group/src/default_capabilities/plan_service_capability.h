@@ -38,6 +38,7 @@
 
 #include <moveit/move_group/move_group_capability.h>
 #include <moveit_msgs/GetMotionPlan.h>
+#include <moveit/planning_scene/planning_scene.h>
 
 namespace move_group
 {
@@ -50,6 +51,9 @@ public:
 
 private:
   bool computePlanService(moveit_msgs::GetMotionPlan::Request& req, moveit_msgs::GetMotionPlan::Response& res);
+  void computePlan(const moveit_msgs::MotionPlanRequest& req, double queue_time, moveit_msgs::MotionPlanResponse& res);
+  void computePlan(const planning_scene::PlanningSceneConstPtr& scene, const moveit_msgs::MotionPlanRequest& req,
+                   moveit_msgs::MotionPlanResponse& res);
 
   ros::ServiceServer plan_service_;
 };
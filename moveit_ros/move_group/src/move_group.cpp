@@ -41,6 +41,8 @@
 #include <boost/tokenizer.hpp>
 #include <moveit/macros/console_colors.h>
 #include <moveit/move_group/node_name.h>
+#include <moveit/move_group/planning_request_scheduler.h>
+#include <algorithm>
 #include <memory>
 #include <set>
 
@@ -66,6 +68,30 @@ static const char* DEFAULT_CAPABILITIES[] = {
 };
 // clang-format on
 
+// Planning requests may be served concurrently, each in its own spinner thread.
+// 0 concurrent requests disables the planning request scheduler.
+static const int DEFAULT_MAX_CONCURRENT_PLANNING_REQUESTS = 0;
+static const int DEFAULT_MAX_QUEUED_PLANNING_REQUESTS = 8;
+
+void getPlanningRequestLimits(const ros::NodeHandle& nh, std::size_t& max_concurrent, std::size_t& max_queued)
+{
+  int concurrent, queued;
+  nh.param("max_concurrent_planning_requests", concurrent, DEFAULT_MAX_CONCURRENT_PLANNING_REQUESTS);
+  nh.param("max_queued_planning_requests", queued, DEFAULT_MAX_QUEUED_PLANNING_REQUESTS);
+  max_concurrent = std::max(concurrent, 0);
+  max_queued = std::max(queued, 0);
+}
+
+std::size_t getNumSpinnerThreads(const ros::NodeHandle& nh)
+{
+  std::size_t max_concurrent, max_queued;
+  getPlanningRequestLimits(nh, max_concurrent, max_queued);
+  if (max_concurrent == 0)
+    return 1;
+  // one thread per running or waiting request, plus one that keeps serving all other callbacks
+  return max_concurrent + max_queued + 1;
+}
+
 class MoveGroupExe
 {
 public:
@@ -77,6 +103,15 @@ public:
 
     context_.reset(new MoveGroupContext(psm, allow_trajectory_execution, debug));
 
+    std::size_t max_concurrent, max_queued;
+    getPlanningRequestLimits(node_handle_, max_concurrent, max_queued);
+    if (max_concurrent > 0)
+    {
+      context_->planning_request_scheduler_ = std::make_shared<PlanningRequestScheduler>(max_concurrent, max_queued);
+      ROS_INFO("MoveGroup serves up to %zu planning requests concurrently, with up to %zu more waiting", max_concurrent,
+               max_queued);
+    }
+
     // start the capabilities
     configureCapabilities();
   }
@@ -183,7 +218,7 @@ int main(int argc, char** argv)
 {
   ros::init(argc, argv, move_group::NODE_NAME);
 
-  ros::AsyncSpinner spinner(1);
+  ros::AsyncSpinner spinner(move_group::getNumSpinnerThreads(ros::NodeHandle("~")));
   spinner.start();
   ros::NodeHandle nh;
 
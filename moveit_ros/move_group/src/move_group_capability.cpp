@@ -35,8 +35,10 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/move_group/planning_request_scheduler.h>
 #include <moveit/robot_state/conversions.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+#include <algorithm>
 
 void move_group::MoveGroupCapability::setContext(const MoveGroupContextPtr& context)
 {
@@ -198,3 +200,49 @@ bool move_group::MoveGroupCapability::performTransform(geometry_msgs::PoseStampe
   }
   return true;
 }
+
+bool move_group::MoveGroupCapability::schedulePlanningRequest(int priority, double allowed_planning_time,
+                                                              const std::function<void(double)>& plan_fn,
+                                                              moveit_msgs::MoveItErrorCodes& error_code) const
+{
+  if (!context_ || !context_->planning_request_scheduler_)
+  {
+    plan_fn(0.0);
+    return true;
+  }
+
+  // a request that cannot start planning within its planning time would only return late
+  PlanningRequestScheduler::Clock::time_point deadline = PlanningRequestScheduler::Clock::time_point::max();
+  if (allowed_planning_time > 0.0)
+    deadline = PlanningRequestScheduler::Clock::now() +
+               std::chrono::duration_cast<PlanningRequestScheduler::Clock::duration>(
+                   std::chrono::duration<double>(allowed_planning_time));
+
+  const PlanningRequestScheduler::Admission admission =
+      context_->planning_request_scheduler_->run(priority, deadline, plan_fn);
+
+  // report the load of move_group periodically
+  const PlanningRequestScheduler::Statistics stats = context_->planning_request_scheduler_->getStatistics();
+  const double completed = std::max<std::size_t>(stats.completed, 1);
+  ROS_INFO_THROTTLE_NAMED(60.0, getName(),
+                          "Planning requests: %zu completed, %zu rejected, %zu expired; "
+                          "queue time avg %.3fs max %.3fs; planning time avg %.3fs max %.3fs",
+                          stats.completed, stats.rejected, stats.expired, stats.total_queue_time / completed,
+                          stats.max_queue_time, stats.total_planning_time / completed, stats.max_planning_time);
+
+  switch (admission)
+  {
+    case PlanningRequestScheduler::Admission::ADMITTED:
+      return true;
+    case PlanningRequestScheduler::Admission::QUEUE_FULL:
+      ROS_WARN_NAMED(getName(), "Too many pending planning requests. Rejecting request.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+      return false;
+    case PlanningRequestScheduler::Admission::DEADLINE_EXCEEDED:
+      ROS_WARN_NAMED(getName(), "Planning request was not started within its allowed planning time of %.3fs",
+                     allowed_planning_time);
+      error_code.val = moveit_msgs::MoveItErrorCodes::TIMED_OUT;
+      return false;
+  }
+  return false;
+}
@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/move_group/move_group_context.h>
+#include <moveit/move_group/planning_request_scheduler.h>
 
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/plan_execution/plan_execution.h>
@@ -69,6 +70,7 @@ move_group::MoveGroupContext::MoveGroupContext(
 
 move_group::MoveGroupContext::~MoveGroupContext()
 {
+  planning_request_scheduler_.reset();
   plan_with_sensing_.reset();
   plan_execution_.reset();
   trajectory_execution_manager_.reset();
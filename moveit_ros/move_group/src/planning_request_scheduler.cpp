@@ -0,0 +1,122 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/move_group/planning_request_scheduler.h>
+#include <ros/console.h>
+#include <algorithm>
+
+namespace move_group
+{
+static const std::string LOGNAME = "planning_request_scheduler";
+
+const int PlanningRequestScheduler::MOVE_ACTION_PRIORITY;
+const int PlanningRequestScheduler::PLAN_SERVICE_PRIORITY;
+
+PlanningRequestScheduler::PlanningRequestScheduler(std::size_t max_concurrent_requests,
+                                                   std::size_t max_queued_requests)
+  : max_concurrent_requests_(std::max<std::size_t>(max_concurrent_requests, 1))
+  , max_queued_requests_(max_queued_requests)
+  , running_(0)
+  , next_arrival_(0)
+{
+}
+
+PlanningRequestScheduler::Admission PlanningRequestScheduler::run(int priority, const Clock::time_point& deadline,
+                                                                  const std::function<void(double)>& fn)
+{
+  const Clock::time_point arrival = Clock::now();
+  std::unique_lock<std::mutex> ulock(lock_);
+  if (running_ >= max_concurrent_requests_ && waiting_.size() >= max_queued_requests_)
+  {
+    ++statistics_.rejected;
+    return Admission::QUEUE_FULL;
+  }
+
+  const QueueKey key(-priority, next_arrival_++);
+  waiting_.insert(key);
+  const auto is_next = [this, &key] { return running_ < max_concurrent_requests_ && *waiting_.begin() == key; };
+  bool admitted = true;
+  if (deadline == Clock::time_point::max())
+    slot_released_.wait(ulock, is_next);
+  else
+    admitted = slot_released_.wait_until(ulock, deadline, is_next);
+  waiting_.erase(key);
+  if (!admitted)
+  {
+    ++statistics_.expired;
+    // this request may have been the one blocking the head of the queue
+    slot_released_.notify_all();
+    return Admission::DEADLINE_EXCEEDED;
+  }
+  ++running_;
+
+  const Clock::time_point start = Clock::now();
+  const double queue_time = std::chrono::duration<double>(start - arrival).count();
+  statistics_.total_queue_time += queue_time;
+  statistics_.max_queue_time = std::max(statistics_.max_queue_time, queue_time);
+  // the next waiting request may fit in a remaining slot
+  slot_released_.notify_all();
+  ulock.unlock();
+
+  try
+  {
+    fn(queue_time);
+  }
+  catch (...)
+  {
+    ulock.lock();
+    --running_;
+    slot_released_.notify_all();
+    throw;
+  }
+
+  const double planning_time = std::chrono::duration<double>(Clock::now() - start).count();
+  ulock.lock();
+  --running_;
+  ++statistics_.completed;
+  statistics_.total_planning_time += planning_time;
+  statistics_.max_planning_time = std::max(statistics_.max_planning_time, planning_time);
+  slot_released_.notify_all();
+
+  ROS_DEBUG_NAMED(LOGNAME, "Request waited %.3fs and planned for %.3fs (%zu running, %zu waiting)", queue_time,
+                  planning_time, running_, waiting_.size());
+  return Admission::ADMITTED;
+}
+
+PlanningRequestScheduler::Statistics PlanningRequestScheduler::getStatistics() const
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  return statistics_;
+}
+}  // namespace move_group
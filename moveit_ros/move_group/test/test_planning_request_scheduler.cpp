@@ -0,0 +1,184 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/move_group/planning_request_scheduler.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using move_group::PlanningRequestScheduler;
+
+namespace
+{
+const PlanningRequestScheduler::Clock::time_point NO_DEADLINE = PlanningRequestScheduler::Clock::time_point::max();
+
+void waitUntil(const std::function<bool()>& condition)
+{
+  while (!condition())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+}  // namespace
+
+TEST(PlanningRequestScheduler, BoundsConcurrentRequests)
+{
+  PlanningRequestScheduler scheduler(2, 10);
+  std::mutex running_lock;
+  int running = 0;
+  int max_running = 0;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 6; ++i)
+    threads.emplace_back([&] {
+      EXPECT_EQ(scheduler.run(0, NO_DEADLINE,
+                              [&](double /* queue_time */) {
+                                {
+                                  std::lock_guard<std::mutex> slock(running_lock);
+                                  max_running = std::max(max_running, ++running);
+                                }
+                                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                std::lock_guard<std::mutex> slock(running_lock);
+                                --running;
+                              }),
+                PlanningRequestScheduler::Admission::ADMITTED);
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_LE(max_running, 2);
+  EXPECT_EQ(scheduler.getStatistics().completed, 6u);
+}
+
+TEST(PlanningRequestScheduler, RejectsWhenQueueIsFull)
+{
+  PlanningRequestScheduler scheduler(1, 1);
+  std::atomic<bool> release{ false };
+  std::atomic<bool> started{ false };
+
+  std::thread blocking([&] {
+    scheduler.run(0, NO_DEADLINE, [&](double /* queue_time */) {
+      started = true;
+      waitUntil([&] { return release.load(); });
+    });
+  });
+  waitUntil([&] { return started.load(); });
+
+  std::thread queued([&] { scheduler.run(0, NO_DEADLINE, [](double /* queue_time */) {}); });
+  // give the second request time to enter the queue
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  bool called = false;
+  EXPECT_EQ(scheduler.run(0, NO_DEADLINE, [&](double /* queue_time */) { called = true; }),
+            PlanningRequestScheduler::Admission::QUEUE_FULL);
+  EXPECT_FALSE(called);
+
+  release = true;
+  blocking.join();
+  queued.join();
+  EXPECT_EQ(scheduler.getStatistics().rejected, 1u);
+  EXPECT_EQ(scheduler.getStatistics().completed, 2u);
+}
+
+TEST(PlanningRequestScheduler, DropsExpiredRequests)
+{
+  PlanningRequestScheduler scheduler(1, 4);
+  std::atomic<bool> release{ false };
+  std::atomic<bool> started{ false };
+
+  std::thread blocking([&] {
+    scheduler.run(0, NO_DEADLINE, [&](double /* queue_time */) {
+      started = true;
+      waitUntil([&] { return release.load(); });
+    });
+  });
+  waitUntil([&] { return started.load(); });
+
+  bool called = false;
+  const auto deadline = PlanningRequestScheduler::Clock::now() + std::chrono::milliseconds(20);
+  EXPECT_EQ(scheduler.run(0, deadline, [&](double /* queue_time */) { called = true; }),
+            PlanningRequestScheduler::Admission::DEADLINE_EXCEEDED);
+  EXPECT_FALSE(called);
+
+  release = true;
+  blocking.join();
+  EXPECT_EQ(scheduler.getStatistics().expired, 1u);
+}
+
+TEST(PlanningRequestScheduler, AdmitsHigherPriorityFirst)
+{
+  PlanningRequestScheduler scheduler(1, 4);
+  std::atomic<bool> release{ false };
+  std::atomic<bool> started{ false };
+  std::mutex order_lock;
+  std::vector<int> order;
+
+  std::thread blocking([&] {
+    scheduler.run(0, NO_DEADLINE, [&](double /* queue_time */) {
+      started = true;
+      waitUntil([&] { return release.load(); });
+    });
+  });
+  waitUntil([&] { return started.load(); });
+
+  std::vector<std::thread> waiting;
+  for (int priority : { PlanningRequestScheduler::PLAN_SERVICE_PRIORITY,
+                        PlanningRequestScheduler::MOVE_ACTION_PRIORITY })
+  {
+    waiting.emplace_back([&, priority] {
+      scheduler.run(priority, NO_DEADLINE, [&, priority](double /* queue_time */) {
+        std::lock_guard<std::mutex> slock(order_lock);
+        order.push_back(priority);
+      });
+    });
+    // make the arrival order deterministic
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  release = true;
+  blocking.join();
+  for (std::thread& thread : waiting)
+    thread.join();
+
+  ASSERT_EQ(order.size(), 2u);
+  EXPECT_EQ(order[0], PlanningRequestScheduler::MOVE_ACTION_PRIORITY);
+  EXPECT_EQ(order[1], PlanningRequestScheduler::PLAN_SERVICE_PRIORITY);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,6 +40,7 @@
 #include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/function.hpp>
+#include <atomic>
 #include <memory>
 
 namespace occupancy_map_monitor
@@ -49,11 +50,11 @@ typedef octomap::OcTreeNode OccMapNode;
 class OccMapTree : public octomap::OcTree
 {
 public:
-  OccMapTree(double resolution) : octomap::OcTree(resolution)
+  OccMapTree(double resolution) : octomap::OcTree(resolution), version_(0)
   {
   }
 
-  OccMapTree(const std::string& filename) : octomap::OcTree(filename)
+  OccMapTree(const std::string& filename) : octomap::OcTree(filename), version_(0)
   {
   }
 
@@ -96,12 +97,22 @@ public:
     return WriteLock(tree_mutex_);
   }
 
+  /** @brief Bump the version of the tree and notify the update callback.
+   *  Must be called by updaters after each modification of the tree. */
   void triggerUpdateCallback()
   {
+    ++version_;
     if (update_callback_)
       update_callback_();
   }
 
+  /** @brief Get a counter that is incremented on every update of the tree.
+   *  Consumers sharing this tree can compare versions to detect changes without inspecting the tree. */
+  std::size_t getVersion() const
+  {
+    return version_;
+  }
+
   /** @brief Set the callback to trigger when updates are received */
   void setUpdateCallback(const boost::function<void()>& update_callback)
   {
@@ -111,6 +122,7 @@ public:
 private:
   boost::shared_mutex tree_mutex_;
   boost::function<void()> update_callback_;
+  std::atomic<std::size_t> version_;
 };
 
 using OccMapTreePtr = std::shared_ptr<OccMapTree>;
@@ -39,6 +39,7 @@
 #include <sensor_msgs/PointCloud2.h>
 #include <geometric_shapes/bodies.h>
 #include <boost/function.hpp>
+#include <Eigen/Geometry>
 #include <vector>
 #include <set>
 #include <map>
@@ -114,12 +115,41 @@ protected:
     }
   };
 
+  /** \brief Snapshot of a body at the pose used for the current cloud. Spheres, boxes and cylinders are tested
+      analytically against the cached parameters; any other body type falls back to Body::containsPoint() */
+  struct PosedBody
+  {
+    const bodies::Body* body;
+    shapes::ShapeType type;
+
+    /** \brief Bounding sphere of the posed body, used to reject points before the exact test */
+    Eigen::Vector3d bound_center;
+    double bound_radius_squared;
+
+    /** \brief Pose of the body: the point p is transformed into the body frame as rotation * (p - translation) */
+    Eigen::Matrix3d rotation;
+    Eigen::Vector3d translation;
+
+    /** \brief Sphere: (radius^2, -, -); box: half extents; cylinder: (radius^2, -, half length).
+        Scale and padding are already applied */
+    Eigen::Vector3d extents;
+  };
+
+  /** \brief Fill posed_bodies_ and bspheres_ from bodies_ using the transform callback. Returns false if no body could
+      be posed */
+  bool updatePosedBodies();
+
+  /** \brief Exact containment test of a point against the posed bodies */
+  bool containsPoint(const Eigen::Vector3d& pt) const;
+
   TransformCallback transform_callback_;
 
-  /** \brief Protects, bodies_ and bspheres_. All public methods acquire this mutex for their whole duration. */
+  /** \brief Protects, bodies_, bspheres_ and posed_bodies_. All public methods acquire this mutex for their whole
+   * duration. */
   mutable boost::mutex shapes_lock_;
   std::set<SeeShape, SortBodies> bodies_;
   std::vector<bodies::BoundingSphere> bspheres_;
+  std::vector<PosedBody> posed_bodies_;
 
 private:
   /** \brief Free memory. */
@@ -38,6 +38,7 @@
 #include <geometric_shapes/body_operations.h>
 #include <ros/console.h>
 #include <sensor_msgs/point_cloud2_iterator.h>
+#include <cmath>
 
 static const std::string LOGNAME = "shape_mask";
 
@@ -114,6 +115,102 @@ void point_containment_filter::ShapeMask::removeShape(ShapeHandle handle)
     ROS_ERROR_NAMED(LOGNAME, "Unable to remove shape handle %u", handle);
 }
 
+bool point_containment_filter::ShapeMask::updatePosedBodies()
+{
+  Eigen::Isometry3d tmp;
+  posed_bodies_.clear();
+  posed_bodies_.reserve(bodies_.size());
+  bspheres_.resize(bodies_.size());
+  std::size_t j = 0;
+  for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end(); ++it)
+  {
+    if (!transform_callback_(it->handle, tmp))
+    {
+      if (!it->body)
+        ROS_ERROR_STREAM_NAMED(LOGNAME, "Missing transform for shape with handle " << it->handle << " without a body");
+      else
+        ROS_ERROR_STREAM_NAMED(LOGNAME, "Missing transform for shape " << it->body->getType() << " with handle "
+                                                                       << it->handle);
+      continue;
+    }
+
+    it->body->setPose(tmp);
+    bodies::BoundingSphere& sphere = bspheres_[j++];
+    it->body->computeBoundingSphere(sphere);
+
+    PosedBody pb;
+    pb.body = it->body;
+    pb.type = it->body->getType();
+    pb.bound_center = sphere.center;
+    pb.bound_radius_squared = sphere.radius * sphere.radius;
+    pb.rotation = tmp.linear().transpose();
+    pb.translation = tmp.translation();
+
+    // the analytic parameters mirror the ones geometric_shapes computes in Body::updateInternalData()
+    const std::vector<double> dims = it->body->getDimensions();
+    const double scale = it->body->getScale();
+    const double padding = it->body->getPadding();
+    switch (pb.type)
+    {
+      case shapes::SPHERE:
+      {
+        const double radius = dims[0] * scale + padding;
+        pb.extents = Eigen::Vector3d(radius * radius, 0.0, 0.0);
+        break;
+      }
+      case shapes::BOX:
+        pb.extents = Eigen::Vector3d(dims[0] * scale / 2.0 + padding, dims[1] * scale / 2.0 + padding,
+                                     dims[2] * scale / 2.0 + padding);
+        break;
+      case shapes::CYLINDER:
+      {
+        const double radius = dims[0] * scale + padding;
+        pb.extents = Eigen::Vector3d(radius * radius, 0.0, dims[1] * scale / 2.0 + padding);
+        break;
+      }
+      default:
+        pb.extents.setZero();
+        break;
+    }
+    posed_bodies_.push_back(pb);
+  }
+  bspheres_.resize(j);
+  return !posed_bodies_.empty();
+}
+
+bool point_containment_filter::ShapeMask::containsPoint(const Eigen::Vector3d& pt) const
+{
+  // bodies are sorted by decreasing volume, so the most likely hits are tested first
+  for (const PosedBody& pb : posed_bodies_)
+  {
+    if ((pb.bound_center - pt).squaredNorm() > pb.bound_radius_squared)
+      continue;
+    switch (pb.type)
+    {
+      case shapes::SPHERE:
+        if ((pb.translation - pt).squaredNorm() <= pb.extents[0])
+          return true;
+        break;
+      case shapes::BOX:
+        if (((pb.rotation * (pt - pb.translation)).cwiseAbs() - pb.extents).maxCoeff() <= 0.0)
+          return true;
+        break;
+      case shapes::CYLINDER:
+      {
+        const Eigen::Vector3d local = pb.rotation * (pt - pb.translation);
+        if (std::fabs(local.z()) <= pb.extents.z() && local.head<2>().squaredNorm() <= pb.extents.x())
+          return true;
+        break;
+      }
+      default:
+        if (pb.body->containsPoint(pt))
+          return true;
+        break;
+    }
+  }
+  return false;
+}
+
 void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::PointCloud2& data_in,
                                                           const Eigen::Vector3d& /*sensor_origin*/,
                                                           const double min_sensor_dist, const double max_sensor_dist,
@@ -123,34 +220,16 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
   const unsigned int np = data_in.data.size() / data_in.point_step;
   mask.resize(np);
 
-  if (bodies_.empty())
+  if (bodies_.empty() || !updatePosedBodies())
     std::fill(mask.begin(), mask.end(), (int)OUTSIDE);
   else
   {
-    Eigen::Isometry3d tmp;
-    bspheres_.resize(bodies_.size());
-    std::size_t j = 0;
-    for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end(); ++it)
-    {
-      if (!transform_callback_(it->handle, tmp))
-      {
-        if (!it->body)
-          ROS_ERROR_STREAM_NAMED(LOGNAME, "Missing transform for shape with handle " << it->handle << " without a body");
-        else
-          ROS_ERROR_STREAM_NAMED(LOGNAME, "Missing transform for shape " << it->body->getType() << " with handle "
-                                                                         << it->handle);
-      }
-      else
-      {
-        it->body->setPose(tmp);
-        it->body->computeBoundingSphere(bspheres_[j++]);
-      }
-    }
-
     // compute a sphere that bounds the entire robot
     bodies::BoundingSphere bound;
     bodies::mergeBoundingSpheres(bspheres_, bound);
     const double radius_squared = bound.radius * bound.radius;
+    const double min_dist_squared = min_sensor_dist * min_sensor_dist;
+    const double max_dist_squared = max_sensor_dist * max_sensor_dist;
 
     // we now decide which points we keep
     sensor_msgs::PointCloud2ConstIterator<float> iter_x(data_in, "x");
@@ -162,15 +241,13 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
     //#pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)np; ++i)
     {
-      Eigen::Vector3d pt = Eigen::Vector3d(*(iter_x + i), *(iter_y + i), *(iter_z + i));
-      double d = pt.norm();
+      const Eigen::Vector3d pt(*(iter_x + i), *(iter_y + i), *(iter_z + i));
+      const double d = pt.squaredNorm();
       int out = OUTSIDE;
-      if (d < min_sensor_dist || d > max_sensor_dist)
+      if (d < min_dist_squared || d > max_dist_squared)
         out = CLIP;
-      else if ((bound.center - pt).squaredNorm() < radius_squared)
-        for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end() && out == OUTSIDE; ++it)
-          if (it->body->containsPoint(pt))
-            out = INSIDE;
+      else if ((bound.center - pt).squaredNorm() < radius_squared && containsPoint(pt))
+        out = INSIDE;
       mask[i] = out;
     }
   }
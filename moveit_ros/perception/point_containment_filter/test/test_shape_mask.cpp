@@ -0,0 +1,119 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/point_containment_filter/shape_mask.h>
+#include <geometric_shapes/mesh_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
+#include <random>
+
+namespace
+{
+// Compare the analytic containment test of maskContainment() with bodies::Body::containsPoint(), which
+// getMaskContainment() uses, on random points around a single posed, scaled and padded shape
+void checkContainment(const shapes::ShapeConstPtr& shape, double scale, double padding)
+{
+  const Eigen::Isometry3d pose = Eigen::Translation3d(0.3, -0.2, 0.5) *
+                                 Eigen::AngleAxisd(0.7, Eigen::Vector3d(1.0, 2.0, 3.0).normalized());
+  point_containment_filter::ShapeMask mask([&pose](point_containment_filter::ShapeHandle /*handle*/,
+                                                   Eigen::Isometry3d& transform) {
+    transform = pose;
+    return true;
+  });
+  ASSERT_NE(mask.addShape(shape, scale, padding), 0u);
+
+  const std::size_t num_points = 20000;
+  sensor_msgs::PointCloud2 cloud;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  modifier.resize(num_points);
+
+  // sample a cube that contains the shape and some space around it
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> offset(-0.6f, 0.6f);
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x"), iter_y(cloud, "y"), iter_z(cloud, "z");
+  for (std::size_t i = 0; i < num_points; ++i, ++iter_x, ++iter_y, ++iter_z)
+  {
+    *iter_x = static_cast<float>(pose.translation().x()) + offset(rng);
+    *iter_y = static_cast<float>(pose.translation().y()) + offset(rng);
+    *iter_z = static_cast<float>(pose.translation().z()) + offset(rng);
+  }
+
+  std::vector<int> result;
+  mask.maskContainment(cloud, Eigen::Vector3d::Zero(), 0.0, 100.0, result);
+  ASSERT_EQ(result.size(), num_points);
+
+  std::size_t inside = 0;
+  sensor_msgs::PointCloud2ConstIterator<float> it_x(cloud, "x"), it_y(cloud, "y"), it_z(cloud, "z");
+  for (std::size_t i = 0; i < num_points; ++i, ++it_x, ++it_y, ++it_z)
+  {
+    const Eigen::Vector3d pt(*it_x, *it_y, *it_z);
+    EXPECT_EQ(result[i], mask.getMaskContainment(pt)) << "point " << pt.transpose();
+    if (result[i] == point_containment_filter::ShapeMask::INSIDE)
+      ++inside;
+  }
+  // both outcomes need to be covered for the comparison to be meaningful
+  EXPECT_GT(inside, num_points / 100);
+  EXPECT_LT(inside, num_points - num_points / 100);
+}
+}  // namespace
+
+TEST(ShapeMask, ContainsSphere)
+{
+  checkContainment(std::make_shared<const shapes::Sphere>(0.2), 1.2, 0.05);
+}
+
+TEST(ShapeMask, ContainsBox)
+{
+  checkContainment(std::make_shared<const shapes::Box>(0.4, 0.2, 0.3), 1.2, 0.05);
+}
+
+TEST(ShapeMask, ContainsCylinder)
+{
+  checkContainment(std::make_shared<const shapes::Cylinder>(0.15, 0.5), 1.2, 0.05);
+}
+
+TEST(ShapeMask, ContainsMesh)
+{
+  shapes::ShapeConstPtr mesh(shapes::createMeshFromShape(shapes::Box(0.4, 0.2, 0.3)));
+  ASSERT_TRUE(mesh);
+  checkContainment(mesh, 1.2, 0.05);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
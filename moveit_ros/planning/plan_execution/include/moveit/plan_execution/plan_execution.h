@@ -43,12 +43,20 @@
 #include <moveit/planning_scene_monitor/trajectory_monitor.h>
 #include <moveit/sensor_manager/sensor_manager.h>
 #include <pluginlib/class_loader.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
 
 /** \brief This namespace includes functionality specific to the execution and monitoring of motion plans */
 namespace plan_execution
 {
 MOVEIT_CLASS_FORWARD(PlanExecution);  // Defines PlanExecutionPtr, ConstPtr, WeakPtr... etc
 
+/** \brief Compute the axis-aligned bounds of the robot (including attached bodies) at each waypoint of \e trajectory.
+    The waypoints do not need to have up-to-date link transforms. */
+void computeWaypointBounds(const robot_trajectory::RobotTrajectory& trajectory,
+                           std::vector<Eigen::AlignedBox3d>& bounds);
+
 class PlanExecution
 {
 public:
@@ -140,9 +148,31 @@ public:
   std::string getErrorCodeString(const moveit_msgs::MoveItErrorCodes& error_code);
 
 private:
+  /** \brief Information kept about a monitored trajectory component, so that scene updates only cause the waypoints
+      close to the changed world geometry to be checked again */
+  struct TrajectoryValidityCache
+  {
+    /// Whether the remaining path was checked completely at least once
+    bool initialized_ = false;
+
+    /// Axis-aligned bounds of the robot at each waypoint
+    std::vector<Eigen::AlignedBox3d> waypoint_bounds_;
+
+    /// The world objects (and the versions of their octrees) that the remaining path was last found valid against
+    std::map<std::string, std::pair<collision_detection::World::ObjectConstPtr, std::size_t>> checked_objects_;
+
+    /// Hash of the ACM and of the other collision settings that the remaining path was last checked with
+    std::uint64_t collision_settings_hash_ = 0;
+  };
+
   void planAndExecuteHelper(ExecutableMotionPlan& plan, const Options& opt);
   bool isRemainingPathValid(const ExecutableMotionPlan& plan, const std::pair<int, int>& path_segment);
 
+  /** \brief Record the world objects of \e world in \e cache and collect the bounds of those that changed since the
+      last call into \e changed_bounds */
+  void updateCheckedObjects(const collision_detection::World& world, TrajectoryValidityCache& cache,
+                            std::vector<Eigen::AlignedBox3d>& changed_bounds) const;
+
   void planningSceneUpdatedCallback(const planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type);
   void doneWithTrajectoryExecution(const moveit_controller_manager::ExecutionStatus& status);
   void successfulTrajectorySegmentExecution(const ExecutableMotionPlan* plan, std::size_t index);
@@ -160,6 +190,10 @@ private:
   bool execution_complete_;
   bool path_became_invalid_;
 
+  /// One entry per component of the plan being executed, guarded by validity_cache_lock_
+  std::vector<TrajectoryValidityCache> validity_caches_;
+  std::mutex validity_cache_lock_;
+
   class DynamicReconfigureImpl;
   DynamicReconfigureImpl* reconfigure_impl_;
 };
@@ -38,9 +38,15 @@
 #include <moveit/robot_state/conversions.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/collision_detection/collision_tools.h>
+#include <moveit/collision_detection/shape_hash.h>
 #include <moveit/utils/message_checks.h>
+#include <moveit/robot_model/aabb.h>
+#include <moveit/occupancy_map_monitor/occupancy_map.h>
+#include <geometric_shapes/shape_operations.h>
 #include <boost/algorithm/string/join.hpp>
 
+#include <algorithm>
+
 #include <dynamic_reconfigure/server.h>
 #include <moveit_ros_planning/PlanExecutionDynamicReconfigureConfig.h>
 
@@ -48,6 +54,91 @@ namespace plan_execution
 {
 using namespace moveit_ros_planning;
 
+namespace
+{
+// Margin added to the bounds of changed world geometry, to stay conservative w.r.t. the collision checker
+constexpr double CHANGED_BOUNDS_MARGIN = 0.01;
+
+Eigen::AlignedBox3d computeShapeBounds(const shapes::Shape* shape, const Eigen::Isometry3d& pose)
+{
+  moveit::core::AABB aabb;
+  if (shape->type == shapes::MESH)
+  {
+    // shapes::computeShapeExtents() does not provide the offset of the mesh origin
+    const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape);
+    for (unsigned int i = 0; i < mesh->vertex_count; ++i)
+      aabb.extend(pose * Eigen::Map<const Eigen::Vector3d>(&mesh->vertices[3 * i]));
+  }
+  else if (shape->type == shapes::OCTREE)
+  {
+    const std::shared_ptr<const octomap::OcTree>& octree = static_cast<const shapes::OcTree*>(shape)->octree;
+    if (octree && octree->size() > 0)
+    {
+      Eigen::Vector3d min, max;
+      octree->getMetricMin(min.x(), min.y(), min.z());
+      octree->getMetricMax(max.x(), max.y(), max.z());
+      aabb.extendWithTransformedBox(pose * Eigen::Translation3d(0.5 * (min + max)), max - min);
+    }
+  }
+  else
+    aabb.extendWithTransformedBox(pose, shapes::computeShapeExtents(shape));
+  return aabb;
+}
+
+// Octrees maintained by the occupancy map monitor are updated in place, so their version identifies their content
+std::size_t getOctreeVersion(const collision_detection::World::Object& object)
+{
+  std::size_t version = 0;
+  for (const shapes::ShapeConstPtr& shape : object.shapes_)
+    if (shape->type == shapes::OCTREE)
+      if (const auto* tree = dynamic_cast<const occupancy_map_monitor::OccMapTree*>(
+              static_cast<const shapes::OcTree*>(shape.get())->octree.get()))
+        version += tree->getVersion();
+  return version;
+}
+
+// Everything besides the world geometry that the unpadded collision checks of a trajectory depend on
+std::uint64_t computeCollisionSettingsHash(const planning_scene::PlanningScene& scene,
+                                           const collision_detection::AllowedCollisionMatrix* acm)
+{
+  using collision_detection::combineHash;
+  using collision_detection::hashDouble;
+  using collision_detection::hashString;
+
+  std::uint64_t h = hashString(scene.getActiveCollisionDetectorName());
+  combineHash(h, acm ? acm->getHash() : scene.getAllowedCollisionMatrix().getHash());
+  const collision_detection::CollisionEnvConstPtr& env = scene.getCollisionEnvUnpadded();
+  for (const std::pair<const std::string, double>& padding : env->getLinkPadding())
+  {
+    combineHash(h, hashString(padding.first));
+    combineHash(h, hashDouble(padding.second));
+  }
+  for (const std::pair<const std::string, double>& scale : env->getLinkScale())
+  {
+    combineHash(h, hashString(scale.first));
+    combineHash(h, hashDouble(scale.second));
+  }
+  return h;
+}
+}  // namespace
+
+void computeWaypointBounds(const robot_trajectory::RobotTrajectory& trajectory,
+                           std::vector<Eigen::AlignedBox3d>& bounds)
+{
+  bounds.resize(trajectory.getWayPointCount());
+  moveit::core::RobotState state(trajectory.getRobotModel());
+  std::vector<double> aabb;
+  for (std::size_t i = 0; i < bounds.size(); ++i)
+  {
+    // waypoints may have been stored without updating their transforms
+    state = trajectory.getWayPoint(i);
+    state.update();
+    state.computeAABB(aabb);
+    bounds[i] =
+        Eigen::AlignedBox3d(Eigen::Vector3d(aabb[0], aabb[2], aabb[4]), Eigen::Vector3d(aabb[1], aabb[3], aabb[5]));
+  }
+}
+
 class PlanExecution::DynamicReconfigureImpl
 {
 public:
@@ -278,8 +369,32 @@ bool plan_execution::PlanExecution::isRemainingPathValid(const ExecutableMotionP
     std::size_t wpc = t.getWayPointCount();
     collision_detection::CollisionRequest req;
     req.group_name = t.getGroupName();
+
+    std::lock_guard<std::mutex> lock(validity_cache_lock_);
+    if (validity_caches_.size() <= static_cast<std::size_t>(path_segment.first))
+      validity_caches_.resize(path_segment.first + 1);
+    TrajectoryValidityCache& cache = validity_caches_[path_segment.first];
+
+    // Once the remaining path was found valid, only the waypoints whose bounds intersect changed world geometry need to
+    // be checked again. A change of the ACM or of other collision settings can affect any waypoint, and arbitrary
+    // feasibility predicates might depend on anything in the scene.
+    std::uint64_t settings_hash = computeCollisionSettingsHash(*plan.planning_scene_, acm);
+    bool check_all = !cache.initialized_ || cache.collision_settings_hash_ != settings_hash ||
+                     plan.planning_scene_->getStateFeasibilityPredicate();
+    if (!cache.initialized_)
+      computeWaypointBounds(t, cache.waypoint_bounds_);
+    cache.collision_settings_hash_ = settings_hash;
+    std::vector<Eigen::AlignedBox3d> changed_bounds;
+    updateCheckedObjects(*plan.planning_scene_->getWorld(), cache, changed_bounds);
+
     for (std::size_t i = std::max(path_segment.second - 1, 0); i < wpc; ++i)
     {
+      if (!check_all && std::none_of(changed_bounds.begin(), changed_bounds.end(),
+                                     [&](const Eigen::AlignedBox3d& bounds) {
+                                       return bounds.intersects(cache.waypoint_bounds_[i]);
+                                     }))
+        continue;
+
       collision_detection::CollisionResult res;
       if (acm)
         plan.planning_scene_->checkCollisionUnpadded(req, res, t.getWayPoint(i), *acm);
@@ -296,13 +411,46 @@ bool plan_execution::PlanExecution::isRemainingPathValid(const ExecutableMotionP
           plan.planning_scene_->checkCollisionUnpadded(req, res, t.getWayPoint(i), *acm);
         else
           plan.planning_scene_->checkCollisionUnpadded(req, res, t.getWayPoint(i));
+        // make sure the next check considers all changes again
+        cache.initialized_ = false;
         return false;
       }
     }
+    cache.initialized_ = true;
   }
   return true;
 }
 
+void plan_execution::PlanExecution::updateCheckedObjects(const collision_detection::World& world,
+                                                         TrajectoryValidityCache& cache,
+                                                         std::vector<Eigen::AlignedBox3d>& changed_bounds) const
+{
+  // World objects are copied on write while they are shared, so holding on to them makes any change to their geometry
+  // show up as a new object pointer. Removed objects cannot invalidate the path.
+  std::map<std::string, std::pair<collision_detection::World::ObjectConstPtr, std::size_t>> objects;
+  for (const auto& object : world)
+  {
+    std::pair<collision_detection::World::ObjectConstPtr, std::size_t>& entry = objects[object.first];
+    entry.first = object.second;
+    entry.second = getOctreeVersion(*object.second);
+
+    auto it = cache.checked_objects_.find(object.first);
+    if (it != cache.checked_objects_.end() && it->second == entry)
+      continue;
+    for (std::size_t i = 0; i < object.second->shapes_.size(); ++i)
+    {
+      Eigen::AlignedBox3d bounds = computeShapeBounds(object.second->shapes_[i].get(), object.second->shape_poses_[i]);
+      if (!bounds.isEmpty())
+      {
+        bounds.min().array() -= CHANGED_BOUNDS_MARGIN;
+        bounds.max().array() += CHANGED_BOUNDS_MARGIN;
+        changed_bounds.push_back(bounds);
+      }
+    }
+  }
+  cache.checked_objects_.swap(objects);
+}
+
 moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(ExecutableMotionPlan& plan)
 {
   if (!plan.planning_scene_monitor_)
@@ -330,6 +478,12 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
 
   execution_complete_ = false;
 
+  {
+    std::lock_guard<std::mutex> lock(validity_cache_lock_);
+    validity_caches_.clear();
+    validity_caches_.resize(plan.plan_components_.size());
+  }
+
   // push the trajectories we have slated for execution to the trajectory execution manager
   int prev = -1;
   for (std::size_t i = 0; i < plan.plan_components_.size(); ++i)
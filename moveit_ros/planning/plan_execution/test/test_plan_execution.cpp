@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/plan_execution/plan_execution.h>
+#include <moveit/utils/robot_model_test_utils.h>
+
+TEST(PlanExecution, WaypointBoundsOfDirtyStates)
+{
+  moveit::core::RobotModelBuilder builder("simple", "base_link");
+  geometry_msgs::Pose origin;
+  origin.orientation.w = 1.0;
+  builder.addCollisionBox("base_link", { 0.2, 0.2, 0.2 }, origin);
+  builder.addVirtualJoint("odom_combined", "base_link", "planar", "world_joint");
+  builder.addGroup({}, { "world_joint" }, "base");
+  ASSERT_TRUE(builder.isValid());
+  moveit::core::RobotModelPtr robot_model = builder.build();
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model, "base");
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.update();
+  for (double x : { 0.0, 1.0, 2.0 })
+  {
+    // leave the transforms of the waypoints dirty
+    state.setVariablePosition("world_joint/x", x);
+    ASSERT_TRUE(state.dirtyLinkTransforms());
+    trajectory.addSuffixWayPoint(state, 0.1);
+  }
+
+  std::vector<Eigen::AlignedBox3d> bounds;
+  plan_execution::computeWaypointBounds(trajectory, bounds);
+  ASSERT_EQ(bounds.size(), 3u);
+  for (std::size_t i = 0; i < bounds.size(); ++i)
+  {
+    EXPECT_NEAR(bounds[i].min().x(), i - 0.1, 1e-9);
+    EXPECT_NEAR(bounds[i].max().x(), i + 0.1, 1e-9);
+    EXPECT_NEAR(bounds[i].min().y(), -0.1, 1e-9);
+    EXPECT_NEAR(bounds[i].max().z(), 0.1, 1e-9);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,343 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <moveit/robot_state/conversions.h>
+#include <boost/functional/hash.hpp>
+#include <class_loader/class_loader.hpp>
+#include <ros/serialization.h>
+#include <ros/ros.h>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+
+namespace default_planner_request_adapters
+{
+namespace
+{
+template <typename Message>
+void hashMessage(std::size_t& seed, const Message& msg)
+{
+  const uint32_t length = ros::serialization::serializationLength(msg);
+  std::vector<uint8_t> buffer(length);
+  ros::serialization::OStream stream(buffer.data(), length);
+  ros::serialization::serialize(stream, msg);
+  boost::hash_combine(seed, boost::hash_range(buffer.begin(), buffer.end()));
+}
+
+// stamps do not change the meaning of constraints, but differ between otherwise identical requests
+void clearStamps(moveit_msgs::Constraints& constraints)
+{
+  for (moveit_msgs::PositionConstraint& constraint : constraints.position_constraints)
+    constraint.header.stamp = ros::Time();
+  for (moveit_msgs::OrientationConstraint& constraint : constraints.orientation_constraints)
+    constraint.header.stamp = ros::Time();
+  for (moveit_msgs::VisibilityConstraint& constraint : constraints.visibility_constraints)
+    constraint.target_pose.header.stamp = constraint.sensor_pose.header.stamp = ros::Time();
+}
+
+double getMaxDistance(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double distance = 0.0;
+  for (std::size_t i = 0; i < a.size(); ++i)
+    distance = std::max(distance, std::fabs(a[i] - b[i]));
+  return distance;
+}
+
+// Take the positions of \e joints from \e start_state, keeping all other positions, velocities and accelerations
+void setJointPositions(moveit::core::RobotState& waypoint, const moveit::core::RobotState& start_state,
+                       const std::vector<const moveit::core::JointModel*>& joints)
+{
+  for (const moveit::core::JointModel* joint : joints)
+    waypoint.setJointPositions(joint, start_state.getJointPositions(joint));
+  waypoint.update();
+}
+}  // namespace
+
+/** Returns previously computed trajectories for requests that match an earlier one.
+    Trajectories are cached per scene fingerprint (collision objects, attached bodies, ACM, padding) and per request
+    parameters other than the goal. A cached trajectory is reused if it starts close to the requested start state, ends
+    in a state satisfying the goal constraints, and is valid in the current scene, including its octomap. Since only the
+    trajectory computed by the adapters after this one is cached, this adapter should come first in the list. */
+class CachePlans : public planning_request_adapter::PlanningRequestAdapter
+{
+public:
+  static const std::string CACHE_SIZE_PARAM_NAME;
+  static const std::string START_TOLERANCE_PARAM_NAME;
+
+  CachePlans() : planning_request_adapter::PlanningRequestAdapter()
+  {
+  }
+
+  void initialize(const ros::NodeHandle& nh) override
+  {
+    int cache_size;
+    if (!nh.getParam(CACHE_SIZE_PARAM_NAME, cache_size))
+    {
+      cache_size = 1000;
+      ROS_INFO_STREAM("Param '" << CACHE_SIZE_PARAM_NAME << "' was not set. Using default value: " << cache_size);
+    }
+    else
+      ROS_INFO_STREAM("Param '" << CACHE_SIZE_PARAM_NAME << "' was set to " << cache_size);
+    cache_size_ = std::max(cache_size, 1);
+
+    if (!nh.getParam(START_TOLERANCE_PARAM_NAME, start_tolerance_))
+    {
+      start_tolerance_ = 1e-3;
+      ROS_INFO_STREAM("Param '" << START_TOLERANCE_PARAM_NAME << "' was not set. Using default value: "
+                                << start_tolerance_);
+    }
+    else
+      ROS_INFO_STREAM("Param '" << START_TOLERANCE_PARAM_NAME << "' was set to " << start_tolerance_);
+  }
+
+  std::string getDescription() const override
+  {
+    return "Cache Plans";
+  }
+
+  bool adaptAndPlan(const PlannerFn& planner, const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
+                    std::vector<std::size_t>& added_path_index) const override
+  {
+    ROS_DEBUG("Running '%s'", getDescription().c_str());
+    const ros::WallTime start_time = ros::WallTime::now();
+
+    const moveit::core::JointModelGroup* jmg = planning_scene->getRobotModel()->hasJointModelGroup(req.group_name) ?
+                                                   planning_scene->getRobotModel()->getJointModelGroup(req.group_name) :
+                                                   nullptr;
+    // without goal constraints, any cached trajectory would match
+    if (!jmg || req.goal_constraints.empty() || !req.trajectory_constraints.constraints.empty())
+      return planner(planning_scene, req, res);
+
+    // get the specified start state
+    moveit::core::RobotState start_state = planning_scene->getCurrentState();
+    moveit::core::robotStateMsgToRobotState(planning_scene->getTransforms(), req.start_state, start_state);
+    std::vector<double> start_positions;
+    start_state.copyJointGroupPositions(jmg, start_positions);
+
+    const std::size_t key = computeKey(*planning_scene, req);
+    if (findCachedTrajectory(*planning_scene, req, jmg, key, start_state, start_positions, res))
+    {
+      added_path_index.clear();
+      res.planning_time_ = (ros::WallTime::now() - start_time).toSec();
+      updateStatistics(true, res.planning_time_);
+      return true;
+    }
+
+    const bool solved = planner(planning_scene, req, res);
+    if (solved && res.error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS && res.trajectory_ &&
+        !res.trajectory_->empty())
+      addCachedTrajectory(key, start_positions, *res.trajectory_);
+    updateStatistics(false, (ros::WallTime::now() - start_time).toSec());
+    return solved;
+  }
+
+private:
+  struct CachedTrajectory
+  {
+    std::size_t key;
+    std::vector<double> start_positions;
+    robot_trajectory::RobotTrajectoryConstPtr trajectory;
+  };
+
+  struct Statistics
+  {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    // cached trajectories that matched a request but were invalid in its scene
+    std::size_t rejected = 0;
+    double hit_time = 0.0;
+    double miss_time = 0.0;
+  };
+
+  std::size_t computeKey(const planning_scene::PlanningScene& planning_scene,
+                         const planning_interface::MotionPlanRequest& req) const
+  {
+    moveit_msgs::Constraints path_constraints = req.path_constraints;
+    clearStamps(path_constraints);
+
+    // the scene hash covers world geometry, attached bodies, the ACM and padding, but not the start state. The octomap
+    // changes with every sensor update and is left out, cached trajectories are validated against it instead.
+    std::size_t key = planning_scene.getHash(false);
+    hashMessage(key, path_constraints);
+    boost::hash_combine(key, req.group_name);
+    boost::hash_combine(key, req.max_velocity_scaling_factor);
+    boost::hash_combine(key, req.max_acceleration_scaling_factor);
+    return key;
+  }
+
+  bool findCachedTrajectory(const planning_scene::PlanningScene& planning_scene,
+                            const planning_interface::MotionPlanRequest& req,
+                            const moveit::core::JointModelGroup* jmg, std::size_t key,
+                            const moveit::core::RobotState& start_state, const std::vector<double>& start_positions,
+                            planning_interface::MotionPlanResponse& res) const
+  {
+    // candidates ordered by the distance of their start state to the requested one
+    std::vector<std::pair<double, robot_trajectory::RobotTrajectoryConstPtr>> candidates;
+    {
+      std::lock_guard<std::mutex> slock(cache_lock_);
+      for (const CachedTrajectory& cached : cache_)
+        if (cached.key == key)
+        {
+          const double distance = getMaxDistance(cached.start_positions, start_positions);
+          if (distance <= start_tolerance_)
+            candidates.emplace_back(distance, cached.trajectory);
+        }
+    }
+    if (candidates.empty())
+      return false;
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<kinematic_constraints::KinematicConstraintSetPtr> goals;
+    for (const moveit_msgs::Constraints& goal_constraints : req.goal_constraints)
+    {
+      goals.push_back(std::make_shared<kinematic_constraints::KinematicConstraintSet>(planning_scene.getRobotModel()));
+      goals.back()->add(goal_constraints, planning_scene.getTransforms());
+    }
+
+    std::vector<const moveit::core::JointModel*> other_joints;
+    for (const moveit::core::JointModel* joint : planning_scene.getRobotModel()->getActiveJointModels())
+      if (!jmg->hasJointModel(joint->getName()))
+        other_joints.push_back(joint);
+
+    for (const auto& candidate : candidates)
+    {
+      // Start exactly at the requested positions, and keep the joints outside of the group where the request has
+      // them. Velocities and accelerations stay those of the cached time parameterization.
+      auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(*candidate.second, true);
+      trajectory->getWayPointPtr(0)->setJointGroupPositions(jmg, start_positions);
+      for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+        setJointPositions(*trajectory->getWayPointPtr(i), start_state, other_joints);
+
+      const moveit::core::RobotState& last_state = trajectory->getLastWayPoint();
+      if (std::none_of(goals.begin(), goals.end(),
+                                         [&last_state](const kinematic_constraints::KinematicConstraintSetPtr& goal) {
+                                           return goal->decide(last_state).satisfied;
+                                         }))
+        continue;
+
+      if (!planning_scene.isPathValid(*trajectory, req.path_constraints, req.group_name))
+      {
+        std::lock_guard<std::mutex> slock(cache_lock_);
+        ++statistics_.rejected;
+        continue;
+      }
+
+      {
+        // keep recently used trajectories in the cache
+        std::lock_guard<std::mutex> slock(cache_lock_);
+        auto it = std::find_if(cache_.begin(), cache_.end(), [&candidate](const CachedTrajectory& cached) {
+          return cached.trajectory == candidate.second;
+        });
+        if (it != cache_.end())
+          cache_.splice(cache_.begin(), cache_, it);
+      }
+      res.trajectory_ = trajectory;
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+      return true;
+    }
+    return false;
+  }
+
+  void addCachedTrajectory(std::size_t key, const std::vector<double>& start_positions,
+                           const robot_trajectory::RobotTrajectory& trajectory) const
+  {
+    CachedTrajectory cached;
+    cached.key = key;
+    cached.start_positions = start_positions;
+    auto copy = std::make_shared<robot_trajectory::RobotTrajectory>(trajectory, true);
+    // cached waypoints are only read, so their transforms must be up to date
+    for (std::size_t i = 0; i < copy->getWayPointCount(); ++i)
+      copy->getWayPointPtr(i)->update();
+    cached.trajectory = copy;
+
+    std::vector<double> end_positions;
+    trajectory.getLastWayPoint().copyJointGroupPositions(trajectory.getGroup(), end_positions);
+
+    std::lock_guard<std::mutex> slock(cache_lock_);
+    // a new trajectory replaces one between the same start and end states
+    cache_.remove_if([&](const CachedTrajectory& other) {
+      if (other.key != key || getMaxDistance(other.start_positions, start_positions) > start_tolerance_)
+        return false;
+      std::vector<double> other_end_positions;
+      other.trajectory->getLastWayPoint().copyJointGroupPositions(trajectory.getGroup(), other_end_positions);
+      return getMaxDistance(other_end_positions, end_positions) <= start_tolerance_;
+    });
+    cache_.push_front(std::move(cached));
+    if (cache_.size() > cache_size_)
+      cache_.pop_back();
+  }
+
+  void updateStatistics(bool hit, double duration) const
+  {
+    std::lock_guard<std::mutex> slock(cache_lock_);
+    Statistics& s = statistics_;
+    if (hit)
+    {
+      ++s.hits;
+      s.hit_time += duration;
+    }
+    else
+    {
+      ++s.misses;
+      s.miss_time += duration;
+    }
+
+    const std::size_t requests = s.hits + s.misses;
+    if (requests % 100 == 0)
+      ROS_INFO("Plan cache: %zu of %zu requests served from cache (%.1f%%), %zu cached plans invalid in the current "
+               "scene. Average latency %.4fs on hits, %.4fs on misses",
+               s.hits, requests, 100.0 * s.hits / requests, s.rejected, s.hits ? s.hit_time / s.hits : 0.0,
+               s.misses ? s.miss_time / s.misses : 0.0);
+  }
+
+  std::size_t cache_size_ = 1000;
+  double start_tolerance_ = 1e-3;
+
+  mutable std::mutex cache_lock_;
+  // most recently used first
+  mutable std::list<CachedTrajectory> cache_;
+  mutable Statistics statistics_;
+};
+
+const std::string CachePlans::CACHE_SIZE_PARAM_NAME = "plan_cache_size";
+const std::string CachePlans::START_TOLERANCE_PARAM_NAME = "plan_cache_start_tolerance";
+}  // namespace default_planner_request_adapters
+
+CLASS_LOADER_REGISTER_CLASS(default_planner_request_adapters::CachePlans,
+                            planning_request_adapter::PlanningRequestAdapter);
@@ -0,0 +1,252 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <geometric_shapes/shapes.h>
+#include <octomap/octomap.h>
+#include <pluginlib/class_loader.hpp>
+#include <ros/ros.h>
+#include <memory>
+
+class CachePlansTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // a box on a planar base, with an arm that is not part of the planning group
+    moveit::core::RobotModelBuilder builder("simple", "base_link");
+    geometry_msgs::Pose origin;
+    origin.orientation.w = 1.0;
+    builder.addCollisionBox("base_link", { 0.2, 0.2, 0.2 }, origin);
+    builder.addChain("base_link->arm", "continuous");
+    origin.position.x = 0.35;
+    builder.addCollisionBox("arm", { 0.4, 0.05, 0.05 }, origin);
+    builder.addVirtualJoint("odom_combined", "base_link", "planar", "world_joint");
+    builder.addGroup({}, { "world_joint" }, "base");
+    ASSERT_TRUE(builder.isValid());
+    robot_model_ = builder.build();
+    scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    scene_->getCurrentStateNonConst().setToDefaultValues();
+
+    ros::NodeHandle nh("~");
+    nh.setParam("plan_cache_size", 2);
+    loader_ = std::make_unique<pluginlib::ClassLoader<planning_request_adapter::PlanningRequestAdapter>>(
+        "moveit_core", "planning_request_adapter::PlanningRequestAdapter");
+    adapter_ = loader_->createUniqueInstance("default_planner_request_adapters/CachePlans");
+    adapter_->initialize(nh);
+  }
+
+  planning_interface::MotionPlanRequest makeRequest(double goal_x) const
+  {
+    planning_interface::MotionPlanRequest req;
+    req.group_name = "base";
+    moveit::core::robotStateToRobotStateMsg(scene_->getCurrentState(), req.start_state);
+    req.goal_constraints.resize(1);
+    req.goal_constraints[0].joint_constraints.resize(1);
+    moveit_msgs::JointConstraint& jc = req.goal_constraints[0].joint_constraints[0];
+    jc.joint_name = "world_joint/x";
+    jc.position = goal_x;
+    jc.tolerance_above = jc.tolerance_below = 1e-3;
+    jc.weight = 1.0;
+    return req;
+  }
+
+  // plan with a straight line along x at constant velocity, counting the calls of the actual planner
+  bool plan(const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res)
+  {
+    std::vector<std::size_t> added_path_index;
+    return adapter_->adaptAndPlan(
+        [this](const planning_scene::PlanningSceneConstPtr& scene,
+               const planning_interface::MotionPlanRequest& planner_req,
+               planning_interface::MotionPlanResponse& planner_res) {
+          ++planner_calls_;
+          moveit::core::RobotState state = scene->getCurrentState();
+          moveit::core::robotStateMsgToRobotState(planner_req.start_state, state);
+          const double start_x = state.getVariablePosition("world_joint/x");
+          const double goal_x = planner_req.goal_constraints.empty() ?
+                                    start_x :
+                                    planner_req.goal_constraints[0].joint_constraints[0].position;
+          planner_res.trajectory_ =
+              std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, planner_req.group_name);
+          for (std::size_t i = 0; i <= 10; ++i)
+          {
+            state.setVariablePosition("world_joint/x", start_x + 0.1 * i * (goal_x - start_x));
+            state.setVariableVelocity("world_joint/x", goal_x - start_x);
+            state.setVariableAcceleration("world_joint/x", 0.0);
+            planner_res.trajectory_->addSuffixWayPoint(state, 0.1);
+          }
+          planner_res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+          return true;
+        },
+        scene_, req, res, added_path_index);
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  planning_scene::PlanningScenePtr scene_;
+  std::unique_ptr<pluginlib::ClassLoader<planning_request_adapter::PlanningRequestAdapter>> loader_;
+  planning_request_adapter::PlanningRequestAdapterPtr adapter_;
+  unsigned int planner_calls_ = 0;
+};
+
+TEST_F(CachePlansTest, HitOnIdenticalRequest)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+  ASSERT_TRUE(plan(makeRequest(1.0), res2));
+  EXPECT_EQ(planner_calls_, 1u);
+  ASSERT_TRUE(res2.trajectory_);
+  EXPECT_EQ(res2.trajectory_->getWayPointCount(), res1.trajectory_->getWayPointCount());
+  EXPECT_NEAR(res2.trajectory_->getLastWayPoint().getVariablePosition("world_joint/x"), 1.0, 1e-9);
+}
+
+TEST_F(CachePlansTest, JointsOutsideGroupFollowStartState)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+
+  // the same request, but with the arm (which is not in the group) moved
+  planning_interface::MotionPlanRequest req = makeRequest(1.0);
+  moveit::core::RobotState start_state = scene_->getCurrentState();
+  start_state.setVariablePosition("base_link-arm-joint", 1.0);
+  moveit::core::robotStateToRobotStateMsg(start_state, req.start_state);
+  ASSERT_TRUE(plan(req, res2));
+  EXPECT_EQ(planner_calls_, 1u);
+  for (std::size_t i = 0; i < res2.trajectory_->getWayPointCount(); ++i)
+    EXPECT_EQ(res2.trajectory_->getWayPoint(i).getVariablePosition("base_link-arm-joint"), 1.0);
+}
+
+TEST_F(CachePlansTest, KeepCachedVelocities)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+
+  // a start state with velocities does not change the time parameterization of the cached trajectory
+  planning_interface::MotionPlanRequest req = makeRequest(1.0);
+  moveit::core::RobotState start_state = scene_->getCurrentState();
+  start_state.setVariableVelocity("world_joint/x", 5.0);
+  start_state.setVariableAcceleration("world_joint/x", 5.0);
+  start_state.setVariablePosition("base_link-arm-joint", 1.0);
+  moveit::core::robotStateToRobotStateMsg(start_state, req.start_state);
+  ASSERT_TRUE(plan(req, res2));
+  EXPECT_EQ(planner_calls_, 1u);
+  for (std::size_t i = 0; i < res2.trajectory_->getWayPointCount(); ++i)
+  {
+    const moveit::core::RobotState& waypoint = res2.trajectory_->getWayPoint(i);
+    EXPECT_EQ(waypoint.getVariablePosition("base_link-arm-joint"), 1.0) << i;
+    EXPECT_EQ(waypoint.getVariableVelocity("world_joint/x"), 1.0) << i;
+    EXPECT_EQ(waypoint.getVariableAcceleration("world_joint/x"), 0.0) << i;
+  }
+  EXPECT_EQ(res2.trajectory_->getWayPoint(0).getVariablePosition("world_joint/x"), 0.0);
+}
+
+TEST_F(CachePlansTest, MissWithoutGoal)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+
+  // a request without goal constraints must not return the cached trajectory to 1.0
+  planning_interface::MotionPlanRequest req = makeRequest(1.0);
+  req.goal_constraints.clear();
+  ASSERT_TRUE(plan(req, res2));
+  EXPECT_EQ(planner_calls_, 2u);
+  EXPECT_EQ(res2.trajectory_->getLastWayPoint().getVariablePosition("world_joint/x"), 0.0);
+}
+
+TEST_F(CachePlansTest, RejectAfterSceneChange)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+
+  // put an obstacle on the cached path
+  scene_->getWorldNonConst()->addToObject("box", std::make_shared<shapes::Box>(0.1, 0.1, 0.1),
+                                          Eigen::Isometry3d(Eigen::Translation3d(0.5, 0.0, 0.0)));
+  ASSERT_TRUE(plan(makeRequest(1.0), res2));
+  EXPECT_EQ(planner_calls_, 2u);
+}
+
+TEST_F(CachePlansTest, HitAfterOctomapUpdate)
+{
+  auto octree = std::make_shared<octomap::OcTree>(0.1);
+  scene_->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 1);
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+
+  // the octomap is not part of the key, the cached trajectory is checked against it
+  octree->updateNode(octomap::point3d(0.0, 2.0, 0.0), true);
+  scene_->processOctomapPtr(octree, Eigen::Isometry3d::Identity(), 2);
+  ASSERT_TRUE(plan(makeRequest(1.0), res2));
+  EXPECT_EQ(planner_calls_, 1u);
+}
+
+TEST_F(CachePlansTest, RejectUnsatisfiedGoal)
+{
+  planning_interface::MotionPlanResponse res1, res2;
+  ASSERT_TRUE(plan(makeRequest(1.0), res1));
+  ASSERT_TRUE(plan(makeRequest(-1.0), res2));
+  EXPECT_EQ(planner_calls_, 2u);
+  EXPECT_NEAR(res2.trajectory_->getLastWayPoint().getVariablePosition("world_joint/x"), -1.0, 1e-9);
+}
+
+TEST_F(CachePlansTest, EvictLeastRecentlyUsed)
+{
+  planning_interface::MotionPlanResponse res;
+  // plan_cache_size is 2
+  ASSERT_TRUE(plan(makeRequest(1.0), res));
+  ASSERT_TRUE(plan(makeRequest(2.0), res));
+  ASSERT_TRUE(plan(makeRequest(3.0), res));
+  EXPECT_EQ(planner_calls_, 3u);
+
+  // the plan to 2.0 becomes the most recently used one, the plan to 1.0 was evicted
+  ASSERT_TRUE(plan(makeRequest(2.0), res));
+  EXPECT_EQ(planner_calls_, 3u);
+  ASSERT_TRUE(plan(makeRequest(1.0), res));
+  EXPECT_EQ(planner_calls_, 4u);
+
+  // adding the plan to 1.0 evicted the plan to 3.0
+  ASSERT_TRUE(plan(makeRequest(2.0), res));
+  EXPECT_EQ(planner_calls_, 4u);
+  ASSERT_TRUE(plan(makeRequest(3.0), res));
+  EXPECT_EQ(planner_calls_, 5u);
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "test_cache_plans");
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
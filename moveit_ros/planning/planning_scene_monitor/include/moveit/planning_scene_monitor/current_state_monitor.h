@@ -188,14 +188,36 @@ public:
   }
 
 private:
+  /** @brief Joint models corresponding to the names of a joint state message, in message order.
+   *  Entries are nullptr for names that are unknown or do not belong to a single-variable joint. */
+  struct JointStateLayout
+  {
+    std::vector<std::string> names;
+    std::vector<const moveit::core::JointModel*> joints;
+  };
+
   void jointStateCallback(const sensor_msgs::JointStateConstPtr& joint_state);
   void tfCallback();
 
+  /** @brief Find the cached layout matching the joint names of \e joint_state, creating it if needed */
+  const JointStateLayout& getJointStateLayout(const sensor_msgs::JointState& joint_state);
+
+  /** @brief Copy the current state into \e upd (call with state_update_lock_ held) */
+  void setToCurrentStateUnlocked(moveit::core::RobotState& upd) const;
+
+  /** @brief Mark \e joint as updated at time \e stamp (call with state_update_lock_ held) */
+  void setJointTime(const moveit::core::JointModel* joint, const ros::Time& stamp)
+  {
+    joint_time_[joint->getJointIndex()] = stamp;
+    joint_time_valid_[joint->getJointIndex()] = true;
+  }
+
   ros::NodeHandle nh_;
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   moveit::core::RobotModelConstPtr robot_model_;
   moveit::core::RobotState robot_state_;
-  std::map<const moveit::core::JointModel*, ros::Time> joint_time_;
+  std::vector<ros::Time> joint_time_;  // indexed by joint index
+  std::vector<bool> joint_time_valid_;  // whether joint_time_ was ever set for a joint
   bool state_monitor_started_;
   bool copy_dynamics_;  // Copy velocity and effort from joint_state
   ros::Time monitor_start_time_;
@@ -207,6 +229,11 @@ private:
   mutable boost::condition_variable state_update_condition_;
   std::vector<JointStateUpdateCallback> update_callbacks_;
 
+  // Layouts of recently received joint state messages (one per publisher, typically), so that joint names
+  // need not be resolved for every message. Only accessed from jointStateCallback(), which is not reentrant.
+  std::vector<JointStateLayout> joint_state_layouts_;
+  std::size_t next_evicted_layout_;
+
   std::shared_ptr<TFConnection> tf_connection_;
 };
 
@@ -39,8 +39,15 @@
 #include <tf2_eigen/tf2_eigen.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include <algorithm>
 #include <limits>
 
+namespace
+{
+// number of distinct joint state layouts (i.e. publishers) remembered by the state monitor
+constexpr std::size_t MAX_JOINT_STATE_LAYOUTS = 8;
+}  // namespace
+
 planning_scene_monitor::CurrentStateMonitor::CurrentStateMonitor(const moveit::core::RobotModelConstPtr& robot_model,
                                                                  const std::shared_ptr<tf2_ros::Buffer>& tf_buffer)
   : CurrentStateMonitor(robot_model, tf_buffer, ros::NodeHandle())
@@ -54,9 +61,12 @@ planning_scene_monitor::CurrentStateMonitor::CurrentStateMonitor(const moveit::c
   , tf_buffer_(tf_buffer)
   , robot_model_(robot_model)
   , robot_state_(robot_model)
+  , joint_time_(robot_model->getJointModelCount())
+  , joint_time_valid_(robot_model->getJointModelCount(), false)
   , state_monitor_started_(false)
   , copy_dynamics_(false)
   , error_(std::numeric_limits<double>::epsilon())
+  , next_evicted_layout_(0)
 {
   robot_state_.setToDefaultValues();
 }
@@ -68,9 +78,10 @@ planning_scene_monitor::CurrentStateMonitor::~CurrentStateMonitor()
 
 moveit::core::RobotStatePtr planning_scene_monitor::CurrentStateMonitor::getCurrentState() const
 {
-  boost::mutex::scoped_lock slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return moveit::core::RobotStatePtr(result);
+  // allocate outside of the lock, so that only copying the values blocks the state update callbacks
+  moveit::core::RobotStatePtr result(new moveit::core::RobotState(robot_model_));
+  setToCurrentState(*result);
+  return result;
 }
 
 ros::Time planning_scene_monitor::CurrentStateMonitor::getCurrentStateTime() const
@@ -82,9 +93,14 @@ ros::Time planning_scene_monitor::CurrentStateMonitor::getCurrentStateTime() con
 std::pair<moveit::core::RobotStatePtr, ros::Time>
 planning_scene_monitor::CurrentStateMonitor::getCurrentStateAndTime() const
 {
-  boost::mutex::scoped_lock slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return std::make_pair(moveit::core::RobotStatePtr(result), current_state_time_);
+  moveit::core::RobotStatePtr result(new moveit::core::RobotState(robot_model_));
+  ros::Time time;
+  {
+    boost::mutex::scoped_lock slock(state_update_lock_);
+    setToCurrentStateUnlocked(*result);
+    time = current_state_time_;
+  }
+  return std::make_pair(result, time);
 }
 
 std::map<std::string, double> planning_scene_monitor::CurrentStateMonitor::getCurrentStateValues() const
@@ -101,6 +117,11 @@ std::map<std::string, double> planning_scene_monitor::CurrentStateMonitor::getCu
 void planning_scene_monitor::CurrentStateMonitor::setToCurrentState(moveit::core::RobotState& upd) const
 {
   boost::mutex::scoped_lock slock(state_update_lock_);
+  setToCurrentStateUnlocked(upd);
+}
+
+void planning_scene_monitor::CurrentStateMonitor::setToCurrentStateUnlocked(moveit::core::RobotState& upd) const
+{
   const double* pos = robot_state_.getVariablePositions();
   upd.setVariablePositions(pos);
   if (copy_dynamics_)
@@ -138,7 +159,9 @@ void planning_scene_monitor::CurrentStateMonitor::startStateMonitor(const std::s
 {
   if (!state_monitor_started_ && robot_model_)
   {
-    joint_time_.clear();
+    std::fill(joint_time_valid_.begin(), joint_time_valid_.end(), false);
+    joint_state_layouts_.clear();
+    next_evicted_layout_ = 0;
     if (joint_states_topic.empty())
       ROS_ERROR("The joint states topic cannot be an empty string");
     else
@@ -188,7 +211,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState() const
   const std::vector<const moveit::core::JointModel*>& joints = robot_model_->getActiveJointModels();
   boost::mutex::scoped_lock slock(state_update_lock_);
   for (const moveit::core::JointModel* joint : joints)
-    if (joint_time_.find(joint) == joint_time_.end())
+    if (!joint_time_valid_[joint->getJointIndex()])
     {
       if (!joint->isPassive() && !joint->getMimic())
       {
@@ -205,7 +228,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(std::vector<
   const std::vector<const moveit::core::JointModel*>& joints = robot_model_->getActiveJointModels();
   boost::mutex::scoped_lock slock(state_update_lock_);
   for (const moveit::core::JointModel* joint : joints)
-    if (joint_time_.find(joint) == joint_time_.end())
+    if (!joint_time_valid_[joint->getJointIndex()])
       if (!joint->isPassive() && !joint->getMimic())
       {
         missing_states.push_back(joint->getName());
@@ -225,16 +248,15 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(const ros::D
   {
     if (joint->isPassive() || joint->getMimic())
       continue;
-    std::map<const moveit::core::JointModel*, ros::Time>::const_iterator it = joint_time_.find(joint);
-    if (it == joint_time_.end())
+    if (!joint_time_valid_[joint->getJointIndex()])
     {
       ROS_DEBUG("Joint '%s' has never been updated", joint->getName().c_str());
       result = false;
     }
-    else if (it->second < old)
+    else if (joint_time_[joint->getJointIndex()] < old)
     {
       ROS_DEBUG("Joint '%s' was last updated %0.3lf seconds ago (older than the allowed %0.3lf seconds)",
-                joint->getName().c_str(), (now - it->second).toSec(), age.toSec());
+                joint->getName().c_str(), (now - joint_time_[joint->getJointIndex()]).toSec(), age.toSec());
       result = false;
     }
   }
@@ -253,17 +275,16 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(const ros::D
   {
     if (joint->isPassive() || joint->getMimic())
       continue;
-    std::map<const moveit::core::JointModel*, ros::Time>::const_iterator it = joint_time_.find(joint);
-    if (it == joint_time_.end())
+    if (!joint_time_valid_[joint->getJointIndex()])
     {
       ROS_DEBUG("Joint '%s' has never been updated", joint->getName().c_str());
       missing_states.push_back(joint->getName());
       result = false;
     }
-    else if (it->second < old)
+    else if (joint_time_[joint->getJointIndex()] < old)
     {
       ROS_DEBUG("Joint '%s' was last updated %0.3lf seconds ago (older than the allowed %0.3lf seconds)",
-                joint->getName().c_str(), (now - it->second).toSec(), age.toSec());
+                joint->getName().c_str(), (now - joint_time_[joint->getJointIndex()]).toSec(), age.toSec());
       missing_states.push_back(joint->getName());
       result = false;
     }
@@ -343,6 +364,9 @@ void planning_scene_monitor::CurrentStateMonitor::jointStateCallback(const senso
   }
   bool update = false;
 
+  // resolve joint names before locking, this is a no-op for layouts seen before
+  const JointStateLayout& layout = getJointStateLayout(*joint_state);
+
   {
     boost::mutex::scoped_lock _(state_update_lock_);
     // read the received values, and update their time stamps
@@ -350,14 +374,11 @@ void planning_scene_monitor::CurrentStateMonitor::jointStateCallback(const senso
     current_state_time_ = joint_state->header.stamp;
     for (std::size_t i = 0; i < n; ++i)
     {
-      const moveit::core::JointModel* jm = robot_model_->getJointModel(joint_state->name[i]);
+      const moveit::core::JointModel* jm = layout.joints[i];
       if (!jm)
         continue;
-      // ignore fixed joints, multi-dof joints (they should not even be in the message)
-      if (jm->getVariableCount() != 1)
-        continue;
 
-      joint_time_[jm] = joint_state->header.stamp;
+      setJointTime(jm, joint_state->header.stamp);
 
       if (robot_state_.getJointPositions(jm)[0] != joint_state->position[i])
       {
@@ -411,6 +432,37 @@ void planning_scene_monitor::CurrentStateMonitor::jointStateCallback(const senso
   state_update_condition_.notify_all();
 }
 
+const planning_scene_monitor::CurrentStateMonitor::JointStateLayout&
+planning_scene_monitor::CurrentStateMonitor::getJointStateLayout(const sensor_msgs::JointState& joint_state)
+{
+  for (const JointStateLayout& layout : joint_state_layouts_)
+    if (layout.names == joint_state.name)
+      return layout;
+
+  JointStateLayout layout;
+  layout.names = joint_state.name;
+  layout.joints.reserve(joint_state.name.size());
+  for (const std::string& name : joint_state.name)
+  {
+    const moveit::core::JointModel* jm = robot_model_->getJointModel(name);
+    // ignore fixed joints, multi-dof joints (they should not even be in the message)
+    if (jm && jm->getVariableCount() != 1)
+      jm = nullptr;
+    layout.joints.push_back(jm);
+  }
+
+  if (joint_state_layouts_.size() < MAX_JOINT_STATE_LAYOUTS)
+  {
+    joint_state_layouts_.push_back(std::move(layout));
+    return joint_state_layouts_.back();
+  }
+  // replace the layouts round-robin if there are more publishers than we remember
+  JointStateLayout& evicted = joint_state_layouts_[next_evicted_layout_];
+  next_evicted_layout_ = (next_evicted_layout_ + 1) % MAX_JOINT_STATE_LAYOUTS;
+  evicted = std::move(layout);
+  return evicted;
+}
+
 void planning_scene_monitor::CurrentStateMonitor::tfCallback()
 {
   // read multi-dof joint states from TF, if needed
@@ -443,9 +495,10 @@ void planning_scene_monitor::CurrentStateMonitor::tfCallback()
       }
 
       // allow update if time is more recent or if it is a static transform (time = 0)
-      if (latest_common_time <= joint_time_[joint] && latest_common_time > ros::Time(0))
+      if (joint_time_valid_[joint->getJointIndex()] && latest_common_time <= joint_time_[joint->getJointIndex()] &&
+          latest_common_time > ros::Time(0))
         continue;
-      joint_time_[joint] = latest_common_time;
+      setJointTime(joint, latest_common_time);
 
       std::vector<double> new_values(joint->getStateSpaceDimension());
       const moveit::core::LinkModel* link = joint->getChildLinkModel();
@@ -1220,22 +1220,28 @@ void PlanningSceneMonitor::octomapUpdateCallback()
     return;
 
   updateFrameTransforms();
+  bool changed;
   {
     boost::unique_lock<boost::shared_mutex> ulock(scene_update_mutex_);
-    last_update_time_ = ros::Time::now();
-    octomap_monitor_->getOcTreePtr()->lockRead();
+    const occupancy_map_monitor::OccMapTreePtr& tree = octomap_monitor_->getOcTreePtr();
+    tree->lockRead();
     try
     {
-      scene_->processOctomapPtr(octomap_monitor_->getOcTreePtr(), Eigen::Isometry3d::Identity());
-      octomap_monitor_->getOcTreePtr()->unlockRead();
+      // The scene shares the monitored tree by pointer and FCL traverses it directly, so in-place updates need no
+      // geometry rebuild. Callbacks of concurrent updaters can coalesce, in which case the scene is already current.
+      changed = scene_->processOctomapPtr(tree, Eigen::Isometry3d::Identity(), tree->getVersion());
+      tree->unlockRead();
     }
     catch (...)
     {
-      octomap_monitor_->getOcTreePtr()->unlockRead();  // unlock and rethrow
+      tree->unlockRead();  // unlock and rethrow
       throw;
     }
+    if (changed)
+      last_update_time_ = ros::Time::now();
   }
-  triggerSceneUpdateEvent(UPDATE_GEOMETRY);
+  if (changed)
+    triggerSceneUpdateEvent(UPDATE_GEOMETRY);
 }
 
 void PlanningSceneMonitor::setStateUpdateFrequency(double hz)
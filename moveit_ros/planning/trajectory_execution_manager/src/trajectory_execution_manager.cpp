@@ -36,6 +36,7 @@
 
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/profiler/tracer.h>
 #include <moveit_ros_planning/TrajectoryExecutionDynamicReconfigureConfig.h>
 #include <geometric_shapes/check_isometry.h>
 #include <dynamic_reconfigure/server.h>
@@ -933,6 +934,8 @@ bool TrajectoryExecutionManager::distributeTrajectory(const moveit_msgs::RobotTr
 
 bool TrajectoryExecutionManager::validate(const TrajectoryExecutionContext& context) const
 {
+  MOVEIT_TRACE_SCOPE("TrajectoryExecutionManager::validate");
+
   if (allowed_start_tolerance_ == 0)  // skip validation on this magic number
     return true;
 
@@ -1269,6 +1272,8 @@ void TrajectoryExecutionManager::clear()
 void TrajectoryExecutionManager::executeThread(const ExecutionCompleteCallback& callback,
                                                const PathSegmentCompleteCallback& part_callback, bool auto_clear)
 {
+  MOVEIT_TRACE_SCOPE("TrajectoryExecutionManager::execute");
+
   // if we already got a stop request before we even started anything, we abort
   if (execution_complete_)
   {
@@ -1320,6 +1325,7 @@ void TrajectoryExecutionManager::executeThread(const ExecutionCompleteCallback&
 
 bool TrajectoryExecutionManager::executePart(std::size_t part_index)
 {
+  MOVEIT_TRACE_SCOPE("TrajectoryExecutionManager::executePart");
   TrajectoryExecutionContext& context = *trajectories_[part_index];
 
   // first make sure desired controllers are active
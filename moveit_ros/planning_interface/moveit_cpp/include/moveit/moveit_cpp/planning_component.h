@@ -44,6 +44,7 @@
 #include <geometry_msgs/PoseStamped.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit_msgs/MoveItErrorCodes.h>
+#include <functional>
 
 namespace moveit
 {
@@ -113,9 +114,9 @@ public:
     double max_velocity_scaling_factor;
     double max_acceleration_scaling_factor;
 
-    void load(const ros::NodeHandle& nh)
+    void load(const ros::NodeHandle& nh, const std::string& param_namespace = "plan_request_params")
     {
-      std::string ns = "plan_request_params/";
+      std::string ns = param_namespace + "/";
       nh.param(ns + "planner_id", planner_id, std::string(""));
       nh.param(ns + "planning_pipeline", planning_pipeline, std::string(""));
       nh.param(ns + "planning_time", planning_time, 1.0);
@@ -125,6 +126,33 @@ public:
     }
   };
 
+  /// Planner parameters for planning with several pipelines and planner configurations in parallel
+  struct MultiPipelinePlanRequestParameters
+  {
+    std::vector<PlanRequestParameters> plan_request_parameter_vector;
+
+    /// Load one set of PlanRequestParameters from each of the given parameter namespaces
+    void load(const ros::NodeHandle& nh, const std::vector<std::string>& param_namespaces)
+    {
+      plan_request_parameter_vector.resize(param_namespaces.size());
+      for (std::size_t i = 0; i < param_namespaces.size(); ++i)
+        plan_request_parameter_vector[i].load(nh, param_namespaces[i]);
+    }
+  };
+
+  /// Cost of a successful plan solution, used to select among the solutions of parallel planners
+  using PlanSolutionCostFunction = std::function<double(const PlanSolution&)>;
+
+  /// Called with all solutions found so far each time a parallel planner finishes. Returning true terminates the
+  /// planners that are still running.
+  using StoppingCriterionFunction = std::function<bool(const std::vector<PlanSolution>&)>;
+
+  /** \brief Cost function selecting the solution with the shortest joint-space path */
+  static double getPathLengthCost(const PlanSolution& solution);
+
+  /** \brief Stopping criterion that accepts the first successful solution */
+  static bool stopAtFirstSolution(const std::vector<PlanSolution>& solutions);
+
   /** \brief Constructor */
   PlanningComponent(const std::string& group_name, const ros::NodeHandle& nh);
   PlanningComponent(const std::string& group_name, const MoveItCppPtr& moveit_cpp);
@@ -188,6 +216,14 @@ public:
    * provided PlanRequestParameters. */
   PlanSolution plan(const PlanRequestParameters& parameters);
 
+  /** \brief Run the same request with each of the provided PlanRequestParameters in parallel and return the successful
+   * solution with the lowest cost. Each planner runs until it finishes or until \e stopping_criterion accepts the
+   * solutions found so far, e.g. stopAtFirstSolution(). The remaining planners are then stopped through
+   * PlanningPipeline::terminate(), which interrupts all active planning contexts of this process. */
+  PlanSolution plan(const MultiPipelinePlanRequestParameters& parameters,
+                    const PlanSolutionCostFunction& cost_function = &PlanningComponent::getPathLengthCost,
+                    const StoppingCriterionFunction& stopping_criterion = StoppingCriterionFunction());
+
   /** \brief Execute the latest computed solution trajectory computed by plan(). By default this function terminates
    * after the execution is complete. The execution can be run in background by setting blocking to false. */
   bool execute(bool blocking = true);
@@ -222,6 +258,14 @@ private:
   // std::unique_ptr<moveit_msgs::Constraints> path_constraints_;
   // std::unique_ptr<moveit_msgs::TrajectoryConstraints> trajectory_constraints_;
 
+  /** \brief Set up a planning scene snapshot and the parts of the motion plan request common to all planners */
+  bool initializePlanRequest(planning_scene::PlanningScenePtr& planning_scene,
+                             ::planning_interface::MotionPlanRequest& req, MoveItErrorCode& error_code);
+
+  /** \brief Plan with the pipeline and planner configuration selected by \e parameters */
+  PlanSolution planWithPipeline(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                ::planning_interface::MotionPlanRequest req, const PlanRequestParameters& parameters);
+
   /** \brief Reset all member variables */
   void clearContents();
 };
@@ -0,0 +1,85 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/moveit_cpp/plan_solution_metrics.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace moveit
+{
+namespace planning_interface
+{
+double getPathLength(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  double length = 0.0;
+  for (std::size_t i = 1; i < trajectory.getWayPointCount(); ++i)
+    length += trajectory.getWayPoint(i - 1).distance(trajectory.getWayPoint(i), trajectory.getGroup());
+  return length;
+}
+
+double getPathSmoothness(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  double smoothness = 0.0;
+  if (trajectory.getWayPointCount() < 3)
+    return smoothness;
+
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  double a = trajectory.getWayPoint(0).distance(trajectory.getWayPoint(1), group);
+  for (std::size_t i = 2; i < trajectory.getWayPointCount(); ++i)
+  {
+    const double b = trajectory.getWayPoint(i - 1).distance(trajectory.getWayPoint(i), group);
+    const double c = trajectory.getWayPoint(i - 2).distance(trajectory.getWayPoint(i), group);
+    if (a > std::numeric_limits<double>::epsilon() && b > std::numeric_limits<double>::epsilon())
+    {
+      // angle between the two segments at waypoint i - 1, from the law of cosines
+      const double cos_angle = std::max(-1.0, std::min(1.0, (a * a + b * b - c * c) / (2.0 * a * b)));
+      const double turning_rate = 2.0 * (M_PI - std::acos(cos_angle)) / (a + b);
+      smoothness += turning_rate * turning_rate;
+    }
+    a = b;
+  }
+  return smoothness;
+}
+
+double getPathClearance(const robot_trajectory::RobotTrajectory& trajectory,
+                        const planning_scene::PlanningScene& planning_scene)
+{
+  double clearance = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+    clearance = std::min(clearance, planning_scene.distanceToCollision(trajectory.getWayPoint(i)));
+  return clearance;
+}
+}  // namespace planning_interface
+}  // namespace moveit
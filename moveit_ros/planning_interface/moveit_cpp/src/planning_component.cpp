@@ -34,12 +34,19 @@
 
 /* Author: Henning Kayser */
 
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 #include <memory>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/move_group/capability_names.h>
 #include <moveit/moveit_cpp/planning_component.h>
+#include <moveit/moveit_cpp/plan_solution_metrics.h>
 #include <moveit/planning_scene_monitor/current_state_monitor.h>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/planning_scene_interface/planning_scene_interface.h>
@@ -112,14 +119,14 @@ const std::string& PlanningComponent::getPlanningGroupName() const
   return group_name_;
 }
 
-PlanningComponent::PlanSolution PlanningComponent::plan(const PlanRequestParameters& parameters)
+bool PlanningComponent::initializePlanRequest(planning_scene::PlanningScenePtr& planning_scene,
+                                              ::planning_interface::MotionPlanRequest& req, MoveItErrorCode& error_code)
 {
-  last_plan_solution_.reset(new PlanSolution());
   if (!joint_model_group_)
   {
     ROS_ERROR_NAMED(LOGNAME, "Failed to retrieve joint model group for name '%s'.", group_name_.c_str());
-    last_plan_solution_->error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME);
-    return *last_plan_solution_;
+    error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME);
+    return false;
   }
 
   // Clone current planning scene
@@ -127,19 +134,12 @@ PlanningComponent::PlanSolution PlanningComponent::plan(const PlanRequestParamet
       moveit_cpp_->getPlanningSceneMonitorNonConst();
   planning_scene_monitor->updateFrameTransforms();
   planning_scene_monitor->lockSceneRead();  // LOCK planning scene
-  planning_scene::PlanningScenePtr planning_scene =
-      planning_scene::PlanningScene::clone(planning_scene_monitor->getPlanningScene());
+  planning_scene = planning_scene::PlanningScene::clone(planning_scene_monitor->getPlanningScene());
   planning_scene_monitor->unlockSceneRead();  // UNLOCK planning scene
   planning_scene_monitor.reset();             // release this pointer
 
   // Init MotionPlanRequest
-  ::planning_interface::MotionPlanRequest req;
   req.group_name = group_name_;
-  req.planner_id = parameters.planner_id;
-  req.num_planning_attempts = std::max(1, parameters.planning_attempts);
-  req.allowed_planning_time = parameters.planning_time;
-  req.max_velocity_scaling_factor = parameters.max_velocity_scaling_factor;
-  req.max_acceleration_scaling_factor = parameters.max_acceleration_scaling_factor;
   if (workspace_parameters_set_)
     req.workspace_parameters = workspace_parameters_;
 
@@ -155,30 +155,44 @@ PlanningComponent::PlanSolution PlanningComponent::plan(const PlanRequestParamet
   if (current_goal_constraints_.empty())
   {
     ROS_ERROR_NAMED(LOGNAME, "No goal constraints set for planning request");
-    last_plan_solution_->error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS);
-    return *last_plan_solution_;
+    error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS);
+    return false;
   }
   req.goal_constraints = current_goal_constraints_;
+  return true;
+}
+
+PlanningComponent::PlanSolution
+PlanningComponent::planWithPipeline(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                    ::planning_interface::MotionPlanRequest req,
+                                    const PlanRequestParameters& parameters)
+{
+  PlanSolution solution;
+  req.planner_id = parameters.planner_id;
+  req.num_planning_attempts = std::max(1, parameters.planning_attempts);
+  req.allowed_planning_time = parameters.planning_time;
+  req.max_velocity_scaling_factor = parameters.max_velocity_scaling_factor;
+  req.max_acceleration_scaling_factor = parameters.max_acceleration_scaling_factor;
 
   // Run planning attempt
   ::planning_interface::MotionPlanResponse res;
   if (planning_pipeline_names_.find(parameters.planning_pipeline) == planning_pipeline_names_.end())
   {
     ROS_ERROR_NAMED(LOGNAME, "No planning pipeline available for name '%s'", parameters.planning_pipeline.c_str());
-    last_plan_solution_->error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
-    return *last_plan_solution_;
+    solution.error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
+    return solution;
   }
   const planning_pipeline::PlanningPipelinePtr pipeline =
       moveit_cpp_->getPlanningPipelines().at(parameters.planning_pipeline);
   pipeline->generatePlan(planning_scene, req, res);
-  last_plan_solution_->error_code = res.error_code_.val;
+  solution.error_code = res.error_code_.val;
   if (res.error_code_.val != res.error_code_.SUCCESS)
   {
     ROS_ERROR("Could not compute plan successfully");
-    return *last_plan_solution_;
+    return solution;
   }
-  last_plan_solution_->start_state = req.start_state;
-  last_plan_solution_->trajectory = res.trajectory_;
+  solution.start_state = req.start_state;
+  solution.trajectory = res.trajectory_;
   // TODO(henningkayser): Visualize trajectory
   // std::vector<const moveit::core::LinkModel*> eef_links;
   // if (joint_model_group->getEndEffectorTips(eef_links))
@@ -191,9 +205,121 @@ PlanningComponent::PlanSolution PlanningComponent::plan(const PlanRequestParamet
   //    visual_tools_->publishRobotState(last_solution_trajectory_->getLastWayPoint(), rviz_visual_tools::TRANSLUCENT);
   //  }
   //}
+  return solution;
+}
+
+PlanningComponent::PlanSolution PlanningComponent::plan(const PlanRequestParameters& parameters)
+{
+  last_plan_solution_.reset(new PlanSolution());
+  planning_scene::PlanningScenePtr planning_scene;
+  ::planning_interface::MotionPlanRequest req;
+  if (initializePlanRequest(planning_scene, req, last_plan_solution_->error_code))
+    *last_plan_solution_ = planWithPipeline(planning_scene, req, parameters);
+  return *last_plan_solution_;
+}
+
+PlanningComponent::PlanSolution PlanningComponent::plan(const MultiPipelinePlanRequestParameters& parameters,
+                                                        const PlanSolutionCostFunction& cost_function,
+                                                        const StoppingCriterionFunction& stopping_criterion)
+{
+  last_plan_solution_.reset(new PlanSolution());
+  if (parameters.plan_request_parameter_vector.empty())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "No planning pipelines specified for parallel planning");
+    last_plan_solution_->error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
+    return *last_plan_solution_;
+  }
+
+  planning_scene::PlanningScenePtr planning_scene;
+  ::planning_interface::MotionPlanRequest req;
+  if (!initializePlanRequest(planning_scene, req, last_plan_solution_->error_code))
+    return *last_plan_solution_;
+
+  const std::vector<PlanRequestParameters>& parameter_vector = parameters.plan_request_parameter_vector;
+  std::mutex solutions_lock;
+  std::condition_variable planner_finished;
+  std::vector<PlanSolution> solutions;
+  std::vector<bool> running(parameter_vector.size(), true);
+  std::size_t num_running = parameter_vector.size();
+  bool stopped = false;
+
+  const auto plan_with_parameters = [&](std::size_t index) {
+    bool skip;
+    {
+      std::lock_guard<std::mutex> slock(solutions_lock);
+      skip = stopped;
+    }
+    if (!skip)
+    {
+      PlanSolution solution = planWithPipeline(planning_scene, req, parameter_vector[index]);
+      std::lock_guard<std::mutex> slock(solutions_lock);
+      solutions.push_back(solution);
+      if (!stopped && stopping_criterion && stopping_criterion(solutions))
+        stopped = true;
+    }
+
+    std::lock_guard<std::mutex> slock(solutions_lock);
+    running[index] = false;
+    --num_running;
+    planner_finished.notify_all();
+  };
+
+  std::vector<std::thread> planning_threads;
+  planning_threads.reserve(parameter_vector.size());
+  for (std::size_t i = 0; i < parameter_vector.size(); ++i)
+    planning_threads.emplace_back(plan_with_parameters, i);
+
+  {
+    std::unique_lock<std::mutex> ulock(solutions_lock);
+    planner_finished.wait(ulock, [&] { return stopped || num_running == 0; });
+
+    // A planner may have passed the check of the stop flag, but activated its planning context only after the
+    // contexts were terminated. Keep terminating the remaining planners until all of them returned.
+    while (num_running > 0)
+    {
+      for (std::size_t i = 0; i < parameter_vector.size(); ++i)
+        if (running[i] && planning_pipeline_names_.count(parameter_vector[i].planning_pipeline))
+          moveit_cpp_->getPlanningPipelines().at(parameter_vector[i].planning_pipeline)->terminate();
+      planner_finished.wait_for(ulock, std::chrono::milliseconds(10));
+    }
+  }
+  for (std::thread& planning_thread : planning_threads)
+    planning_thread.join();
+
+  // keep the error of the first failed planner in case none succeeds
+  double best_cost = std::numeric_limits<double>::infinity();
+  for (const PlanSolution& solution : solutions)
+  {
+    if (!solution)
+    {
+      if (!*last_plan_solution_ && last_plan_solution_->error_code.val == 0)
+        last_plan_solution_->error_code = solution.error_code;
+      continue;
+    }
+    const double cost = cost_function ? cost_function(solution) : 0.0;
+    if (!*last_plan_solution_ || cost < best_cost)
+    {
+      *last_plan_solution_ = solution;
+      best_cost = cost;
+    }
+  }
+  if (!*last_plan_solution_ && last_plan_solution_->error_code.val == 0)
+    last_plan_solution_->error_code = MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
+
+  ROS_DEBUG_NAMED(LOGNAME, "%zu of %zu parallel planners finished", solutions.size(), parameter_vector.size());
   return *last_plan_solution_;
 }
 
+double PlanningComponent::getPathLengthCost(const PlanSolution& solution)
+{
+  return solution.trajectory ? getPathLength(*solution.trajectory) : std::numeric_limits<double>::infinity();
+}
+
+bool PlanningComponent::stopAtFirstSolution(const std::vector<PlanSolution>& solutions)
+{
+  return std::any_of(solutions.begin(), solutions.end(), [](const PlanSolution& solution) { return bool(solution); });
+}
+
 PlanningComponent::PlanSolution PlanningComponent::plan()
 {
   return plan(plan_request_parameters_);
@@ -158,6 +158,25 @@ TEST_F(MoveItCppTest, TestSetGoalFromRobotState)
 
   ASSERT_TRUE(static_cast<bool>(planning_component_ptr->plan()));
 }
+
+// Test planning with several planner configurations in parallel
+TEST_F(MoveItCppTest, TestParallelPlanning)
+{
+  planning_component_ptr->setGoal(target_pose1, "panda_link8");
+
+  PlanningComponent::MultiPipelinePlanRequestParameters parameters;
+  parameters.load(nh_, { "plan_request_params", "plan_request_params" });
+  parameters.plan_request_parameter_vector[0].planner_id = "RRTConnect";
+  parameters.plan_request_parameter_vector[1].planner_id = "BiTRRT";
+
+  PlanningComponent::PlanSolution best_solution = planning_component_ptr->plan(parameters);
+  ASSERT_TRUE(static_cast<bool>(best_solution));
+
+  PlanningComponent::PlanSolution first_solution = planning_component_ptr->plan(
+      parameters, &PlanningComponent::getPathLengthCost, &PlanningComponent::stopAtFirstSolution);
+  ASSERT_TRUE(static_cast<bool>(first_solution));
+  EXPECT_EQ(planning_component_ptr->getLastPlanSolution()->trajectory, first_solution.trajectory);
+}
 }  // namespace planning_interface
 }  // namespace moveit
 